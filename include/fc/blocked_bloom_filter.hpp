@@ -0,0 +1,153 @@
+#pragma once
+#include <fc/bloom_filter.hpp>
+#include <fc/crypto/fast_hash.hpp>
+#include <fc/reflect/reflect.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace fc {
+
+   enum class blocked_bloom_backend { scalar, avx2 };
+   blocked_bloom_backend get_blocked_bloom_backend();
+   /// for tests and benchmarks, false when this CPU cannot run @p b
+   bool set_blocked_bloom_backend( blocked_bloom_backend b );
+
+   namespace detail {
+      /// the block of hash @p h among @p blocks
+      inline size_t blocked_bloom_index( uint64_t h, size_t blocks ) {
+         return size_t( ( ( h >> 32 ) * blocks ) >> 32 );
+      }
+
+      /// the @p k bits of hash @p h within its block, as eight 64 bit words
+      void blocked_bloom_mask( uint64_t h, uint32_t k, uint64_t* mask );
+
+      /// the number of blocks and bits per key that hold @p projected_element_count keys at @p false_positive_probability
+      void blocked_bloom_size( uint64_t projected_element_count, double false_positive_probability, uint64_t& blocks, uint32_t& k );
+   }
+
+   /**
+    *  A bloom filter whose k bits for a key all lie in one 64 byte block, so a lookup touches one cache line
+    *  where bloom_filter touches k. Keys are hashed once with fast_hash64: the high half picks the block and
+    *  the bits within it come from double hashing the hash. On AVX2 a lookup tests eight bits per gather.
+    *
+    *  Blocks fill unevenly, so for the same false positive rate it needs somewhat more bits than
+    *  bloom_filter; the constructor sizes it for the blocked layout.
+    */
+   class blocked_bloom_filter
+   {
+   public:
+      static constexpr uint32_t max_hash_count = 16;
+
+      struct alignas(64) block
+      {
+         std::array<uint64_t, 8> words{};
+
+         bool operator == ( const block& b )const { return words == b.words; }
+         bool operator != ( const block& b )const { return words != b.words; }
+      };
+
+      blocked_bloom_filter() = default;
+
+      /// sized for @p projected_element_count keys with false positives at @p false_positive_probability
+      blocked_bloom_filter( uint64_t projected_element_count, double false_positive_probability, uint64_t seed = 0 );
+
+      /// the count, rate and seed of @p p, its optimal_parameters are for bloom_filter and are not used
+      explicit blocked_bloom_filter( const bloom_parameters& p );
+
+      bool operator == ( const blocked_bloom_filter& f )const;
+      bool operator != ( const blocked_bloom_filter& f )const { return !( *this == f ); }
+
+      bool operator!()const { return blocks_.empty(); }
+
+      void clear();
+
+      /// the hash insert and contains use for @p len bytes at @p data
+      uint64_t hash( const char* data, size_t len )const { return fast_hash64( data, len, seed_ ); }
+
+      void insert_hash( uint64_t h );
+      bool contains_hash( uint64_t h )const;
+
+      void insert( const char* data, size_t len ) { insert_hash( hash( data, len ) ); }
+      void insert( const std::string& key )       { insert( key.data(), key.size() ); }
+
+      template<typename T>
+      void insert( const T& t )
+      {
+         // T must be a C++ POD type.
+         insert( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      bool contains( const char* data, size_t len )const { return contains_hash( hash( data, len ) ); }
+      bool contains( const std::string& key )const       { return contains( key.data(), key.size() ); }
+
+      template<typename T>
+      bool contains( const T& t )const
+      {
+         return contains( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      /**
+       *  Batches of hashes: the blocks of a group of keys are prefetched before any is probed, which
+       *  overlaps the cache misses of filters larger than the cache.
+       */
+      void   insert_many( const uint64_t* hashes, size_t count );
+      /// sets @p found[i] for each of @p hashes, returns the number found
+      size_t contains_many( const uint64_t* hashes, size_t count, bool* found )const;
+
+      /// batches of POD keys
+      template<typename T>
+      void insert_many( const T* keys, size_t count )
+      {
+         uint64_t h[batch_size];
+         for( size_t i = 0; i < count; i += batch_size ) {
+            const size_t n = std::min( batch_size, count - i );
+            for( size_t j = 0; j < n; ++j )
+               h[j] = hash( reinterpret_cast<const char*>( keys + i + j ), sizeof(T) );
+            insert_many( h, n );
+         }
+      }
+
+      template<typename T>
+      size_t contains_many( const T* keys, size_t count, bool* found )const
+      {
+         uint64_t h[batch_size];
+         size_t r = 0;
+         for( size_t i = 0; i < count; i += batch_size ) {
+            const size_t n = std::min( batch_size, count - i );
+            for( size_t j = 0; j < n; ++j )
+               h[j] = hash( reinterpret_cast<const char*>( keys + i + j ), sizeof(T) );
+            r += contains_many( h, n, found + i );
+         }
+         return r;
+      }
+
+      /// size in bits
+      uint64_t size()const { return uint64_t( blocks_.size() ) * 512; }
+      uint32_t hash_count()const { return hash_count_; }
+      uint64_t element_count()const { return inserted_element_count_; }
+
+      /// the false positive rate at the current element count
+      double effective_fpp()const;
+
+      /// the false positive rate of @p blocks blocks holding @p elements keys with @p k bits each
+      static double blocked_fpp( uint64_t blocks, uint64_t elements, uint32_t k );
+
+      static constexpr size_t batch_size = 64;
+
+      std::vector<block> blocks_;
+      uint32_t           hash_count_ = 0;
+      uint64_t           seed_ = 0;
+      uint64_t           projected_element_count_ = 0;
+      uint64_t           inserted_element_count_ = 0;
+      double             desired_false_positive_probability_ = 0.0;
+   };
+
+} // namespace fc
+
+FC_REFLECT( fc::blocked_bloom_filter::block, (words) )
+FC_REFLECT( fc::blocked_bloom_filter, (blocks_)(hash_count_)(seed_)(projected_element_count_)(inserted_element_count_)(desired_false_positive_probability_) )
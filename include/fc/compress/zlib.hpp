@@ -1,10 +1,36 @@
 #pragma once
 
 #include <fc/string.hpp>
+#include <memory>
 
 namespace fc 
 {
+  class path;
 
   string zlib_compress(const string& in);
 
+  /**
+   * Compresses the file at in into a gzip file at out, reading it in chunks.
+   * @throws std::ios_base::failure when either file can not be read or written, or compression fails
+   */
+  void gzip_compress_file(const path& in, const path& out);
+
+  /**
+   * Produces the same output as zlib_compress but keeps the miniz compressor state, which is a few
+   * hundred KB, allocated between calls. Not thread safe.
+   */
+  class zlib_compressor
+  {
+  public:
+    zlib_compressor();
+    ~zlib_compressor();
+
+    /// replaces the contents of out with the zlib stream of [in, in + size)
+    void compress(const char* in, size_t size, string& out);
+
+  private:
+    struct impl;
+    std::unique_ptr<impl> my;
+  };
+
 } // namespace fc
@@ -0,0 +1,166 @@
+#pragma once
+#include <fc/blocked_bloom_filter.hpp>
+#include <fc/time.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fc {
+
+   /**
+    *  A blocked bloom filter that any number of threads may insert into and query at once, without locks:
+    *  an insert sets its bits with one atomic fetch_or per 64 bit word it touches, and those words all lie in
+    *  one cache line. It has the layout and sizing of blocked_bloom_filter, and the same hashes, so
+    *  snapshot() of a filter is equal to a blocked_bloom_filter built from the same keys.
+    *
+    *  A key is reported by contains() from the moment the insert of it returns; inserts that are still
+    *  running may or may not be seen. clear() is not atomic with respect to inserts that run during it.
+    */
+   class concurrent_bloom_filter
+   {
+   public:
+      concurrent_bloom_filter( uint64_t projected_element_count, double false_positive_probability, uint64_t seed = 0 );
+
+      concurrent_bloom_filter( const concurrent_bloom_filter& ) = delete;
+      concurrent_bloom_filter& operator = ( const concurrent_bloom_filter& ) = delete;
+
+      uint64_t hash( const char* data, size_t len )const { return fast_hash64( data, len, seed_ ); }
+
+      /**
+       *  @return true when some bit of the key was not set before, so the key is new. Two threads inserting
+       *  the same key at the same time may both see it as new.
+       */
+      bool insert_hash( uint64_t h );
+      bool contains_hash( uint64_t h )const;
+
+      bool insert( const char* data, size_t len ) { return insert_hash( hash( data, len ) ); }
+      bool insert( const std::string& key )       { return insert( key.data(), key.size() ); }
+
+      template<typename T>
+      bool insert( const T& t )
+      {
+         // T must be a C++ POD type.
+         return insert( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      bool contains( const char* data, size_t len )const { return contains_hash( hash( data, len ) ); }
+      bool contains( const std::string& key )const       { return contains( key.data(), key.size() ); }
+
+      template<typename T>
+      bool contains( const T& t )const
+      {
+         return contains( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      void clear();
+
+      uint64_t size()const { return block_count_ * 512; }
+      uint32_t hash_count()const { return hash_count_; }
+      uint64_t seed()const { return seed_; }
+
+      /// the number of inserts that found their key new
+      uint64_t element_count()const;
+      double   effective_fpp()const;
+
+      /// a copy of the bits, e.g. to serialize them; inserts running meanwhile may be partly in it
+      blocked_bloom_filter snapshot()const;
+
+   private:
+      struct alignas(64) atomic_block
+      {
+         std::atomic<uint64_t> words[8];
+      };
+
+      /// element counts spread over cache lines by hash, so threads inserting new keys rarely share one
+      struct alignas(64) counter
+      {
+         std::atomic<uint64_t> count{ 0 };
+      };
+      static constexpr size_t counter_count = 8;
+
+      std::unique_ptr<atomic_block[]> blocks_;
+      uint64_t                        block_count_ = 0;
+      uint32_t                        hash_count_ = 0;
+      uint64_t                        seed_ = 0;
+      uint64_t                        projected_element_count_ = 0;
+      double                          desired_false_positive_probability_ = 0.0;
+      counter                         counts_[counter_count];
+   };
+
+   /**
+    *  "Seen in the last window": a ring of concurrent_bloom_filter generations. Inserts go to the newest,
+    *  queries look at all of them, and rotating clears the oldest and makes it the newest. Each generation is
+    *  sized for @p generation_keys keys and ends once it holds that many, or once it is @p generation_age old
+    *  when that is not zero. The rate is for a query against the whole window.
+    *
+    *  Inserts check the limits, on about one new key in 64 for large generations, so a generation may run a
+    *  little over them; maybe_rotate() checks the age for callers that insert rarely, e.g. from a timer.
+    *  Inserting a key that is in an older generation puts it in the newest, so a key is reported until
+    *  @p generations - 1 generations have ended after the last insert of it.
+    */
+   class rotating_bloom_filter
+   {
+   public:
+      rotating_bloom_filter( uint32_t generations, uint64_t generation_keys, fc::microseconds generation_age,
+                             double false_positive_probability, uint64_t seed = 0 );
+
+      uint64_t hash( const char* data, size_t len )const { return fast_hash64( data, len, seed_ ); }
+
+      /// @return true when the key was not seen in the window
+      bool insert_hash( uint64_t h );
+      /// whether the key was seen in the window
+      bool contains_hash( uint64_t h )const;
+
+      bool insert( const char* data, size_t len ) { return insert_hash( hash( data, len ) ); }
+      bool insert( const std::string& key )       { return insert( key.data(), key.size() ); }
+
+      template<typename T>
+      bool insert( const T& t )
+      {
+         // T must be a C++ POD type.
+         return insert( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      bool contains( const char* data, size_t len )const { return contains_hash( hash( data, len ) ); }
+      bool contains( const std::string& key )const       { return contains( key.data(), key.size() ); }
+
+      template<typename T>
+      bool contains( const T& t )const
+      {
+         return contains( reinterpret_cast<const char*>( &t ), sizeof(T) );
+      }
+
+      /// ends the current generation if it is older than the generation age
+      bool maybe_rotate( fc::time_point now = fc::time_point::now() );
+
+      /// ends the current generation now
+      void rotate( fc::time_point now = fc::time_point::now() );
+
+      /// the number of generations that have ended
+      uint64_t rotations()const { return current_.load( std::memory_order_acquire ); }
+      uint32_t generations()const { return uint32_t( generations_.size() ); }
+
+      /// the rate of a query against all generations, each holding the keys it does now
+      double effective_fpp()const;
+
+   private:
+      const concurrent_bloom_filter& generation( uint64_t g )const { return *generations_[g % generations_.size()]; }
+      concurrent_bloom_filter&       generation( uint64_t g )      { return *generations_[g % generations_.size()]; }
+
+      /// rotates from generation @p g, unless another thread did first
+      void rotate_from( uint64_t g, fc::time_point now );
+
+      std::vector<std::unique_ptr<concurrent_bloom_filter>> generations_;
+      uint64_t                                              seed_;
+      uint64_t                                              generation_keys_;
+      fc::microseconds                                      generation_age_;
+      uint64_t                                              check_mask_;
+      std::atomic<uint64_t>                                 current_{ 0 };
+      std::atomic<int64_t>                                  generation_start_;
+      std::mutex                                            rotate_mutex_;
+   };
+
+} // namespace fc
@@ -137,10 +137,8 @@ namespace fc {
       const auto& str = v.get_string();
       FC_ASSERT( str.size() <= 2*MAX_SIZE_OF_BYTE_ARRAYS ); // Doubled because hex strings needs two characters per byte
       vec.resize( str.size() / 2 );
-      if( vec.size() ) {
-         size_t r = fc::from_hex( str, vec.data(), vec.size() );
-         FC_ASSERT( r == vec.size() );
-      }
+      if( vec.size() && !fc::hex_decode( str.data(), 2 * vec.size(), vec.data() ) )
+         fc::from_hex( str, vec.data(), vec.size() ); // throws naming the invalid character
    }
 
    template<typename T, typename... U>
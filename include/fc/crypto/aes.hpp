@@ -53,7 +53,8 @@ namespace fc {
     void              aes_save( const fc::path& file, const fc::sha512& key, std::vector<char> plain_text );
 
     /**
-     *  recovers the plain_text saved via aes_save()
+     *  recovers the plain_text saved via aes_save(), or written by encrypted_file_writer, which
+     *  encrypts and authenticates large files a chunk at a time
      */
     std::vector<char> aes_load( const fc::path& file, const fc::sha512& key );
 
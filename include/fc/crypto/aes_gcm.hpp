@@ -0,0 +1,134 @@
+#pragma once
+#include <fc/array.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <memory>
+
+namespace fc {
+
+   struct aes_gcm_message;
+
+   /**
+    *  AES-256-GCM authenticated encryption with a key that is expanded once: a context holds the OpenSSL
+    *  cipher state, which runs on AES-NI and carry-less multiplies where the CPU has them, and each message
+    *  only sets a new nonce. Messages are encrypted in place or into a caller buffer, without allocating.
+    *
+    *  A nonce must never repeat under one key. A context is not thread safe; use one per thread.
+    */
+   class aes_gcm
+   {
+      public:
+         static constexpr size_t nonce_size = 12;
+         static constexpr size_t tag_size   = 16;
+         /// bytes seal() adds to a message: the nonce before it and the tag after it
+         static constexpr size_t overhead   = nonce_size + tag_size;
+
+         typedef fc::array<char, nonce_size> nonce_type;
+         typedef fc::array<char, tag_size>   tag_type;
+
+         explicit aes_gcm( const fc::sha256& key );
+         ~aes_gcm();
+
+         aes_gcm( const aes_gcm& ) = delete;
+         aes_gcm& operator = ( const aes_gcm& ) = delete;
+
+         /// encrypts @p len bytes from @p in to @p out, which may be the same, and authenticates @p aad with them
+         void encrypt( const nonce_type& nonce, const char* in, size_t len, char* out, tag_type& tag,
+                       const char* aad = nullptr, size_t aad_len = 0 );
+         void encrypt( const nonce_type& nonce, char* data, size_t len, tag_type& tag,
+                       const char* aad = nullptr, size_t aad_len = 0 )
+         { encrypt( nonce, data, len, data, tag, aad, aad_len ); }
+
+         /**
+          *  decrypts @p len bytes from @p in to @p out, which may be the same
+          *  @return false when @p tag does not authenticate them, @p out is zeroed then
+          */
+         bool decrypt( const nonce_type& nonce, const char* in, size_t len, char* out, const tag_type& tag,
+                       const char* aad = nullptr, size_t aad_len = 0 );
+         bool decrypt( const nonce_type& nonce, char* data, size_t len, const tag_type& tag,
+                       const char* aad = nullptr, size_t aad_len = 0 )
+         { return decrypt( nonce, data, len, data, tag, aad, aad_len ); }
+
+         /// each message with its own nonce, in place
+         void   encrypt_many( aes_gcm_message* messages, size_t count );
+         /// @return the number of messages that are authentic, the others are zeroed and have @c authentic false
+         size_t decrypt_many( aes_gcm_message* messages, size_t count );
+
+         /**
+          *  writes a random nonce, @p len bytes of cipher text and the tag, overhead bytes more than @p len, to
+          *  @p out. Random nonces are safe for up to 2^32 messages under a key.
+          */
+         void seal( const char* in, size_t len, char* out, const char* aad = nullptr, size_t aad_len = 0 );
+         /// the @p len - overhead bytes of plain text of what seal() wrote, false when it is not authentic
+         bool open( const char* in, size_t len, char* out, const char* aad = nullptr, size_t aad_len = 0 );
+
+         static nonce_type random_nonce();
+
+         /// the nonce of chunk @p chunk of a stream: @p base with the chunk number and the last flag mixed in
+         static nonce_type chunk_nonce( const nonce_type& base, uint64_t chunk, bool last );
+
+      private:
+         struct impl;
+         std::unique_ptr<impl> my;
+   };
+
+   /// a message for aes_gcm::encrypt_many and decrypt_many
+   struct aes_gcm_message
+   {
+      aes_gcm::nonce_type nonce;
+      char*               data = nullptr;
+      size_t              size = 0;
+      aes_gcm::tag_type   tag;
+      const char*         aad = nullptr;
+      size_t              aad_size = 0;
+      bool                authentic = false;
+   };
+
+   /**
+    *  A stream encrypted as numbered chunks, each authenticated on its own with a nonce derived from a base
+    *  nonce, the chunk number and whether it is the last chunk. A decryptor detects chunks that were dropped,
+    *  reordered or cut off at the end, and a chunk can be decrypted without the ones before it.
+    */
+   class aes_gcm_stream_encryptor
+   {
+      public:
+         aes_gcm_stream_encryptor( const fc::sha256& key, const aes_gcm::nonce_type& base );
+
+         /// encrypts the next chunk in place, @p last for the final one
+         void encrypt( char* data, size_t len, aes_gcm::tag_type& tag, bool last,
+                       const char* aad = nullptr, size_t aad_len = 0 );
+
+         uint64_t chunks()const   { return _next; }
+         bool     finished()const { return _finished; }
+
+      private:
+         aes_gcm             _gcm;
+         aes_gcm::nonce_type _base;
+         uint64_t            _next = 0;
+         bool                _finished = false;
+   };
+
+   class aes_gcm_stream_decryptor
+   {
+      public:
+         aes_gcm_stream_decryptor( const fc::sha256& key, const aes_gcm::nonce_type& base );
+
+         /// decrypts the next chunk in place, false when it is not the authentic chunk at this position
+         bool decrypt( char* data, size_t len, const aes_gcm::tag_type& tag, bool last,
+                       const char* aad = nullptr, size_t aad_len = 0 );
+
+         /// decrypts chunk @p chunk in place, out of order
+         bool decrypt_at( uint64_t chunk, char* data, size_t len, const aes_gcm::tag_type& tag, bool last,
+                          const char* aad = nullptr, size_t aad_len = 0 );
+
+         uint64_t chunks()const   { return _next; }
+         /// whether the last chunk was decrypted, a stream that ends before is truncated
+         bool     finished()const { return _finished; }
+
+      private:
+         aes_gcm             _gcm;
+         aes_gcm::nonce_type _base;
+         uint64_t            _next = 0;
+         bool                _finished = false;
+   };
+
+} // namespace fc
@@ -11,4 +11,42 @@ std::string base64url_encode(unsigned char const* bytes_to_encode, unsigned int
 inline std::string base64url_encode(char const* bytes_to_encode, unsigned int in_len) { return base64url_encode( (unsigned char const*)bytes_to_encode, in_len); }
 std::string base64url_encode( const std::string& enc );
 std::string base64url_decode( const std::string& encoded_string);
+
+/// base64url replaces '+' and '/' with '-' and '_' (RFC 4648 section 5)
+enum class base64_alphabet { standard, url };
+
+enum class base64_mode {
+   /// only the canonical encoding: '=' padding absent or completing the last group, unused bits of the
+   /// last character zero, no single character group
+   strict,
+   /// what base64_decode has always accepted: decoding stops at the first '=', a single trailing
+   /// character and unused bits are ignored
+   lenient
+};
+
+/// characters base64_encode_to writes for len bytes, padding included
+constexpr size_t base64_encoded_size( size_t len ) { return ( len + 2 ) / 3 * 4; }
+/// the most bytes len characters can decode to
+constexpr size_t base64_decoded_max_size( size_t len ) { return ( len + 3 ) / 4 * 3; }
+
+/**
+ *  Writes the base64_encoded_size( len ) characters encoding the len bytes at in to out, with '='
+ *  padding and without a terminator.
+ */
+void base64_encode_to( const char* in, size_t len, char* out, base64_alphabet alphabet = base64_alphabet::standard );
+
+/**
+ *  Decodes the len characters at in to out, which has room for out_size bytes, and sets out_len to the
+ *  number of bytes written. Characters are validated in the same pass that decodes them.
+ *
+ *  @return false if the input is not valid in mode, or decodes to more than out_size bytes; out may
+ *          then be partly written
+ */
+bool base64_decode_to( const char* in, size_t len, char* out, size_t out_size, size_t& out_len,
+                       base64_alphabet alphabet = base64_alphabet::standard, base64_mode mode = base64_mode::strict );
+
+enum class base64_backend { scalar, avx2 };
+base64_backend get_base64_backend();
+/// for tests and benchmarks, false when this CPU cannot run @p b
+bool set_base64_backend( base64_backend b );
 }  // namespace fc
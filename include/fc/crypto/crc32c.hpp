@@ -0,0 +1,27 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace fc {
+
+   /**
+    *  CRC-32C (Castagnoli, as in iSCSI and SSE4.2) of @p len bytes. @p seed is the crc of the data before,
+    *  so crc32c( b, n, crc32c( a, m ) ) is the crc of a followed by b.
+    *
+    *  The implementation is picked at runtime: the SSE4.2 crc32 instruction on three interleaved streams,
+    *  merged with carry-less multiplies where PCLMULQDQ is available and with shift tables otherwise, or a
+    *  slicing-by-8 table on other CPUs. city_hash_crc_128/256 use the same choice.
+    */
+   uint32_t crc32c( const char* data, size_t len, uint32_t seed = 0 );
+
+   enum class crc32c_backend { table, sse42, pclmul };
+   crc32c_backend get_crc32c_backend();
+   /// for tests and benchmarks, false when this CPU cannot run @p b
+   bool set_crc32c_backend( crc32c_backend b );
+
+   namespace detail {
+      /// the crc32 instruction on 64 bits, without the pre and post inversion of crc32c()
+      uint32_t crc32c_u64_table( uint32_t crc, uint64_t v );
+   }
+
+} // namespace fc
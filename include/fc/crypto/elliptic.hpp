@@ -50,6 +50,15 @@ namespace fc {
            public_key( const public_key_point_data& v );
            public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical = true );
 
+           /**
+            *  Whether @p c signs @p digest with this key, the recovery id included: @p c verifies exactly
+            *  when recovering from it gives this key. Malformed and, when @p check_canonical, non-canonical
+            *  signatures do not verify. The secp256k1 libraries do not expose the point verification computes,
+            *  so on those backends this recovers a key and compares, at the cost of a recovery; only the
+            *  OpenSSL backend checks the signature against this key directly.
+            */
+           bool verify( const fc::sha256& digest, const compact_signature& c, bool check_canonical = true )const;
+
            public_key child( const fc::sha256& offset )const;
 
            bool valid()const;
@@ -124,6 +133,11 @@ namespace fc {
            fc::sha512 get_shared_secret( const public_key& pub )const;
 
 //           signature         sign( const fc::sha256& digest )const;
+           /**
+            *  The signature is already low-S. A canonical one also needs r and s below 2^255 with no
+            *  leading zero byte, and r follows from the nonce alone, so require_canonical retries with
+            *  the next rfc6979 nonce: about two attempts on average, each without heap allocation.
+            */
            compact_signature sign_compact( const fc::sha256& digest, bool require_canonical = true )const;
 //           bool              verify( const fc::sha256& digest, const signature& sig );
 
@@ -183,6 +197,16 @@ namespace fc {
                                           const range_proof_type& proof );
      range_proof_info range_get_info( const range_proof_type& proof );
 
+     /**
+      *  Creates the signing and verification context now instead of on the first key operation, so its
+      *  multiplication tables are not built during the first signature or recovery. Commitment and range
+      *  proof tables are built separately when those functions are first used.
+      *
+      *  @param per_thread_contexts each thread signs and recovers with its own clone of the context,
+      *                             made on the thread's first use and freed when it exits
+      */
+     void init_context( bool per_thread_contexts = false );
+
       /**
        * Shims
        */
@@ -201,6 +225,10 @@ namespace fc {
          public_key_type recover(const sha256& digest, bool check_canonical) const {
             return public_key_type(public_key(_data, digest, check_canonical).serialize());
          }
+
+         bool verify(const public_key_type& key, const sha256& digest, bool check_canonical) const {
+            return public_key(key._data).verify(digest, _data, check_canonical);
+         }
       };
 
       struct private_key_shim : public crypto::shim<private_key_secret> {
@@ -213,6 +241,16 @@ namespace fc {
            return signature_type(private_key::regenerate(_data).sign_compact(digest, require_canonical));
          }
 
+         std::vector<signature_type> sign_many( const std::vector<sha256>& digests, bool require_canonical = true ) const
+         {
+           const private_key key = private_key::regenerate(_data);
+           std::vector<signature_type> sigs;
+           sigs.reserve(digests.size());
+           for( const auto& digest : digests )
+              sigs.emplace_back(key.sign_compact(digest, require_canonical));
+           return sigs;
+         }
+
          public_key_type get_public_key( ) const
          {
            return public_key_type(private_key::regenerate(_data).get_public_key().serialize());
@@ -25,6 +25,33 @@ namespace fc {
 
     int ECDSA_SIG_recover_key_GFp(EC_KEY *eckey, ECDSA_SIG *ecsig, const unsigned char *msg, int msglen, int recid, int check);
 
+    /**
+     *  Recovers the compressed public key for the 64 byte r || s at rs over digest, recid selecting the
+     *  candidate point as for ECDSA_SIG_recover_key_GFp. Keeps its OpenSSL group, BN_CTX and points per
+     *  thread instead of building an EC_KEY per call; a key at infinity comes back as all zeros, as
+     *  serializing the EC_KEY gives.
+     *
+     *  @return false if no key can be recovered
+     */
+    bool recover_public_key_data( const unsigned char* rs, const fc::sha256& digest, int recid, public_key_data& out );
+
+    /**
+     *  Whether the 64 byte r || s at rs signs digest with key and recovers to it with recid, on the same
+     *  per thread state as recover_public_key_data. The last key is kept decoded, so a run of signatures
+     *  by one key decompresses it once.
+     */
+    bool verify_public_key_data( const unsigned char* rs, const fc::sha256& digest, int recid, const public_key_data& key );
+
+    /**
+     *  Signs digest with secret on the same per thread state, without building an EC_KEY or ECDSA_SIG. The
+     *  signature is made in one attempt: s is brought to the low half, which recovery requires, and the
+     *  recovery id is read off the nonce point rather than found by recovering candidate keys. The nonce
+     *  and secret go through constant time inversion and the secret is multiplied in blinded.
+     *
+     *  @return false if secret is not a valid key
+     */
+    bool sign_compact_data( const private_key_secret& secret, const fc::sha256& digest, compact_signature& out );
+
     /**
      *  @class public_key
      *  @brief contains only the public point of an elliptic curve key.
@@ -46,6 +73,16 @@ namespace fc {
            public_key( const public_key_point_data& v );
            public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical = true );
 
+           /// the serialized key that public_key( c, digest ) recovers, without constructing an EC_KEY
+           static public_key_data recover( const compact_signature& c, const fc::sha256& digest );
+
+           /**
+            *  Whether @p c signs @p digest with @p key, without recovering a key. The recovery id is checked
+            *  against the point verification computes, so @p c verifies exactly when it recovers @p key; high
+            *  s values do not verify, as they do not recover.
+            */
+           static bool verify( const public_key_data& key, const compact_signature& c, const fc::sha256& digest );
+
            bool valid()const;
            public_key mult( const fc::sha256& offset );
            public_key add( const fc::sha256& offset )const;
@@ -147,7 +184,11 @@ namespace fc {
         using crypto::shim<compact_signature>::shim;
 
         public_key_type recover(const sha256& digest, bool check_canonical) const {
-           return public_key_type(public_key(_data, digest, check_canonical).serialize());
+           return public_key_type(public_key::recover(_data, digest));
+        }
+
+        bool verify(const public_key_type& key, const sha256& digest, bool check_canonical) const {
+           return public_key::verify(key._data, _data, digest);
         }
      };
 
@@ -158,7 +199,17 @@ namespace fc {
 
         signature_type sign( const sha256& digest, bool require_canonical = true ) const
         {
-           return signature_type(private_key::regenerate(_data).sign_compact(digest));
+           compact_signature sig;
+           FC_ASSERT( sign_compact_data(_data, digest, sig), "unable to sign" );
+           return signature_type(sig);
+        }
+
+        std::vector<signature_type> sign_many( const std::vector<sha256>& digests, bool require_canonical = true ) const
+        {
+           std::vector<signature_type> sigs(digests.size());
+           for( size_t i = 0; i < digests.size(); ++i )
+              FC_ASSERT( sign_compact_data(_data, digests[i], sigs[i]._data), "unable to sign" );
+           return sigs;
         }
 
         public_key_type get_public_key( ) const
@@ -35,6 +35,9 @@ class public_key {
          }
       public_key(const signature& c, const fc::sha256& digest, bool check_canonical = true);
 
+      /// whether c signs digest with this key, false where recovering from c throws or gives another key
+      bool verify(const signature& c, const fc::sha256& digest) const;
+
       bool operator==(const public_key& o) const {
          return        public_key_data == o.public_key_data        &&
                 user_verification_type == o.user_verification_type &&
@@ -75,6 +78,7 @@ class signature {
    public:
       //used for base58 de/serialization
       using data_type = signature;
+      using public_key_type = public_key;
       signature serialize()const { return *this; }
 
       signature() {}
@@ -85,6 +89,10 @@ class signature {
          return public_key(*this, digest, check_canonical);
       }
 
+      bool verify(const public_key& key, const sha256& digest, bool check_canonical) const {
+         return key.verify(*this, digest);
+      }
+
       size_t variable_size() const {
          return auth_data.size() + client_json.size();
       }
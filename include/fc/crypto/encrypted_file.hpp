@@ -0,0 +1,108 @@
+#pragma once
+#include <fc/crypto/aes_gcm.hpp>
+#include <fc/crypto/sha512.hpp>
+#include <fc/filesystem.hpp>
+#include <fc/io/cfile.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <vector>
+
+namespace fc {
+
+   /**
+    *  The header of an encrypted file. The file key is the HMAC-SHA256, under the caller's key, of the packed
+    *  header up to and including the nonce, so every file has its own key and a changed header changes it.
+    *  @c check is the HMAC-SHA256 of "key check" under the file key, which tells a wrong key or header
+    *  apart from damaged data before any chunk is read.
+    *
+    *  The header is followed by the chunks, each of @c chunk_size bytes of cipher text and a 16 byte tag,
+    *  encrypted as an aes_gcm stream with base nonce @c nonce. The last chunk holds the rest, from 1 to
+    *  chunk_size bytes, or nothing in an empty file, and is marked last, so a file cut at a chunk boundary
+    *  does not authenticate. Chunk i starts at header_size + i * ( chunk_size + 16 ).
+    */
+   struct encrypted_file_header
+   {
+      static constexpr uint32_t current_version = 1;
+      /// packed size
+      static constexpr size_t   header_size = 8 + 4 + 4 + 32 + aes_gcm::nonce_size + 32;
+
+      fc::array<char, 8>  magic;
+      uint32_t            version = current_version;
+      uint32_t            chunk_size = 0;
+      fc::array<char, 32> salt;
+      aes_gcm::nonce_type nonce;
+      fc::sha256          check;
+
+      static fc::array<char, 8> expected_magic();
+   };
+
+   /**
+    *  Writes an encrypted file in constant memory, one chunk at a time. close() writes the last chunk; a
+    *  writer destroyed without it leaves a file that readers reject as truncated.
+    */
+   class encrypted_file_writer
+   {
+      public:
+         static constexpr uint32_t default_chunk_size = 64 * 1024;
+
+         encrypted_file_writer( const fc::path& file, const fc::sha512& key, uint32_t chunk_size = default_chunk_size );
+         ~encrypted_file_writer();
+
+         void write( const char* data, size_t len );
+         void close();
+
+         /// plain text bytes written so far
+         uint64_t size()const { return _size; }
+
+      private:
+         /// encrypts @p len bytes at @p data into the chunk buffer and writes them with their tag
+         void write_chunk( const char* data, size_t len, bool last );
+
+         fc::cfile                        _file;
+         std::unique_ptr<aes_gcm>         _gcm;
+         aes_gcm::nonce_type              _nonce;
+         uint32_t                         _chunk_size;
+         std::vector<char>                _buffer;
+         size_t                           _fill = 0;
+         uint64_t                         _chunks = 0;
+         uint64_t                         _size = 0;
+   };
+
+   /**
+    *  Reads an encrypted file in constant memory, sequentially or from any position: only the chunks that
+    *  hold the bytes asked for are read and authenticated. Data that does not authenticate throws.
+    */
+   class encrypted_file_reader
+   {
+      public:
+         encrypted_file_reader( const fc::path& file, const fc::sha512& key );
+
+         /// reads up to @p len bytes at the current position, returns how many, 0 at the end
+         size_t   read( char* out, size_t len );
+         void     seek( uint64_t pos );
+         uint64_t tell()const { return _pos; }
+
+         /// plain text size
+         uint64_t size()const { return _size; }
+         uint32_t chunk_size()const { return _header.chunk_size; }
+         uint64_t chunk_count()const { return _chunk_count; }
+
+         /// decrypts chunk @p index into @p out, which has room for chunk_size() bytes, returns its length
+         size_t   read_chunk( uint64_t index, char* out );
+
+         /// whether @p file starts like an encrypted file
+         static bool is_encrypted_file( const fc::path& file );
+
+      private:
+         fc::cfile                 _file;
+         encrypted_file_header     _header;
+         std::unique_ptr<aes_gcm>  _gcm;
+         uint64_t                  _chunk_count = 0;
+         uint64_t                  _size = 0;
+         uint64_t                  _pos = 0;
+         std::vector<char>         _buffer;
+         uint64_t                  _buffered_chunk = uint64_t( -1 );
+   };
+
+} // namespace fc
+
+FC_REFLECT( fc::encrypted_file_header, (magic)(version)(chunk_size)(salt)(nonce)(check) )
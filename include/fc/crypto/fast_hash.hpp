@@ -0,0 +1,95 @@
+#pragma once
+#include <fc/uint128.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fc {
+
+   namespace detail {
+      constexpr uint64_t fast_hash_p[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+      inline void fast_hash_mum( uint64_t& a, uint64_t& b ) {
+         const unsigned __int128 r = (unsigned __int128)a * b;
+         a = uint64_t( r );
+         b = uint64_t( r >> 64 );
+      }
+
+      inline uint64_t fast_hash_mix( uint64_t a, uint64_t b ) {
+         fast_hash_mum( a, b );
+         return a ^ b;
+      }
+
+      /// the words of a key of up to 16 bytes, overlapping when shorter
+      inline void fast_hash_short_words( const char* p, size_t len, uint64_t& a, uint64_t& b ) {
+         if( len >= 8 ) {
+            memcpy( &a, p, 8 );
+            memcpy( &b, p + len - 8, 8 );
+         } else if( len >= 4 ) {
+            uint32_t x, y;
+            memcpy( &x, p, 4 );
+            memcpy( &y, p + len - 4, 4 );
+            a = x;
+            b = y;
+         } else if( len > 0 ) {
+            a = uint64_t( uint8_t( p[0] ) ) << 16 | uint64_t( uint8_t( p[len >> 1] ) ) << 8 | uint8_t( p[len - 1] );
+            b = 0;
+         } else {
+            a = b = 0;
+         }
+      }
+
+      /// the last two words @p a and @p b of a key of @p len bytes
+      inline uint64_t fast_hash_final( uint64_t a, uint64_t b, uint64_t seed, uint64_t len ) {
+         a ^= fast_hash_p[1];
+         b ^= seed;
+         fast_hash_mum( a, b );
+         return fast_hash_mix( a ^ fast_hash_p[0] ^ len, b ^ fast_hash_p[1] );
+      }
+
+      /// keys of more than 32 bytes, @p seed is mixed already
+      uint64_t fast_hash_long( const char* data, size_t len, uint64_t seed );
+   }
+
+   /**
+    *  Seeded non-cryptographic hashes for hash tables, in the style of wyhash: keys up to 32 bytes are
+    *  hashed inline with two or three 64x64->128 bit multiplies, longer keys take one more per 16 bytes, and inputs of a
+    *  kilobyte and more run through eight accumulator lanes, on AVX2 when the CPU has it.
+    *
+    *  Not for anything an attacker controls without a secret seed, and the values are not a stable format:
+    *  do not persist them.
+    */
+   inline uint64_t fast_hash64( const char* data, size_t len, uint64_t seed = 0 ) {
+      seed ^= detail::fast_hash_mix( seed ^ detail::fast_hash_p[0], detail::fast_hash_p[1] );
+      if( len > 32 )
+         return detail::fast_hash_long( data, len, seed );
+      uint64_t a, b;
+      if( len > 16 ) {
+         memcpy( &a, data, 8 );
+         memcpy( &b, data + 8, 8 );
+         seed = detail::fast_hash_mix( a ^ detail::fast_hash_p[1], b ^ seed );
+         memcpy( &a, data + len - 16, 8 );
+         memcpy( &b, data + len - 8, 8 );
+      } else {
+         detail::fast_hash_short_words( data, len, a, b );
+      }
+      return detail::fast_hash_final( a, b, seed, len );
+   }
+
+   /// two independent 64 bit lanes
+   uint128  fast_hash128( const char* data, size_t len, uint64_t seed = 0 );
+
+   enum class fast_hash_backend { scalar, avx2 };
+   fast_hash_backend get_fast_hash_backend();
+   /// for tests and benchmarks, false when this CPU cannot run @p b
+   bool set_fast_hash_backend( fast_hash_backend b );
+
+   /// hasher for unordered containers keyed by strings or byte vectors
+   struct fast_hasher {
+      size_t operator()( const std::string& s )const { return fast_hash64( s.data(), s.size() ); }
+      size_t operator()( const std::vector<char>& v )const { return fast_hash64( v.data(), v.size() ); }
+   };
+
+} // namespace fc
@@ -12,4 +12,23 @@ namespace fc {
      *  @return the number of bytes decoded
      */
     size_t from_hex( const fc::string& hex_str, char* out_data, size_t out_data_len );
-} 
+
+    /**
+     *  Writes the 2 * len lowercase hex digits of the len bytes at in to out, without a terminator.
+     */
+    void hex_encode( const char* in, size_t len, char* out );
+
+    /**
+     *  Decodes the hex_len digits at hex, either case, into the hex_len / 2 bytes at out. Digits are
+     *  validated in the same pass that decodes them, so an invalid string is found without a throw per
+     *  character.
+     *
+     *  @return false if hex_len is odd or a character is not a hex digit; out may then be partly written
+     */
+    bool hex_decode( const char* hex, size_t hex_len, char* out );
+
+    enum class hex_backend { scalar, ssse3, avx2 };
+    hex_backend get_hex_backend();
+    /// for tests and benchmarks, false when this CPU cannot run @p b
+    bool set_hex_backend( hex_backend b );
+}
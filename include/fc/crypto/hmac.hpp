@@ -11,6 +11,7 @@
 #include <fc/crypto/sha224.hpp>
 #include <fc/crypto/sha256.hpp>
 #include <fc/crypto/sha512.hpp>
+#include <fc/exception/exception.hpp>
 
 namespace fc {
 
@@ -20,38 +21,70 @@ namespace fc {
         public:
             hmac() {}
 
+            /// precomputes the inner and outer hash states of @p key for digest( d, d_len )
+            hmac( const char* key, uint32_t key_len ) { set_key( key, key_len ); }
+
+            void set_key( const char* key, uint32_t key_len )
+            {
+                inner.reset();
+                add_key( inner, key, key_len, 0x36 );
+                outer.reset();
+                add_key( outer, key, key_len, 0x5c );
+                has_key = true;
+            }
+
             H digest( const char* c, uint32_t c_len, const char* d, uint32_t d_len )
             {
                 encoder.reset();
-                add_key(c, c_len, 0x36);
+                add_key(encoder, c, c_len, 0x36);
                 encoder.write( d, d_len );
                 H intermediate = encoder.result();
 
                 encoder.reset();
-                add_key(c, c_len, 0x5c);
+                add_key(encoder, c, c_len, 0x5c);
                 encoder.write( intermediate.data(), intermediate.data_size() );
                 return encoder.result();
             }
 
+            /// the hmac of @p d under the key of the constructor or set_key, starting from copies of the precomputed states
+            H digest( const char* d, uint32_t d_len )const
+            {
+                FC_ASSERT( has_key, "hmac digest without a key, construct it with one or call set_key" );
+                typename H::encoder e( inner );
+                e.write( d, d_len );
+                H intermediate = e.result();
+
+                e = outer;
+                e.write( intermediate.data(), intermediate.data_size() );
+                return e.result();
+            }
+
         private:
-            void add_key( const char* c, const uint32_t c_len, char pad )
+            /// the padded key as one block, so the encoder compresses it right away
+            void add_key( typename H::encoder& e, const char* c, const uint32_t c_len, char pad )const
             {
                 if ( c_len > internal_block_size() )
                 {
                     H hash = H::hash( c, c_len );
-                    add_key( hash.data(), hash.data_size(), pad );
+                    add_key( e, hash.data(), hash.data_size(), pad );
                 }
                 else
-                    for (unsigned int i = 0; i < internal_block_size(); i++ )
-                    {
-                        encoder.put( pad ^ ((i < c_len) ? *c++ : 0) );
-                    }
+                {
+                    char block[128];
+                    const unsigned int size = internal_block_size();
+                    for (unsigned int i = 0; i < size; i++ )
+                        block[i] = pad ^ ((i < c_len) ? c[i] : 0);
+                    e.write( block, size );
+                }
             }
 
             unsigned int internal_block_size() const;
 
             H dummy;
             typename H::encoder encoder;
+            typename H::encoder inner;
+            typename H::encoder outer;
+            bool has_key = false;
     };
 
     typedef hmac<fc::sha224> hmac_sha224;
@@ -0,0 +1,59 @@
+#pragma once
+#include <fc/crypto/public_key.hpp>
+#include <fc/crypto/signature.hpp>
+#include <fc/exception/exception.hpp>
+#include <memory>
+#include <vector>
+
+namespace fc { namespace crypto {
+
+   /**
+    *  Worker threads that recover public keys from, or verify, batches of K1, R1 and WebAuthn signatures.
+    *
+    *  The calling thread works on the batch alongside the workers, so a pool with 0 threads handles
+    *  the whole batch on the caller. Concurrent batches on the same pool are serialized.
+    */
+   class key_recovery_pool
+   {
+      public:
+         /// @param num_threads worker threads in addition to the calling thread
+         explicit key_recovery_pool( size_t num_threads );
+         ~key_recovery_pool();
+
+         size_t get_num_threads()const;
+
+         /**
+          *  Recovers the key of each signature, result[i] is recovered from sigs[i] and digests[i]. A single
+          *  digest is used for every signature.
+          *
+          *  A signature that fails to recover does not stop the batch: its result is left as a default
+          *  (invalid) public_key and, when errors is given, (*errors)[i] holds the exception while the
+          *  entries of recovered keys are null.
+          */
+         std::vector<public_key> recover_keys( const std::vector<signature>& sigs, const std::vector<sha256>& digests,
+                                               std::vector<fc::exception_ptr>* errors = nullptr,
+                                               bool check_canonical = true );
+
+         /**
+          *  result[i] is verify( keys[i], digests[i], sigs[i] ). A single key or digest is used for every
+          *  signature. R1 and WebAuthn verification keep the last key decoded per thread, so batches
+          *  grouped by key decode each key about once per thread.
+          */
+         std::vector<bool> verify_many( const std::vector<public_key>& keys, const std::vector<sha256>& digests,
+                                        const std::vector<signature>& sigs, bool check_canonical = true );
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+
+   /// key_recovery_pool::recover_keys on a shared pool with a worker per hardware thread, less the caller
+   std::vector<public_key> recover_keys( const std::vector<signature>& sigs, const std::vector<sha256>& digests,
+                                         std::vector<fc::exception_ptr>* errors = nullptr,
+                                         bool check_canonical = true );
+
+   /// key_recovery_pool::verify_many on the shared pool recover_keys uses
+   std::vector<bool> verify_many( const std::vector<public_key>& keys, const std::vector<sha256>& digests,
+                                  const std::vector<signature>& sigs, bool check_canonical = true );
+
+} } // fc::crypto
@@ -0,0 +1,99 @@
+#pragma once
+#include <fc/crypto/sha256.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <memory>
+#include <vector>
+
+namespace fc { namespace merkle {
+
+   /**
+    *  Merkle trees over sha256 leaves. An inner node is sha256::hash_pair( left, right ) and a level with an odd
+    *  number of nodes pairs its last node with itself. The root of a single leaf is that leaf, the root of no
+    *  leaves is sha256().
+    *
+    *  Duplicating the last node means the leaves [a, b, c] and [a, b, c, c] have the same root; callers that
+    *  must tell them apart commit to the leaf count as well.
+    */
+
+   /// the siblings from a leaf up to the root, bit l of index tells whether the node at level l is a right child
+   struct proof
+   {
+      uint64_t             index = 0;
+      std::vector<sha256>  path;
+
+      /// the root this proof gives for @p leaf
+      sha256 root( const sha256& leaf )const;
+      bool   verify( const sha256& leaf, const sha256& root )const { return this->root( leaf ) == root; }
+   };
+
+   /**
+    *  Worker threads that hash the levels of large trees. A level is split into chunks of pairs hashed with
+    *  sha256::hash_pairs; the calling thread works alongside the workers, so a pool with 0 threads builds the
+    *  whole tree on the caller. Concurrent builds on the same pool are serialized.
+    */
+   class thread_pool
+   {
+      public:
+         /// @param num_threads worker threads in addition to the calling thread
+         explicit thread_pool( size_t num_threads );
+         ~thread_pool();
+
+         size_t get_num_threads()const;
+
+         /// out[i] = sha256::hash_pair( in[2*i], in[2*i+1] ) for @p count pairs, @p out must not overlap @p in
+         void hash_pairs( const sha256* in, size_t count, sha256* out );
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+
+   /// the shared pool behind root() and tree, a worker per hardware thread less the caller
+   thread_pool& default_thread_pool();
+
+   /// the root of @p leaves without keeping the inner levels
+   sha256 root( std::vector<sha256> leaves, thread_pool& pool = default_thread_pool() );
+
+   /**
+    *  Every level of a tree, for proofs of many leaves. levels()[0] are the leaves and levels().back() holds
+    *  the root alone.
+    */
+   class tree
+   {
+      public:
+         explicit tree( std::vector<sha256> leaves, thread_pool& pool = default_thread_pool() );
+
+         sha256   root()const;
+         size_t   size()const { return _levels.front().size(); }
+         proof    get_proof( uint64_t index )const;
+
+         const std::vector<std::vector<sha256>>& levels()const { return _levels; }
+
+      private:
+         std::vector<std::vector<sha256>> _levels;
+   };
+
+   /**
+    *  A tree that grows one leaf at a time, keeping only the root of each complete subtree on its right edge.
+    *  append is amortized O(1) hashes and root() O(log n), both give the same root as merkle::root over every
+    *  leaf appended so far.
+    */
+   class incremental
+   {
+      public:
+         void     append( const sha256& leaf );
+         sha256   root()const;
+         uint64_t size()const { return _size; }
+
+      private:
+         /// _peaks[l] is the root of a complete subtree of 2^l leaves when bit l of _size is set
+         std::vector<sha256>  _peaks;
+         uint64_t             _size = 0;
+
+         friend struct fc::reflector<incremental>;
+   };
+
+} } // fc::merkle
+
+FC_REFLECT( fc::merkle::proof, (index)(path) )
+FC_REFLECT( fc::merkle::incremental, (_peaks)(_size) )
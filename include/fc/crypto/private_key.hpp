@@ -28,6 +28,8 @@ namespace fc { namespace crypto {
 
          public_key     get_public_key() const;
          signature      sign( const sha256& digest, bool require_canonical = true ) const;
+         /// sign( digests[i], require_canonical ) for each digest, with the key decoded once for the batch
+         std::vector<signature> sign_many( const std::vector<sha256>& digests, bool require_canonical = true ) const;
          sha512         generate_shared_secret( const public_key& pub ) const;
 
          template< typename KeyType = ecc::private_key_shim >
@@ -53,6 +53,35 @@ namespace fc { namespace crypto {
          friend class private_key;
    }; // public_key
 
+   /**
+    *  Whether @p sig signs @p digest with @p key: true exactly when recovering a key from @p sig gives @p key.
+    *  False rather than an exception for a signature of another key type, one recovery rejects, or any other
+    *  failure while checking.
+    *
+    *  R1 and WebAuthn signatures are checked against @p key directly, without building a recovered key. K1
+    *  signatures are too on the OpenSSL backend, but the secp256k1 backends, the default among them, recover
+    *  a key and compare, so K1 verification costs a full recovery there.
+    */
+   bool verify( const public_key& key, const sha256& digest, const signature& sig, bool check_canonical = true );
+
+   /**
+    *  Keys recovered by public_key( signature, digest, check_canonical ) can be kept in a bounded, sharded
+    *  LRU cache so that recovering the same signature and digest again is a hash lookup. The cache is
+    *  disabled until given a size.
+    */
+   struct recovery_cache_stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t size = 0;       ///< entries currently cached
+      uint64_t capacity = 0;   ///< maximum entries, 0 when disabled
+   };
+
+   /// sets the maximum number of cached keys and clears the cache, 0 disables it
+   void set_recovery_cache_size( size_t max_entries );
+   recovery_cache_stats get_recovery_cache_stats();
+   /// removes all cached keys and resets the counters
+   void clear_recovery_cache();
+
 } }  // fc::crypto
 
 namespace fc {
@@ -62,3 +91,4 @@ namespace fc {
 } // namespace fc
 
 FC_REFLECT(fc::crypto::public_key, (_storage) )
+FC_REFLECT(fc::crypto::recovery_cache_stats, (hits)(misses)(size)(capacity) )
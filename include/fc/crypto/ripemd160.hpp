@@ -1,6 +1,7 @@
 #pragma once
 
 #include <fc/fwd.hpp>
+#include <string.h>
 #include <fc/io/raw_fwd.hpp>
 #include <fc/reflect/typename.hpp>
 
@@ -37,16 +38,30 @@ class ripemd160
     {
       public:
         encoder();
+        encoder( const encoder& e );
         ~encoder();
-
-        void write( const char* d, uint32_t dlen );
+        encoder& operator=( const encoder& e );
+
+        /// writes that fit in the block buffer are staged inline and reach RIPEMD160_Update a block at a time
+        void write( const char* d, uint32_t dlen )
+        {
+          if( size_t( _buffered ) + dlen < sizeof(_buffer) ) {
+            memcpy( _buffer + _buffered, d, dlen );
+            _buffered += dlen;
+          } else
+            write_blocks( d, dlen );
+        }
         void put( char c ) { write( &c, 1 ); }
         void reset();
         ripemd160 result();
 
       private:
+        void write_blocks( const char* d, uint32_t dlen );
+
         struct      impl;
         fc::fwd<impl,96> my;
+        char        _buffer[64];
+        uint32_t    _buffered = 0;
     };
 
     template<typename T>
@@ -34,7 +34,9 @@ class sha224
     {
       public:
         encoder();
+        encoder( const encoder& e );
         ~encoder();
+        encoder& operator=( const encoder& e );
 
         void write( const char* d, uint32_t dlen );
         void put( char c ) { write( &c, 1 ); }
@@ -1,8 +1,11 @@
 #pragma once
 #include <fc/fwd.hpp>
+#include <string.h>
 #include <fc/string.hpp>
 #include <fc/platform_independence.hpp>
 #include <fc/io/raw_fwd.hpp>
+#include <utility>
+#include <vector>
 
 namespace fc
 {
@@ -24,6 +27,34 @@ class sha256
     static sha256 hash( const string& );
     static sha256 hash( const sha256& );
 
+    /**
+     * Hashes @p count messages at once, out[i] is the hash of the messages[i].second bytes at messages[i].first.
+     * Gives the same digests as hash() but without an encoder per message: on the SHA extensions when the CPU
+     * has them, otherwise eight messages at a time with AVX2 when they have the same number of blocks.
+     */
+    static void hash_many( const std::pair<const char*, size_t>* messages, size_t count, sha256* out );
+    static void hash_many( const std::vector<std::pair<const char*, size_t>>& messages, sha256* out )
+    {
+      hash_many( messages.data(), messages.size(), out );
+    }
+
+    /**
+     * The hash of the 64 bytes @p a || @p b, the node of a Merkle tree; the second block is all padding and its
+     * message schedule is precomputed.
+     */
+    static sha256 hash_pair( const sha256& a, const sha256& b );
+
+    /**
+     * out[i] = hash_pair( in[2*i], in[2*i+1] ) for @p count pairs, one level of a Merkle tree. @p out may be @p in.
+     */
+    static void hash_pairs( const sha256* in, size_t count, sha256* out );
+
+    /// the kernels behind hash_many, hash_pair and hash_pairs
+    enum class batch_backend { openssl, avx2, sha_ni };
+    static batch_backend get_batch_backend();
+    /// for tests and benchmarks, false when this CPU cannot run @p b
+    static bool set_batch_backend( batch_backend b );
+
     template<typename T>
     static sha256 hash( const T& t ) 
     { 
@@ -36,16 +67,30 @@ class sha256
     {
       public:
         encoder();
+        encoder( const encoder& e );
         ~encoder();
-
-        void write( const char* d, uint32_t dlen );
+        encoder& operator=( const encoder& e );
+
+        /// writes that fit in the block buffer are staged inline and reach SHA256_Update a block at a time
+        void write( const char* d, uint32_t dlen )
+        {
+          if( size_t( _buffered ) + dlen < sizeof(_buffer) ) {
+            memcpy( _buffer + _buffered, d, dlen );
+            _buffered += dlen;
+          } else
+            write_blocks( d, dlen );
+        }
         void put( char c ) { write( &c, 1 ); }
         void reset();
         sha256 result();
 
       private:
+        void write_blocks( const char* d, uint32_t dlen );
+
         struct      impl;
         fc::fwd<impl,112> my;
+        char        _buffer[64];
+        uint32_t    _buffered = 0;
     };
 
     template<typename T>
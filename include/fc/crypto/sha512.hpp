@@ -1,5 +1,6 @@
 #pragma once
 #include <fc/fwd.hpp>
+#include <string.h>
 #include <fc/string.hpp>
 
 namespace fc
@@ -32,16 +33,30 @@ class sha512
     {
       public:
         encoder();
+        encoder( const encoder& e );
         ~encoder();
+        encoder& operator=( const encoder& e );
 
-        void write( const char* d, uint32_t dlen );
+        /// writes that fit in the block buffer are staged inline and reach SHA512_Update a block at a time
+        void write( const char* d, uint32_t dlen )
+        {
+          if( size_t( _buffered ) + dlen < sizeof(_buffer) ) {
+            memcpy( _buffer + _buffered, d, dlen );
+            _buffered += dlen;
+          } else
+            write_blocks( d, dlen );
+        }
         void put( char c ) { write( &c, 1 ); }
         void reset();
         sha512 result();
 
       private:
+        void write_blocks( const char* d, uint32_t dlen );
+
         struct      impl;
         fc::fwd<impl,216> my;
+        char        _buffer[128];
+        uint32_t    _buffered = 0;
     };
 
     template<typename T>
@@ -74,5 +89,17 @@ class sha512
 
 } // fc
 
+namespace std
+{
+    template<>
+    struct hash<fc::sha512>
+    {
+       size_t operator()( const fc::sha512& s )const
+       {
+           return  s._hash[0];
+       }
+    };
+}
+
 #include <fc/reflect/reflect.hpp>
 FC_REFLECT_TYPENAME( fc::sha512 )
@@ -16,6 +16,8 @@ namespace fc { namespace crypto {
       };
    };
 
+   class public_key;
+
    class signature
    {
       public:
@@ -48,6 +50,7 @@ namespace fc { namespace crypto {
          friend struct reflector<signature>;
          friend class private_key;
          friend class public_key;
+         friend bool verify( const public_key& key, const sha256& digest, const signature& sig, bool check_canonical );
    }; // public_key
 
    size_t hash_value(const signature& b);
@@ -0,0 +1,46 @@
+#pragma once
+#include <fc/crypto/public_key.hpp>
+#include <fc/crypto/signature.hpp>
+
+namespace fc { namespace crypto {
+
+   /**
+    *  The string forms of public keys and signatures, as written by to_string() and read by the string
+    *  constructors (and so by to_variant and from_variant), can be kept in a bounded, sharded LRU cache so
+    *  that converting a popular key again is a hash lookup instead of a base58 conversion and checksum.
+    *  Each direction is cached separately: a string only maps back to the value it was parsed from, so
+    *  a key parsed from a non canonical form still prints in its canonical form. The cache is disabled
+    *  until given a size.
+    */
+   struct string_cache_stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t size = 0;       ///< entries currently cached
+      uint64_t capacity = 0;   ///< maximum entries for each type and direction, 0 when disabled
+   };
+
+   /// sets the maximum number of cached strings for each type and direction and clears the cache, 0 disables it
+   void set_string_cache_size( size_t max_entries );
+   string_cache_stats get_string_cache_stats();
+   /// removes all cached strings and resets the counters
+   void clear_string_cache();
+
+   namespace detail {
+      bool string_cache_enabled();
+
+      /// @return true and sets @p str when the string form of the value is cached
+      bool get_cached_string( const public_key& k, std::string& str );
+      bool get_cached_string( const signature& s, std::string& str );
+      void cache_string( const public_key& k, const std::string& str );
+      void cache_string( const signature& s, const std::string& str );
+
+      /// @return true and sets @p out when @p str was parsed before
+      bool get_cached_value( const std::string& str, public_key& out );
+      bool get_cached_value( const std::string& str, signature& out );
+      void cache_value( const std::string& str, const public_key& k );
+      void cache_value( const std::string& str, const signature& s );
+   }
+
+} }  // fc::crypto
+
+FC_REFLECT(fc::crypto::string_cache_stats, (hits)(misses)(size)(capacity) )
@@ -0,0 +1,95 @@
+#pragma once
+#include <fc/log/appender.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/filesystem.hpp>
+#include <functional>
+#include <vector>
+
+namespace fc
+{
+   /**
+    *  Describes a log call site, written once to the sites file the first time the site logs.
+    *  Records refer to it by id and only carry the argument values, in arg_names order.
+    */
+   struct binary_log_site {
+      uint32_t             id = 0;
+      string               file;
+      uint64_t             line = 0;
+      string               method;
+      string               format;
+      std::vector<string>  arg_names;
+   };
+
+   /**
+    *  A single log record as stored in the ring file.
+    */
+   struct binary_log_record {
+      int64_t              timestamp = 0; ///< microseconds since epoch
+      uint8_t              level = 0;
+      uint32_t             site = 0;
+      string               thread_name;
+      variants             args;
+   };
+
+   /**
+    *  Appender that writes compact, raw packed records to a memory mapped ring file instead of formatted
+    *  text. Once the ring is full the oldest records are overwritten. Call site metadata (file, line,
+    *  method, format and argument names) goes to "<file>.sites" once per site.
+    *
+    *  An existing ring file of the configured size is reopened and written from its head on, so records from
+    *  before a restart or crash survive; one that does not match, or has no readable sites file, is started
+    *  over. Use binary_log_reader or the fc_binlog_decode tool to render the records in console_appender
+    *  format.
+    */
+   class binary_appender final : public appender
+   {
+      public:
+         struct config {
+            fc::path    file = "fc_binlog.bin";
+            uint64_t    size_mb = 64; ///< size of the ring file
+         };
+
+         explicit binary_appender( const variant& args );
+         explicit binary_appender( const config& cfg );
+         ~binary_appender();
+
+         void initialize( boost::asio::io_service& io_service ) override {}
+         void log( const log_message& m ) override;
+
+         /// Records not written because they did not fit in the ring at all
+         uint64_t get_dropped_count()const;
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+
+   /**
+    *  Reads the records currently held by a binary_appender ring file, oldest first.
+    */
+   class binary_log_reader
+   {
+      public:
+         /// @param file path of the ring file, sites are read from "<file>.sites"
+         explicit binary_log_reader( const fc::path& file );
+         ~binary_log_reader();
+
+         const std::vector<binary_log_site>& get_sites()const;
+
+         /// calls cb for each record in the ring, oldest first
+         void for_each( const std::function<void(const binary_log_record&)>& cb )const;
+
+         /// record as a log_message with the arguments paired up with the site's argument names
+         log_message to_log_message( const binary_log_record& r )const;
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+
+} // namespace fc
+
+#include <fc/reflect/reflect.hpp>
+FC_REFLECT( fc::binary_log_site, (id)(file)(line)(method)(format)(arg_names) )
+FC_REFLECT( fc::binary_log_record, (timestamp)(level)(site)(thread_name)(args) )
+FC_REFLECT( fc::binary_appender::config, (file)(size_mb) )
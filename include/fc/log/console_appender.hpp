@@ -60,6 +60,15 @@ namespace fc
 
             void configure( const config& cfg );
 
+            /**
+             * Formats m the way log() prints it, without syslog header or colors.
+             * @param timestamp printed in place of the time the message is logged
+             */
+            static string format_log_line( const log_message& m, const time_point& timestamp );
+
+            /// appends the line format_log_line( m, timestamp ) returns to out
+            static void format_log_line( string& out, const log_message& m, const time_point& timestamp );
+
        private:
             class impl;
             std::unique_ptr<impl> my;
@@ -0,0 +1,50 @@
+#pragma once
+#include <fc/log/appender.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/filesystem.hpp>
+
+namespace fc
+{
+   /**
+    *  Appends log lines, in console_appender format, to a file through a large user space buffer that is
+    *  written out when full and by a background thread every flush_interval_ms.
+    *
+    *  The file is rotated when it reaches max_size_mb or is older than rotation_interval_s. Rotated files
+    *  are renamed to "<stem>-<YYYYMMDDTHHMMSS><extension>" and, when compress is set, gzipped by the
+    *  background thread.
+    */
+   class file_appender final : public appender
+   {
+      public:
+         struct config {
+            fc::path    file = "fc.log";
+            uint64_t    buffer_size_kb = 1024;
+            uint64_t    flush_interval_ms = 1000;   ///< 0 writes and flushes every line
+            uint64_t    max_size_mb = 0;            ///< 0 disables size based rotation
+            uint64_t    rotation_interval_s = 0;    ///< 0 disables time based rotation
+            uint32_t    max_rotated_files = 0;      ///< oldest rotated files beyond this are removed, 0 keeps all
+            bool        compress = false;           ///< gzip rotated files
+         };
+
+         explicit file_appender( const variant& args );
+         explicit file_appender( const config& cfg );
+         ~file_appender();
+
+         void initialize( boost::asio::io_service& io_service ) override {}
+         void log( const log_message& m ) override;
+
+         /// writes out and flushes buffered lines
+         void flush();
+
+         /// closes the current file, renames it and starts a new one
+         void rotate();
+
+      private:
+         class impl;
+         std::unique_ptr<impl> my;
+   };
+} // namespace fc
+
+#include <fc/reflect/reflect.hpp>
+FC_REFLECT( fc::file_appender::config,
+            (file)(buffer_size_kb)(flush_interval_ms)(max_size_mb)(rotation_interval_s)(max_rotated_files)(compress) )
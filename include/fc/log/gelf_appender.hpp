@@ -15,6 +15,7 @@ namespace fc
     {
       string endpoint = "127.0.0.1:12201";
       string host = "fc"; // the name of the host, source or application that sent this message (just passed through to GELF server)
+      uint32_t max_datagram_size = 512; // messages compressing to more than this are split into GELF chunks of at most this size
     };
 
     gelf_appender(const variant& args);
@@ -37,4 +38,4 @@ namespace fc
 
 #include <fc/reflect/reflect.hpp>
 FC_REFLECT(fc::gelf_appender::config,
-           (endpoint)(host))
+           (endpoint)(host)(max_datagram_size))
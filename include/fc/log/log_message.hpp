@@ -64,15 +64,15 @@ namespace fc
         explicit log_context( const variant& v );
         variant to_variant()const;
 
-        string        get_file()const;
+        const string& get_file()const;
         uint64_t      get_line_number()const;
-        string        get_method()const;
-        string        get_thread_name()const;
-        string        get_task_name()const;
-        string        get_host_name()const;
+        const string& get_method()const;
+        const string& get_thread_name()const;
+        const string& get_task_name()const;
+        const string& get_host_name()const;
         time_point    get_timestamp()const;
         log_level     get_log_level()const;
-        string        get_context()const;
+        const string& get_context()const;
 
         void          append_context( const fc::string& c );
 
@@ -123,7 +123,7 @@ namespace fc
          string         get_limited_message()const;
                               
          log_context    get_context()const;
-         string         get_format()const;
+         const string&  get_format()const;
          variant_object get_data()const;
 
       private:
@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/utility.hpp>
 #include <memory>
+#include <vector>
 
 #include <boost/asio.hpp>
 
@@ -24,6 +25,8 @@ namespace fc {
       void open();
       void send_to(const char* b, size_t l, boost::asio::ip::udp::endpoint &to);
       void send_to(const std::shared_ptr<const char>& b, size_t l, boost::asio::ip::udp::endpoint &to);
+      /// sends each buffer as a separate datagram, batched into as few system calls as the platform allows
+      void send_to(const std::vector<boost::asio::const_buffer>& datagrams, boost::asio::ip::udp::endpoint &to);
       void close();
 
       void set_reuse_address(bool);
@@ -0,0 +1,34 @@
+#include <fc/log/binary_appender.hpp>
+#include <fc/log/console_appender.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <cstdio>
+#include <iostream>
+
+/**
+ *  Renders the records of a binary_appender ring file in console_appender format, oldest first.
+ *
+ *  usage: fc_binlog_decode <ring file>
+ */
+int main( int argc, char** argv ) {
+   if( argc != 2 ) {
+      std::cerr << "usage: " << argv[0] << " <ring file>" << std::endl;
+      return 1;
+   }
+   try {
+      fc::binary_log_reader reader( argv[1] );
+      reader.for_each( [&]( const fc::binary_log_record& r ) {
+         const fc::log_message m = reader.to_log_message( r );
+         const std::string line = fc::console_appender::format_log_line( m, m.get_context().get_timestamp() );
+         fwrite( line.data(), 1, line.size(), stdout );
+         fputc( '\n', stdout );
+      } );
+   } catch( const fc::exception& e ) {
+      std::cerr << e.to_detail_string() << std::endl;
+      return 1;
+   } catch( const std::exception& e ) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,268 @@
+#include <fc/blocked_bloom_filter.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_BLOCKED_BLOOM_X86 1
+#include <immintrin.h>
+#endif
+
+/* A key's hash h selects block (h >> 32) * blocks >> 32. Its k bits within the block's 512 come from double
+ * hashing: g_i = a + i * b in 32 bit arithmetic, with a the low half of h and b the high half of h times the
+ * golden ratio. Taking bits of g_i directly would leave a key only about 2^18 different patterns, which caps the
+ * false positive rate far above what k = 16 can reach, so bit i is the top nine bits of g_i times an odd salt.
+ * Read as 32 bit words on a little endian machine, bit pos is bit pos & 31 of word pos >> 5, which is how the
+ * AVX2 probe gathers them.
+ */
+
+namespace fc {
+
+   namespace detail {
+
+      struct blocked_bloom_probe {
+         uint32_t a;
+         uint32_t b;
+      };
+
+      static inline blocked_bloom_probe blocked_bloom_bits( uint64_t h ) {
+         return { uint32_t( h ), uint32_t( ( h * 0x9e3779b97f4a7c15ull ) >> 32 ) };
+      }
+
+      alignas(32) static const uint32_t blocked_bloom_salt[blocked_bloom_filter::max_hash_count] = {
+         0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du, 0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+         0x1b873593u, 0xcc9e2d51u, 0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu, 0x165667b1u, 0xd3a2646du, 0xfd7046c5u
+      };
+
+      static inline uint32_t blocked_bloom_pos( uint32_t g, uint32_t i ) {
+         return ( g * blocked_bloom_salt[i & ( blocked_bloom_filter::max_hash_count - 1 )] ) >> 23;
+      }
+
+      void blocked_bloom_mask( uint64_t h, uint32_t k, uint64_t* mask ) {
+         std::fill_n( mask, 8, 0 );
+         blocked_bloom_probe p = blocked_bloom_bits( h );
+         for( uint32_t i = 0; i < k; ++i, p.a += p.b ) {
+            const uint32_t pos = blocked_bloom_pos( p.a, i );
+            mask[pos >> 6] |= uint64_t( 1 ) << ( pos & 63 );
+         }
+      }
+
+      static inline void insert_block( blocked_bloom_filter::block& blk, blocked_bloom_probe p, uint32_t k ) {
+         for( uint32_t i = 0; i < k; ++i, p.a += p.b ) {
+            const uint32_t pos = blocked_bloom_pos( p.a, i );
+            blk.words[pos >> 6] |= uint64_t( 1 ) << ( pos & 63 );
+         }
+      }
+
+      static bool contains_scalar( const blocked_bloom_filter::block& blk, blocked_bloom_probe p, uint32_t k ) {
+         for( uint32_t i = 0; i < k; ++i, p.a += p.b ) {
+            const uint32_t pos = blocked_bloom_pos( p.a, i );
+            if( !( ( blk.words[pos >> 6] >> ( pos & 63 ) ) & 1 ) )
+               return false;
+         }
+         return true;
+      }
+
+#ifdef FC_BLOCKED_BLOOM_X86
+
+      /// the bits for hashes @p g with salts @p salt that are clear in the block, in the lanes below @p k
+      __attribute__((target("avx2")))
+      static inline __m256i missing_avx2( const int* words, __m256i g, __m256i salt, __m256i lane, __m256i k ) {
+         const __m256i pos = _mm256_srli_epi32( _mm256_mullo_epi32( g, salt ), 23 );
+         const __m256i w = _mm256_i32gather_epi32( words, _mm256_srli_epi32( pos, 5 ), 4 );
+         const __m256i bit = _mm256_sllv_epi32( _mm256_set1_epi32( 1 ), _mm256_and_si256( pos, _mm256_set1_epi32( 31 ) ) );
+         return _mm256_andnot_si256( w, _mm256_and_si256( bit, _mm256_cmpgt_epi32( k, lane ) ) );
+      }
+
+      __attribute__((target("avx2")))
+      static bool contains_avx2( const blocked_bloom_filter::block& blk, blocked_bloom_probe p, uint32_t k ) {
+         const int* words = reinterpret_cast<const int*>( blk.words.data() );
+         const __m256i lane = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+         const __m256i kv = _mm256_set1_epi32( int( k ) );
+         const __m256i* salt = reinterpret_cast<const __m256i*>( blocked_bloom_salt );
+         __m256i g = _mm256_add_epi32( _mm256_set1_epi32( int( p.a ) ), _mm256_mullo_epi32( lane, _mm256_set1_epi32( int( p.b ) ) ) );
+         __m256i missing = missing_avx2( words, g, _mm256_load_si256( salt ), lane, kv );
+         if( k > 8 ) {
+            g = _mm256_add_epi32( g, _mm256_set1_epi32( int( p.b * 8 ) ) );
+            missing = _mm256_or_si256( missing, missing_avx2( words, g, _mm256_load_si256( salt + 1 ),
+                                                              _mm256_add_epi32( lane, _mm256_set1_epi32( 8 ) ), kv ) );
+         }
+         return _mm256_testz_si256( missing, missing );
+      }
+
+      static bool cpu_has_avx2() {
+         __builtin_cpu_init();
+         return __builtin_cpu_supports( "avx2" );
+      }
+
+#endif // FC_BLOCKED_BLOOM_X86
+
+      static bool blocked_bloom_backend_supported( blocked_bloom_backend b ) {
+         switch( b ) {
+            case blocked_bloom_backend::scalar:
+               return true;
+#ifdef FC_BLOCKED_BLOOM_X86
+            case blocked_bloom_backend::avx2:
+               return cpu_has_avx2();
+#endif
+            default:
+               return false;
+         }
+      }
+
+      static std::atomic<blocked_bloom_backend>& blocked_bloom_backend_state() {
+         static std::atomic<blocked_bloom_backend> b{ blocked_bloom_backend_supported( blocked_bloom_backend::avx2 )
+                                                      ? blocked_bloom_backend::avx2 : blocked_bloom_backend::scalar };
+         return b;
+      }
+
+      using contains_fn = bool (*)( const blocked_bloom_filter::block&, blocked_bloom_probe, uint32_t );
+
+      static contains_fn select_contains( uint32_t k ) {
+#ifdef FC_BLOCKED_BLOOM_X86
+         if( k <= blocked_bloom_filter::max_hash_count &&
+             blocked_bloom_backend_state().load( std::memory_order_relaxed ) == blocked_bloom_backend::avx2 )
+            return contains_avx2;
+#endif
+         return contains_scalar;
+      }
+
+      void blocked_bloom_size( uint64_t projected_element_count, double false_positive_probability, uint64_t& blocks, uint32_t& k ) {
+         FC_ASSERT( projected_element_count > 0, "a bloom filter needs a projected element count" );
+         FC_ASSERT( false_positive_probability > 0.0 && false_positive_probability < 1.0,
+                    "false positive probability ${p} is not in (0,1)", ("p", false_positive_probability) );
+         // the fewest bits per key that reach the rate, each with its best k
+         const double n = double( projected_element_count );
+         double bpk = std::max( 1.0, std::log2( 1.0 / false_positive_probability ) * 1.44 );
+         for( ; bpk < 256; bpk *= 1.02 ) {
+            const uint64_t b = uint64_t( std::ceil( n * bpk / 512 ) );
+            double best = 1.0;
+            for( uint32_t i = 1; i <= blocked_bloom_filter::max_hash_count; ++i ) {
+               const double f = blocked_bloom_filter::blocked_fpp( b, projected_element_count, i );
+               if( f < best ) {
+                  best = f;
+                  k = i;
+               }
+            }
+            if( best <= false_positive_probability )
+               break;
+         }
+         const double b = std::ceil( n * bpk / 512 );
+         FC_ASSERT( b <= double( uint64_t( 1 ) << 32 ), "bloom filter of ${b} blocks is too large", ("b", b) );
+         blocks = uint64_t( b );
+      }
+
+   } // namespace detail
+
+   blocked_bloom_backend get_blocked_bloom_backend() {
+      return detail::blocked_bloom_backend_state().load( std::memory_order_relaxed );
+   }
+
+   bool set_blocked_bloom_backend( blocked_bloom_backend b ) {
+      if( !detail::blocked_bloom_backend_supported( b ) )
+         return false;
+      detail::blocked_bloom_backend_state() = b;
+      return true;
+   }
+
+   blocked_bloom_filter::blocked_bloom_filter( uint64_t projected_element_count, double false_positive_probability, uint64_t seed )
+   : seed_( seed ),
+     projected_element_count_( projected_element_count ),
+     desired_false_positive_probability_( false_positive_probability )
+   {
+      uint64_t blocks = 0;
+      detail::blocked_bloom_size( projected_element_count, false_positive_probability, blocks, hash_count_ );
+      blocks_.resize( size_t( blocks ) );
+   }
+
+   blocked_bloom_filter::blocked_bloom_filter( const bloom_parameters& p )
+   : blocked_bloom_filter( p.projected_element_count, p.false_positive_probability, p.random_seed )
+   {}
+
+   bool blocked_bloom_filter::operator == ( const blocked_bloom_filter& f )const {
+      return hash_count_ == f.hash_count_ && seed_ == f.seed_ &&
+             projected_element_count_ == f.projected_element_count_ &&
+             inserted_element_count_ == f.inserted_element_count_ &&
+             desired_false_positive_probability_ == f.desired_false_positive_probability_ &&
+             blocks_ == f.blocks_;
+   }
+
+   void blocked_bloom_filter::clear() {
+      std::fill( blocks_.begin(), blocks_.end(), block() );
+      inserted_element_count_ = 0;
+   }
+
+   void blocked_bloom_filter::insert_hash( uint64_t h ) {
+      FC_ASSERT( !blocks_.empty(), "insert into an empty bloom filter" );
+      detail::insert_block( blocks_[detail::blocked_bloom_index( h, blocks_.size() )], detail::blocked_bloom_bits( h ), hash_count_ );
+      ++inserted_element_count_;
+   }
+
+   bool blocked_bloom_filter::contains_hash( uint64_t h )const {
+      if( blocks_.empty() )
+         return false;
+      const auto& blk = blocks_[detail::blocked_bloom_index( h, blocks_.size() )];
+      return detail::select_contains( hash_count_ )( blk, detail::blocked_bloom_bits( h ), hash_count_ );
+   }
+
+   void blocked_bloom_filter::insert_many( const uint64_t* hashes, size_t count ) {
+      FC_ASSERT( !blocks_.empty(), "insert into an empty bloom filter" );
+      block* blk[batch_size];
+      for( size_t i = 0; i < count; i += batch_size ) {
+         const size_t n = std::min( batch_size, count - i );
+         for( size_t j = 0; j < n; ++j ) {
+            blk[j] = &blocks_[detail::blocked_bloom_index( hashes[i + j], blocks_.size() )];
+            __builtin_prefetch( blk[j], 1 );
+         }
+         for( size_t j = 0; j < n; ++j )
+            detail::insert_block( *blk[j], detail::blocked_bloom_bits( hashes[i + j] ), hash_count_ );
+      }
+      inserted_element_count_ += count;
+   }
+
+   size_t blocked_bloom_filter::contains_many( const uint64_t* hashes, size_t count, bool* found )const {
+      if( blocks_.empty() ) {
+         std::fill_n( found, count, false );
+         return 0;
+      }
+      const auto probe = detail::select_contains( hash_count_ );
+      const block* blk[batch_size];
+      size_t r = 0;
+      for( size_t i = 0; i < count; i += batch_size ) {
+         const size_t n = std::min( batch_size, count - i );
+         for( size_t j = 0; j < n; ++j ) {
+            blk[j] = &blocks_[detail::blocked_bloom_index( hashes[i + j], blocks_.size() )];
+            __builtin_prefetch( blk[j] );
+         }
+         for( size_t j = 0; j < n; ++j )
+            r += found[i + j] = probe( *blk[j], detail::blocked_bloom_bits( hashes[i + j] ), hash_count_ );
+      }
+      return r;
+   }
+
+   double blocked_bloom_filter::effective_fpp()const {
+      return blocked_fpp( blocks_.size(), inserted_element_count_, hash_count_ );
+   }
+
+   double blocked_bloom_filter::blocked_fpp( uint64_t blocks, uint64_t elements, uint32_t k ) {
+      if( blocks == 0 )
+         return 1.0;
+      if( elements == 0 )
+         return 0.0;
+      // keys per block are Poisson distributed, a block with i keys answers yes with the rate of a
+      // 512 bit filter holding i
+      const double lambda = double( elements ) / blocks;
+      const double spread = 10 * std::sqrt( lambda ) + 10;
+      const uint64_t lo = uint64_t( std::max( 0.0, lambda - spread ) );
+      const uint64_t hi = uint64_t( lambda + spread );
+      const double log_empty = std::log1p( -1.0 / 512 ) * k;
+      double f = 0;
+      for( uint64_t i = lo; i <= hi; ++i ) {
+         const double weight = std::exp( -lambda + i * std::log( lambda ) - std::lgamma( i + 1.0 ) );
+         f += weight * std::pow( -std::expm1( log_empty * i ), double( k ) );
+      }
+      return std::min( f, 1.0 );
+   }
+
+} // namespace fc
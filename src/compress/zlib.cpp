@@ -1,6 +1,13 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/cfile.hpp>
 
 #include "miniz.c"
+// miniz maps zlib names onto its own, keep zlib_compressor::compress as declared
+#undef compress
+
+#include <ios>
+#include <memory>
 
 namespace fc
 {
@@ -12,4 +19,87 @@ namespace fc
     free(compressed_message);
     return result;
   }
+
+  namespace
+  {
+    mz_bool put_string(const void* buf, int len, void* user)
+    {
+      static_cast<string*>(user)->append(static_cast<const char*>(buf), len);
+      return MZ_TRUE;
+    }
+
+    mz_bool put_cfile(const void* buf, int len, void* user)
+    {
+      static_cast<cfile*>(user)->write(static_cast<const char*>(buf), len);
+      return MZ_TRUE;
+    }
+
+    void put_le32(cfile& f, uint32_t v)
+    {
+      const char b[4] = { char(v), char(v >> 8), char(v >> 16), char(v >> 24) };
+      f.write(b, sizeof(b));
+    }
+  }
+
+  void gzip_compress_file(const path& in, const path& out)
+  {
+    cfile src;
+    src.set_file_path(in);
+    src.open("rb");
+    const uint64_t size = file_size(in);
+
+    cfile dst;
+    dst.set_file_path(out);
+    dst.open(cfile::truncate_rw_mode);
+
+    // RFC 1952 header: deflate, no flags, no mtime, unknown OS
+    const char header[10] = { char(0x1f), char(0x8b), 8, 0, 0, 0, 0, 0, 0, char(0xff) };
+    dst.write(header, sizeof(header));
+
+    // tdefl_compressor is a few hundred KB, keep it off the stack
+    std::unique_ptr<tdefl_compressor, decltype(&free)> comp((tdefl_compressor*)malloc(sizeof(tdefl_compressor)), &free);
+    // cfile reports its errors as std::ios_base::failure, this reports the compressor's the same way
+    if (!comp)
+      throw std::ios_base::failure("gzip_compress_file: unable to allocate compressor for " + in.generic_string());
+    tdefl_init(comp.get(), put_cfile, &dst, TDEFL_DEFAULT_MAX_PROBES); // raw deflate, gzip framing written here
+
+    std::vector<char> buf(1024 * 1024);
+    mz_ulong crc = MZ_CRC32_INIT;
+    uint64_t remaining = size;
+    do {
+      const size_t n = std::min<uint64_t>(remaining, buf.size());
+      src.read(buf.data(), n);
+      remaining -= n;
+      crc = mz_crc32(crc, (const mz_uint8*)buf.data(), n);
+      const tdefl_status s = tdefl_compress_buffer(comp.get(), buf.data(), n, remaining ? TDEFL_NO_FLUSH : TDEFL_FINISH);
+      if (s != (remaining ? TDEFL_STATUS_OKAY : TDEFL_STATUS_DONE))
+        throw std::ios_base::failure("gzip_compress_file: compression of " + in.generic_string() + " failed");
+    } while(remaining);
+
+    put_le32(dst, uint32_t(crc));
+    put_le32(dst, uint32_t(size));
+    dst.flush();
+  }
+
+  struct zlib_compressor::impl
+  {
+    std::unique_ptr<tdefl_compressor, decltype(&free)> comp{(tdefl_compressor*)malloc(sizeof(tdefl_compressor)), &free};
+  };
+
+  zlib_compressor::zlib_compressor()
+    : my(new impl)
+  {
+    FC_ASSERT(my->comp, "unable to allocate compressor");
+  }
+
+  zlib_compressor::~zlib_compressor() {}
+
+  void zlib_compressor::compress(const char* in, size_t size, string& out)
+  {
+    out.clear();
+    // same flags as tdefl_compress_mem_to_heap in zlib_compress
+    tdefl_init(my->comp.get(), put_string, &out, TDEFL_WRITE_ZLIB_HEADER | TDEFL_DEFAULT_MAX_PROBES);
+    const tdefl_status s = tdefl_compress_buffer(my->comp.get(), in, size, TDEFL_FINISH);
+    FC_ASSERT(s == TDEFL_STATUS_DONE, "zlib compression failed");
+  }
 }
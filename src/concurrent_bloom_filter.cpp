@@ -0,0 +1,148 @@
+#include <fc/concurrent_bloom_filter.hpp>
+#include <fc/exception/exception.hpp>
+
+namespace fc {
+
+   concurrent_bloom_filter::concurrent_bloom_filter( uint64_t projected_element_count, double false_positive_probability, uint64_t seed )
+   : seed_( seed ),
+     projected_element_count_( projected_element_count ),
+     desired_false_positive_probability_( false_positive_probability )
+   {
+      detail::blocked_bloom_size( projected_element_count, false_positive_probability, block_count_, hash_count_ );
+      blocks_.reset( new atomic_block[block_count_] );
+      clear();
+   }
+
+   bool concurrent_bloom_filter::insert_hash( uint64_t h ) {
+      uint64_t mask[8];
+      detail::blocked_bloom_mask( h, hash_count_, mask );
+      auto& blk = blocks_[detail::blocked_bloom_index( h, block_count_ )];
+      bool fresh = false;
+      for( size_t i = 0; i < 8; ++i ) {
+         if( mask[i] && ( blk.words[i].fetch_or( mask[i], std::memory_order_relaxed ) & mask[i] ) != mask[i] )
+            fresh = true;
+      }
+      if( fresh )
+         counts_[h & ( counter_count - 1 )].count.fetch_add( 1, std::memory_order_relaxed );
+      return fresh;
+   }
+
+   bool concurrent_bloom_filter::contains_hash( uint64_t h )const {
+      uint64_t mask[8];
+      detail::blocked_bloom_mask( h, hash_count_, mask );
+      const auto& blk = blocks_[detail::blocked_bloom_index( h, block_count_ )];
+      for( size_t i = 0; i < 8; ++i ) {
+         if( mask[i] && ( blk.words[i].load( std::memory_order_relaxed ) & mask[i] ) != mask[i] )
+            return false;
+      }
+      return true;
+   }
+
+   void concurrent_bloom_filter::clear() {
+      for( uint64_t b = 0; b < block_count_; ++b )
+         for( auto& w : blocks_[b].words )
+            w.store( 0, std::memory_order_relaxed );
+      for( auto& c : counts_ )
+         c.count.store( 0, std::memory_order_relaxed );
+   }
+
+   uint64_t concurrent_bloom_filter::element_count()const {
+      uint64_t n = 0;
+      for( const auto& c : counts_ )
+         n += c.count.load( std::memory_order_relaxed );
+      return n;
+   }
+
+   double concurrent_bloom_filter::effective_fpp()const {
+      return blocked_bloom_filter::blocked_fpp( block_count_, element_count(), hash_count_ );
+   }
+
+   blocked_bloom_filter concurrent_bloom_filter::snapshot()const {
+      blocked_bloom_filter f;
+      f.blocks_.resize( block_count_ );
+      for( uint64_t b = 0; b < block_count_; ++b )
+         for( size_t i = 0; i < 8; ++i )
+            f.blocks_[b].words[i] = blocks_[b].words[i].load( std::memory_order_relaxed );
+      f.hash_count_ = hash_count_;
+      f.seed_ = seed_;
+      f.projected_element_count_ = projected_element_count_;
+      f.inserted_element_count_ = element_count();
+      f.desired_false_positive_probability_ = desired_false_positive_probability_;
+      return f;
+   }
+
+   rotating_bloom_filter::rotating_bloom_filter( uint32_t generations, uint64_t generation_keys, fc::microseconds generation_age,
+                                                 double false_positive_probability, uint64_t seed )
+   : seed_( seed ),
+     generation_keys_( generation_keys ),
+     generation_age_( generation_age ),
+     generation_start_( fc::time_point::now().time_since_epoch().count() )
+   {
+      FC_ASSERT( generations >= 2, "a rotating bloom filter needs at least two generations" );
+      FC_ASSERT( generation_age.count() >= 0, "negative generation age" );
+      // a query looks at every generation, so each gets its share of the rate
+      for( uint32_t i = 0; i < generations; ++i )
+         generations_.emplace_back( new concurrent_bloom_filter( generation_keys, false_positive_probability / generations, seed ) );
+      // check the limits about 16 times per generation, and at least once per 64 new keys
+      check_mask_ = 1;
+      while( check_mask_ < 64 && check_mask_ * 32 <= generation_keys )
+         check_mask_ <<= 1;
+      --check_mask_;
+   }
+
+   bool rotating_bloom_filter::insert_hash( uint64_t h ) {
+      const uint64_t g = current_.load( std::memory_order_acquire );
+      if( !generation( g ).insert_hash( h ) )
+         return false;
+      bool fresh = true;
+      for( uint64_t i = 1; i < generations_.size() && fresh; ++i )
+         fresh = !generation( g + generations_.size() - i ).contains_hash( h );
+      if( ( h & check_mask_ ) == 0 ) {
+         if( generation( g ).element_count() >= generation_keys_ )
+            rotate_from( g, fc::time_point::now() );
+         else if( generation_age_.count() > 0 )
+            maybe_rotate();
+      }
+      return fresh;
+   }
+
+   bool rotating_bloom_filter::contains_hash( uint64_t h )const {
+      for( const auto& f : generations_ ) {
+         if( f->contains_hash( h ) )
+            return true;
+      }
+      return false;
+   }
+
+   bool rotating_bloom_filter::maybe_rotate( fc::time_point now ) {
+      if( generation_age_.count() <= 0 )
+         return false;
+      const uint64_t g = current_.load( std::memory_order_acquire );
+      if( now.time_since_epoch().count() - generation_start_.load( std::memory_order_relaxed ) < generation_age_.count() )
+         return false;
+      rotate_from( g, now );
+      return true;
+   }
+
+   void rotating_bloom_filter::rotate( fc::time_point now ) {
+      rotate_from( current_.load( std::memory_order_acquire ), now );
+   }
+
+   void rotating_bloom_filter::rotate_from( uint64_t g, fc::time_point now ) {
+      std::lock_guard<std::mutex> lock( rotate_mutex_ );
+      if( current_.load( std::memory_order_relaxed ) != g )
+         return;
+      // the oldest generation, queries that still look at it only lose keys that are leaving the window
+      generation( g + 1 ).clear();
+      generation_start_.store( now.time_since_epoch().count(), std::memory_order_relaxed );
+      current_.store( g + 1, std::memory_order_release );
+   }
+
+   double rotating_bloom_filter::effective_fpp()const {
+      double none = 1.0;
+      for( const auto& f : generations_ )
+         none *= 1.0 - f->effective_fpp();
+      return 1.0 - none;
+   }
+
+} // namespace fc
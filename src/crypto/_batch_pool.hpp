@@ -0,0 +1,83 @@
+#pragma once
+#include <fc/scoped_exit.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc { namespace detail {
+
+   /**
+    *  Worker threads that run one batch at a time alongside the calling thread. Batch::run() claims work
+    *  until none is left, so every worker and the caller call it and each returns once the batch is drained.
+    */
+   template<typename Batch>
+   class batch_pool {
+   public:
+      explicit batch_pool( size_t num_threads ) {
+         threads.reserve( num_threads );
+         for( size_t i = 0; i < num_threads; ++i )
+            threads.emplace_back( [this]() { work(); } );
+      }
+
+      ~batch_pool() {
+         {
+            std::lock_guard g( mtx );
+            stopping = true;
+         }
+         work_cv.notify_all();
+         for( auto& t : threads )
+            t.join();
+      }
+
+      size_t get_num_threads()const { return threads.size(); }
+
+      /// runs @p b on the workers and the calling thread, returns, or rethrows from b.run(), once no thread is
+      /// inside b.run()
+      void run( Batch& b ) {
+         std::lock_guard batch_guard( batch_mtx );
+         {
+            std::lock_guard g( mtx );
+            batch = &b;
+            ++generation;
+         }
+         auto finish = fc::make_scoped_exit( [&]() {
+            std::unique_lock lk( mtx );
+            batch = nullptr;
+            done_cv.wait( lk, [&]() { return active == 0; } );
+         } );
+         work_cv.notify_all();
+         b.run();
+      }
+
+   private:
+      void work() {
+         uint64_t seen = 0;
+         std::unique_lock lk( mtx );
+         while( true ) {
+            work_cv.wait( lk, [&]() { return stopping || ( batch && generation != seen ); } );
+            if( stopping )
+               return;
+            seen = generation;
+            Batch* b = batch;
+            ++active;
+            lk.unlock();
+            b->run();
+            lk.lock();
+            if( --active == 0 )
+               done_cv.notify_all();
+         }
+      }
+
+      std::vector<std::thread>      threads;
+      std::mutex                    batch_mtx;   ///< one batch at a time
+      std::mutex                    mtx;
+      std::condition_variable       work_cv;
+      std::condition_variable       done_cv;
+      Batch*                        batch = nullptr;
+      size_t                        active = 0;  ///< workers inside batch->run()
+      uint64_t                      generation = 0;
+      bool                          stopping = false;
+   };
+
+} } // fc::detail
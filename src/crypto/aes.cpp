@@ -1,4 +1,5 @@
 #include <fc/crypto/aes.hpp>
+#include <fc/crypto/encrypted_file.hpp>
 #include <fc/crypto/openssl.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/fwd_impl.hpp>
@@ -360,12 +361,19 @@ void              aes_save( const fc::path& file, const fc::sha512& key, std::ve
 } FC_RETHROW_EXCEPTIONS( warn, "", ("file",file) ) }
 
 /**
- *  recovers the plain_text saved via aes_save()
+ *  recovers the plain_text saved via aes_save() or written by encrypted_file_writer
  */
 std::vector<char> aes_load( const fc::path& file, const fc::sha512& key )
 { try {
    FC_ASSERT( fc::exists( file ) );
 
+   if( encrypted_file_reader::is_encrypted_file( file ) ) {
+      encrypted_file_reader reader( file, key );
+      std::vector<char> plain_text( reader.size() );
+      reader.read( plain_text.data(), plain_text.size() );
+      return plain_text;
+   }
+
    std::ifstream in( file.generic_string().c_str(), std::ifstream::binary );
    fc::sha512 check;
    std::vector<char> cipher;
@@ -0,0 +1,187 @@
+#include <fc/crypto/aes_gcm.hpp>
+#include <fc/crypto/openssl.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+#include <string.h>
+
+namespace fc {
+
+   namespace {
+      /// EVP takes int lengths
+      constexpr size_t max_update = size_t( 1 ) << 30;
+
+      void gcm_throw( const char* what ) {
+         FC_THROW_EXCEPTION( aes_exception, "error during aes 256 gcm ${what}",
+                             ("what", what)("s", ERR_error_string( ERR_get_error(), nullptr ) ) );
+      }
+
+      void gcm_update( EVP_CIPHER_CTX* ctx, bool enc, const char* in, size_t len, char* out ) {
+         while( len ) {
+            const int n = int( std::min( len, max_update ) );
+            int outl = 0;
+            const int r = enc ? EVP_EncryptUpdate( ctx, (unsigned char*)out, &outl, (const unsigned char*)in, n )
+                              : EVP_DecryptUpdate( ctx, (unsigned char*)out, &outl, (const unsigned char*)in, n );
+            if( r != 1 )
+               gcm_throw( "update" );
+            in += n;
+            if( out )
+               out += n;
+            len -= n;
+         }
+      }
+   }
+
+   struct aes_gcm::impl
+   {
+      evp_cipher_ctx enc;
+      evp_cipher_ctx dec;
+   };
+
+   aes_gcm::aes_gcm( const fc::sha256& key )
+   : my( new impl )
+   {
+      static int init = init_openssl();
+      (void)init;
+      // the key schedule is computed here once, messages only set the nonce
+      my->enc.obj = EVP_CIPHER_CTX_new();
+      my->dec.obj = EVP_CIPHER_CTX_new();
+      if( !my->enc || !my->dec )
+         gcm_throw( "context allocation" );
+      if( 1 != EVP_EncryptInit_ex( my->enc, EVP_aes_256_gcm(), nullptr, (const unsigned char*)key.data(), nullptr ) ||
+          1 != EVP_DecryptInit_ex( my->dec, EVP_aes_256_gcm(), nullptr, (const unsigned char*)key.data(), nullptr ) )
+         gcm_throw( "init" );
+   }
+
+   aes_gcm::~aes_gcm()
+   {
+   }
+
+   void aes_gcm::encrypt( const nonce_type& nonce, const char* in, size_t len, char* out, tag_type& tag,
+                          const char* aad, size_t aad_len )
+   {
+      EVP_CIPHER_CTX* ctx = my->enc;
+      if( 1 != EVP_EncryptInit_ex( ctx, nullptr, nullptr, nullptr, (const unsigned char*)nonce.data ) )
+         gcm_throw( "nonce" );
+      if( aad_len )
+         gcm_update( ctx, true, aad, aad_len, nullptr );
+      gcm_update( ctx, true, in, len, out );
+      int outl = 0;
+      if( 1 != EVP_EncryptFinal_ex( ctx, (unsigned char*)out + len, &outl ) ||
+          1 != EVP_CIPHER_CTX_ctrl( ctx, EVP_CTRL_GCM_GET_TAG, tag_size, tag.data ) )
+         gcm_throw( "final" );
+   }
+
+   bool aes_gcm::decrypt( const nonce_type& nonce, const char* in, size_t len, char* out, const tag_type& tag,
+                          const char* aad, size_t aad_len )
+   {
+      EVP_CIPHER_CTX* ctx = my->dec;
+      if( 1 != EVP_DecryptInit_ex( ctx, nullptr, nullptr, nullptr, (const unsigned char*)nonce.data ) ||
+          1 != EVP_CIPHER_CTX_ctrl( ctx, EVP_CTRL_GCM_SET_TAG, tag_size, (void*)tag.data ) )
+         gcm_throw( "nonce" );
+      if( aad_len )
+         gcm_update( ctx, false, aad, aad_len, nullptr );
+      gcm_update( ctx, false, in, len, out );
+      int outl = 0;
+      if( 1 != EVP_DecryptFinal_ex( ctx, (unsigned char*)out + len, &outl ) ) {
+         // unauthenticated plain text is not handed out
+         if( len )
+            memset( out, 0, len );
+         return false;
+      }
+      return true;
+   }
+
+   void aes_gcm::encrypt_many( aes_gcm_message* messages, size_t count )
+   {
+      for( size_t i = 0; i < count; ++i ) {
+         auto& m = messages[i];
+         encrypt( m.nonce, m.data, m.size, m.tag, m.aad, m.aad_size );
+      }
+   }
+
+   size_t aes_gcm::decrypt_many( aes_gcm_message* messages, size_t count )
+   {
+      size_t r = 0;
+      for( size_t i = 0; i < count; ++i ) {
+         auto& m = messages[i];
+         m.authentic = decrypt( m.nonce, m.data, m.size, m.tag, m.aad, m.aad_size );
+         r += m.authentic;
+      }
+      return r;
+   }
+
+   void aes_gcm::seal( const char* in, size_t len, char* out, const char* aad, size_t aad_len )
+   {
+      const nonce_type nonce = random_nonce();
+      memcpy( out, nonce.data, nonce_size );
+      tag_type tag;
+      encrypt( nonce, in, len, out + nonce_size, tag, aad, aad_len );
+      memcpy( out + nonce_size + len, tag.data, tag_size );
+   }
+
+   bool aes_gcm::open( const char* in, size_t len, char* out, const char* aad, size_t aad_len )
+   {
+      FC_ASSERT( len >= overhead, "sealed message of ${len} bytes is too short", ("len", len) );
+      nonce_type nonce;
+      tag_type tag;
+      memcpy( nonce.data, in, nonce_size );
+      memcpy( tag.data, in + len - tag_size, tag_size );
+      return decrypt( nonce, in + nonce_size, len - overhead, out, tag, aad, aad_len );
+   }
+
+   aes_gcm::nonce_type aes_gcm::random_nonce()
+   {
+      nonce_type n;
+      rand_bytes( n.data, nonce_size );
+      return n;
+   }
+
+   aes_gcm::nonce_type aes_gcm::chunk_nonce( const nonce_type& base, uint64_t chunk, bool last )
+   {
+      FC_ASSERT( chunk < ( uint64_t( 1 ) << 63 ), "stream of too many chunks" );
+      nonce_type n = base;
+      // big endian chunk * 2 + last into the low eight bytes, as TLS 1.3 does with its record numbers
+      const uint64_t v = chunk << 1 | uint64_t( last );
+      for( int i = 0; i < 8; ++i )
+         n.data[nonce_size - 1 - i] ^= char( v >> ( 8 * i ) );
+      return n;
+   }
+
+   aes_gcm_stream_encryptor::aes_gcm_stream_encryptor( const fc::sha256& key, const aes_gcm::nonce_type& base )
+   : _gcm( key ), _base( base )
+   {
+   }
+
+   void aes_gcm_stream_encryptor::encrypt( char* data, size_t len, aes_gcm::tag_type& tag, bool last,
+                                           const char* aad, size_t aad_len )
+   {
+      FC_ASSERT( !_finished, "chunk after the last chunk of a stream" );
+      _gcm.encrypt( aes_gcm::chunk_nonce( _base, _next, last ), data, len, tag, aad, aad_len );
+      ++_next;
+      _finished = last;
+   }
+
+   aes_gcm_stream_decryptor::aes_gcm_stream_decryptor( const fc::sha256& key, const aes_gcm::nonce_type& base )
+   : _gcm( key ), _base( base )
+   {
+   }
+
+   bool aes_gcm_stream_decryptor::decrypt( char* data, size_t len, const aes_gcm::tag_type& tag, bool last,
+                                           const char* aad, size_t aad_len )
+   {
+      if( _finished || !decrypt_at( _next, data, len, tag, last, aad, aad_len ) )
+         return false;
+      ++_next;
+      _finished = last;
+      return true;
+   }
+
+   bool aes_gcm_stream_decryptor::decrypt_at( uint64_t chunk, char* data, size_t len, const aes_gcm::tag_type& tag,
+                                              bool last, const char* aad, size_t aad_len )
+   {
+      return _gcm.decrypt( aes_gcm::chunk_nonce( _base, chunk, last ), data, len, tag, aad, aad_len );
+   }
+
+} // namespace fc
@@ -12,611 +12,197 @@
 // - E-mail usually won't line-break if there's no punctuation to break at.
 // - Doubleclicking selects the whole number as one word if it's all alphanumeric.
 //
-#ifndef BITCOIN_BASE58_H
-#define BITCOIN_BASE58_H
-
-#include <string>
-#include <vector>
-#include <limits>
-#include <algorithm>
 
 #include <fc/crypto/base58.hpp>
-#include <fc/log/logger.hpp>
-#include <fc/string.hpp>
 #include <fc/exception/exception.hpp>
 
-#include <stdexcept>
-#include <vector>
-#include <openssl/bn.h>
-
-/** Errors thrown by the bignum class */
-class bignum_error : public std::runtime_error
-{
-public:
-    explicit bignum_error(const std::string& str) : std::runtime_error(str) {}
-};
-
-
-/** RAII encapsulated BN_CTX (OpenSSL bignum context) */
-class CAutoBN_CTX
-{
-protected:
-    BN_CTX* pctx;
-    BN_CTX* operator=(BN_CTX* pnew) { return pctx = pnew; }
-
-public:
-    CAutoBN_CTX()
-    {
-        pctx = BN_CTX_new();
-        if (pctx == NULL)
-            throw bignum_error("CAutoBN_CTX : BN_CTX_new() returned NULL");
-    }
-
-    ~CAutoBN_CTX()
-    {
-        if (pctx != NULL)
-            BN_CTX_free(pctx);
-    }
-
-    operator BN_CTX*() { return pctx; }
-    BN_CTX& operator*() { return *pctx; }
-    BN_CTX** operator&() { return &pctx; }
-    bool operator!() { return (pctx == NULL); }
-};
-
-
-/** C++ wrapper for BIGNUM (OpenSSL bignum) */
-class CBigNum
-{
-    BIGNUM* bn;
-public:
-    CBigNum()
-       : bn(BN_new()) {}
-
-    CBigNum(const CBigNum& b)
-       : CBigNum()
-    {
-        if (!BN_copy(bn, b.bn))
-        {
-            BN_clear_free(bn);
-            throw bignum_error("CBigNum::CBigNum(const CBigNum&) : BN_copy failed");
-        }
-    }
-
-    CBigNum& operator=(const CBigNum& b)
-    {
-        if (!BN_copy(bn, b.bn))
-            throw bignum_error("CBigNum::operator= : BN_copy failed");
-        return (*this);
-    }
+#include <ctype.h>
+#include <string.h>
+#include <type_traits>
 
-    ~CBigNum()
-    {
-        BN_clear_free(bn);
-    }
-
-    //CBigNum(char n) is not portable.  Use 'signed char' or 'unsigned char'.
-    CBigNum(signed char n)      :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(short n)            :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(int n)              :CBigNum() { if (n >= 0) setulong(n); else setint64(n); }
-    CBigNum(int64_t n)          :CBigNum() { setint64(n); }
-    CBigNum(unsigned char n)    :CBigNum() { setulong(n); }
-    CBigNum(unsigned short n)   :CBigNum() { setulong(n); }
-    CBigNum(unsigned int n)     :CBigNum() { setulong(n); }
-    CBigNum(uint64_t n)         :CBigNum() { setuint64(n); }
-
-    explicit CBigNum(const std::vector<unsigned char>& vch)
-       : CBigNum()
-    {
-        setvch(vch);
-    }
-
-    void setulong(unsigned long n)
-    {
-        if (!BN_set_word(bn, n))
-            throw bignum_error("CBigNum conversion from unsigned long : BN_set_word failed");
-    }
-
-    unsigned long getulong() const
-    {
-        return BN_get_word(bn);
-    }
-
-    unsigned int getuint() const
-    {
-        return BN_get_word(bn);
-    }
-
-    int getint() const
-    {
-        unsigned long n = BN_get_word(bn);
-        if (!BN_is_negative(bn))
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::max() : n);
-        else
-            return (n > (unsigned long)std::numeric_limits<int>::max() ? std::numeric_limits<int>::min() : -(int)n);
-    }
+/* The number is converted between 32 bit limbs of the bytes and limbs of five base58 digits (58^5 < 2^30), so one
+ * pass over the limbs moves four bytes or five digits and the divisions are by a constant. Keys and signatures,
+ * 33, 37, 65 and 69 bytes, run with compile time sizes on stack buffers.
+ */
 
-    void setint64(int64_t n)
-    {
-        unsigned char pch[sizeof(n) + 6];
-        unsigned char* p = pch + 4;
-        bool fNegative = false;
-        if (n < (int64_t)0)
-        {
-            n = -n;
-            fNegative = true;
-        }
-        bool fLeadingZeroes = true;
-        for (int i = 0; i < 8; i++)
-        {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if (fLeadingZeroes)
-            {
-                if (c == 0)
-                    continue;
-                if (c & 0x80)
-                    *p++ = (fNegative ? 0x80 : 0);
-                else if (fNegative)
-                    c |= 0x80;
-                fLeadingZeroes = false;
-            }
-            *p++ = c;
-        }
-        unsigned int nSize = p - (pch + 4);
-        pch[0] = (nSize >> 24) & 0xff;
-        pch[1] = (nSize >> 16) & 0xff;
-        pch[2] = (nSize >> 8) & 0xff;
-        pch[3] = (nSize) & 0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
+namespace fc {
 
-    void setuint64(uint64_t n)
-    {
-        unsigned char pch[sizeof(n) + 6];
-        unsigned char* p = pch + 4;
-        bool fLeadingZeroes = true;
-        for (int i = 0; i < 8; i++)
-        {
-            unsigned char c = (n >> 56) & 0xff;
-            n <<= 8;
-            if (fLeadingZeroes)
-            {
-                if (c == 0)
-                    continue;
-                if (c & 0x80)
-                    *p++ = 0;
-                fLeadingZeroes = false;
+   namespace detail {
+
+      static constexpr char base58_chars[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+      constexpr uint32_t base58_limb = 58u * 58u * 58u * 58u * 58u;
+      constexpr uint32_t base58_pow[6] = { 1, 58, 58u * 58u, 58u * 58u * 58u, 58u * 58u * 58u * 58u, base58_limb };
+
+      struct base58_table {
+         int8_t digit[256];
+         constexpr base58_table() : digit() {
+            for( int i = 0; i < 256; ++i )
+               digit[i] = -1;
+            for( int i = 0; i < 58; ++i )
+               digit[(unsigned char) base58_chars[i]] = int8_t( i );
+         }
+      };
+      static constexpr base58_table base58_digits{};
+
+      /// base58 limbs for @p size bytes, the digits are at most 138% of the bytes
+      constexpr size_t base58_encode_limbs( size_t size ) { return ( size * 138 / 100 + 1 ) / 5 + 1; }
+      /// 32 bit limbs for @p digits base58 digits, the bytes are at most 73.3% of the digits
+      constexpr size_t base58_decode_limbs( size_t digits ) { return digits * 733 / 4000 + 2; }
+
+      /// @p size is a size_t or a std::integral_constant for the fixed size payloads
+      template<typename Size>
+      static std::string encode_base58( const unsigned char* d, Size size, uint32_t* limbs, const fc::yield_function_t& yield ) {
+         size_t zeros = 0;
+         while( zeros < size && d[zeros] == 0 )
+            ++zeros;
+
+         size_t used = 0;
+         // limbs = limbs * mul + word
+         auto push = [&]( uint64_t mul, uint32_t word ) {
+            uint64_t carry = word;
+            for( size_t j = 0; j < used; ++j ) {
+               const uint64_t t = uint64_t( limbs[j] ) * mul + carry;
+               limbs[j] = uint32_t( t % base58_limb );
+               carry = t / base58_limb;
             }
-            *p++ = c;
-        }
-        unsigned int nSize = p - (pch + 4);
-        pch[0] = (nSize >> 24) & 0xff;
-        pch[1] = (nSize >> 16) & 0xff;
-        pch[2] = (nSize >> 8) & 0xff;
-        pch[3] = (nSize) & 0xff;
-        BN_mpi2bn(pch, p - pch, bn);
-    }
-
-
-    void setvch(const std::vector<unsigned char>& vch)
-    {
-        std::vector<unsigned char> vch2(vch.size() + 4);
-        unsigned int nSize = vch.size();
-        // BIGNUM's byte stream format expects 4 bytes of
-        // big endian size data info at the front
-        vch2[0] = (nSize >> 24) & 0xff;
-        vch2[1] = (nSize >> 16) & 0xff;
-        vch2[2] = (nSize >> 8) & 0xff;
-        vch2[3] = (nSize >> 0) & 0xff;
-        // swap data to big endian
-        reverse_copy(vch.begin(), vch.end(), vch2.begin() + 4);
-        BN_mpi2bn(&vch2[0], vch2.size(), bn);
-    }
-
-    std::vector<unsigned char> getvch() const
-    {
-        unsigned int nSize = BN_bn2mpi(bn, NULL);
-        if (nSize <= 4)
-            return std::vector<unsigned char>();
-        std::vector<unsigned char> vch(nSize);
-        BN_bn2mpi(bn, &vch[0]);
-        vch.erase(vch.begin(), vch.begin() + 4);
-        reverse(vch.begin(), vch.end());
-        return vch;
-    }
-
-    CBigNum& SetCompact(unsigned int nCompact)
-    {
-        unsigned int nSize = nCompact >> 24;
-        std::vector<unsigned char> vch(4 + nSize);
-        vch[3] = nSize;
-        if (nSize >= 1) vch[4] = (nCompact >> 16) & 0xff;
-        if (nSize >= 2) vch[5] = (nCompact >> 8) & 0xff;
-        if (nSize >= 3) vch[6] = (nCompact >> 0) & 0xff;
-        BN_mpi2bn(&vch[0], vch.size(), bn);
-        return *this;
-    }
-
-    unsigned int GetCompact() const
-    {
-        unsigned int nSize = BN_bn2mpi(bn, NULL);
-        std::vector<unsigned char> vch(nSize);
-        nSize -= 4;
-        BN_bn2mpi(bn, &vch[0]);
-        unsigned int nCompact = nSize << 24;
-        if (nSize >= 1) nCompact |= (vch[4] << 16);
-        if (nSize >= 2) nCompact |= (vch[5] << 8);
-        if (nSize >= 3) nCompact |= (vch[6] << 0);
-        return nCompact;
-    }
-
-    void SetHex(const std::string& str)
-    {
-        // skip 0x
-        const char* psz = str.c_str();
-        while (isspace(*psz))
-            psz++;
-        bool fNegative = false;
-        if (*psz == '-')
-        {
-            fNegative = true;
-            psz++;
-        }
-        if (psz[0] == '0' && tolower(psz[1]) == 'x')
-            psz += 2;
-        while (isspace(*psz))
+            for( ; carry; carry /= base58_limb )
+               limbs[used++] = uint32_t( carry % base58_limb );
+         };
+
+         size_t i = zeros;
+         const size_t head = ( size - zeros ) % 4;
+         if( head ) {
+            uint32_t word = 0;
+            for( size_t k = 0; k < head; ++k )
+               word = word << 8 | d[i + k];
+            push( uint64_t( 1 ) << ( 8 * head ), word );
+            i += head;
+         }
+         for( size_t words = 0; i < size; i += 4, ++words ) {
+            if( std::is_integral<Size>::value && words % 64 == 63 )
+               yield();
+            push( uint64_t( 1 ) << 32, uint32_t( d[i] ) << 24 | uint32_t( d[i+1] ) << 16 | uint32_t( d[i+2] ) << 8 | d[i+3] );
+         }
+
+         if( used == 0 )
+            return std::string( zeros, base58_chars[0] );
+         size_t top_digits = 0;
+         for( uint32_t top = limbs[used - 1]; top; top /= 58 )
+            ++top_digits;
+
+         std::string str( zeros + top_digits + 5 * ( used - 1 ), base58_chars[0] );
+         char* out = &str[str.size()];
+         for( size_t j = 0; j < used; ++j ) {
+            uint32_t limb = limbs[j];
+            const size_t n = j + 1 < used ? 5 : top_digits;
+            for( size_t k = 0; k < n; ++k, limb /= 58 )
+               *--out = base58_chars[limb % 58];
+         }
+         return str;
+      }
+
+      /// the digits of a base58 string, with the whitespace rules of the Bitcoin decoder
+      struct base58_digits_range {
+         const char* begin = nullptr;
+         const char* end = nullptr;
+         size_t      zeros = 0;     ///< leading '1's
+      };
+
+      static bool parse_base58( const char* psz, base58_digits_range& r ) {
+         while( isspace( (unsigned char) *psz ) )
             psz++;
-
-        // hex string to bignum
-        static signed char phexdigit[256] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,1,2,3,4,5,6,7,8,9,0,0,0,0,0,0, 0,0xa,0xb,0xc,0xd,0xe,0xf,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0xa,0xb,0xc,0xd,0xe,0xf,0,0,0,0,0,0,0,0,0 };
-        *this = 0;
-        while (isxdigit(*psz))
-        {
-            *this <<= 4;
-            int n = phexdigit[(unsigned char)*psz++];
-            *this += n;
-        }
-        if (fNegative)
-            BN_set_negative(bn, 1);
-    }
-
-    std::string ToString(int nBase=10) const
-    {
-        CAutoBN_CTX pctx;
-        CBigNum bnBase = nBase;
-        CBigNum bn0 = 0;
-        std::string str;
-        CBigNum bn = *this;
-        BN_set_negative(bn.bn, false);
-        CBigNum dv;
-        CBigNum rem;
-        if (BN_cmp(bn.bn, bn0.bn) == 0)
-            return "0";
-        while (BN_cmp(bn.bn, bn0.bn) > 0)
-        {
-            if (!BN_div(dv.bn, rem.bn, bn.bn, bnBase.bn, pctx))
-                throw bignum_error("CBigNum::ToString() : BN_div failed");
-            bn = dv;
-            unsigned int c = rem.getulong();
-            str += "0123456789abcdef"[c];
-        }
-        if (BN_is_negative(this->bn))
-            str += "-";
-        reverse(str.begin(), str.end());
-        return str;
-    }
-
-    std::string GetHex() const
-    {
-        return ToString(16);
-    }
-
-
-
-    bool operator!() const
-    {
-        return BN_is_zero(bn);
-    }
-
-    CBigNum& operator+=(const CBigNum& b)
-    {
-        if (!BN_add(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator+= : BN_add failed");
-        return *this;
-    }
-
-    CBigNum& operator-=(const CBigNum& b)
-    {
-        if (!BN_sub(bn, bn, b.bn))
-            throw bignum_error("CBigNum::operator-= : BN_sub failed");
-        return *this;
-    }
-
-    CBigNum& operator*=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_mul(bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator*= : BN_mul failed");
-        return *this;
-    }
-
-    CBigNum& operator/=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_div(bn, NULL, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator/= : BN_div failed");
-        return *this;
-    }
-
-    CBigNum& operator%=(const CBigNum& b)
-    {
-        CAutoBN_CTX pctx;
-        if (!BN_div(NULL, bn, bn, b.bn, pctx))
-            throw bignum_error("CBigNum::operator%= : BN_div failed");
-        return *this;
-    }
-
-    CBigNum& operator<<=(unsigned int shift)
-    {
-        if (!BN_lshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator<<= : BN_lshift failed");
-        return *this;
-    }
-
-    CBigNum& operator>>=(unsigned int shift)
-    {
-        // Note: BN_rshift segfaults on 64-bit if 2^shift is greater than the number
-        //   if built on ubuntu 9.04 or 9.10, probably depends on version of openssl
-        CBigNum a = 1;
-        a <<= shift;
-        if (BN_cmp(a.bn, bn) > 0)
-        {
-            *this = 0;
-            return *this;
-        }
-
-        if (!BN_rshift(bn, bn, shift))
-            throw bignum_error("CBigNum:operator>>= : BN_rshift failed");
-        return *this;
-    }
-
-
-    CBigNum& operator++()
-    {
-        // prefix operator
-        if (!BN_add(bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator++ : BN_add failed");
-        return *this;
-    }
-
-    const CBigNum operator++(int)
-    {
-        // postfix operator
-        const CBigNum ret = *this;
-        ++(*this);
-        return ret;
-    }
-
-    CBigNum& operator--()
-    {
-        // prefix operator
-        CBigNum r;
-        if (!BN_sub(r.bn, bn, BN_value_one()))
-            throw bignum_error("CBigNum::operator-- : BN_sub failed");
-        *this = r;
-        return *this;
-    }
-
-    const CBigNum operator--(int)
-    {
-        // postfix operator
-        const CBigNum ret = *this;
-        --(*this);
-        return ret;
-    }
-
-    const BIGNUM* to_bignum() const {
-       return bn;
-    }
-    BIGNUM* to_bignum() {
-       return bn;
-    }
-};
-
-
-
-inline const CBigNum operator+(const CBigNum& a, const CBigNum& b)
-{
-    CBigNum r;
-    if (!BN_add(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator+ : BN_add failed");
-    return r;
-}
-
-inline const CBigNum operator-(const CBigNum& a, const CBigNum& b)
-{
-    CBigNum r;
-    if (!BN_sub(r.to_bignum(), a.to_bignum(), b.to_bignum()))
-        throw bignum_error("CBigNum::operator- : BN_sub failed");
-    return r;
-}
-
-inline const CBigNum operator-(const CBigNum& a)
-{
-    CBigNum r(a);
-    BN_set_negative(r.to_bignum(), !BN_is_negative(r.to_bignum()));
-    return r;
-}
-
-inline const CBigNum operator*(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_mul(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator* : BN_mul failed");
-    return r;
-}
-
-inline const CBigNum operator/(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_div(r.to_bignum(), NULL, a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator/ : BN_div failed");
-    return r;
-}
-
-inline const CBigNum operator%(const CBigNum& a, const CBigNum& b)
-{
-    CAutoBN_CTX pctx;
-    CBigNum r;
-    if (!BN_mod(r.to_bignum(), a.to_bignum(), b.to_bignum(), pctx))
-        throw bignum_error("CBigNum::operator% : BN_div failed");
-    return r;
-}
-
-inline const CBigNum operator<<(const CBigNum& a, unsigned int shift)
-{
-    CBigNum r;
-    if (!BN_lshift(r.to_bignum(), a.to_bignum(), shift))
-        throw bignum_error("CBigNum:operator<< : BN_lshift failed");
-    return r;
-}
-
-inline const CBigNum operator>>(const CBigNum& a, unsigned int shift)
-{
-    CBigNum r = a;
-    r >>= shift;
-    return r;
-}
-
-inline bool operator==(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) == 0); }
-inline bool operator!=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) != 0); }
-inline bool operator<=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) <= 0); }
-inline bool operator>=(const CBigNum& a, const CBigNum& b) { return (BN_cmp(a.to_bignum(), b.to_bignum()) >= 0); }
-inline bool operator<(const CBigNum& a, const CBigNum& b)  { return (BN_cmp(a.to_bignum(), b.to_bignum()) < 0); }
-inline bool operator>(const CBigNum& a, const CBigNum& b)  { return (BN_cmp(a.to_bignum(), b.to_bignum()) > 0); }
-
-
-static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-
-// Encode a byte sequence as a base58-encoded string
-inline std::string EncodeBase58(const unsigned char* pbegin, const unsigned char* pend, const fc::yield_function_t& yield)
-{
-    CAutoBN_CTX pctx;
-    CBigNum bn58 = 58;
-    CBigNum bn0 = 0;
-
-    // Convert big endian data to little endian
-    // Extra zero at the end make sure bignum will interpret as a positive number
-    std::vector<unsigned char> vchTmp(pend-pbegin+1, 0);
-    yield();
-    reverse_copy(pbegin, pend, vchTmp.begin());
-    yield();
-
-    // Convert little endian data to bignum
-    CBigNum bn;
-    bn.setvch(vchTmp);
-
-    // Convert bignum to std::string
-    std::string str;
-    // Expected size increase from base58 conversion is approximately 137%
-    // use 138% to be safe
-    str.reserve((pend - pbegin) * 138 / 100 + 1);
-    CBigNum dv;
-    CBigNum rem;
-    while (bn > bn0)
-    {
-        yield();
-        if (!BN_div(dv.to_bignum(), rem.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("EncodeBase58 : BN_div failed");
-        bn = dv;
-        unsigned int c = rem.getulong();
-        str += pszBase58[c];
-    }
-
-    // Leading zeroes encoded as base58 zeros
-    for (const unsigned char* p = pbegin; p < pend && *p == 0; p++)
-        str += pszBase58[0];
-
-    yield();
-    // Convert little endian std::string to big endian
-    reverse(str.begin(), str.end());
-//    slog( "Encode '%s'", str.c_str() );
-    yield();
-
-    return str;
-}
-
-// Encode a byte vector as a base58-encoded string
-inline std::string EncodeBase58(const std::vector<unsigned char>& vch, const fc::yield_function_t& yield)
-{
-    return EncodeBase58(&vch[0], &vch[0] + vch.size(), yield);
-}
-
-// Decode a base58-encoded string psz into byte vector vchRet
-// returns true if decoding is succesful
-inline bool DecodeBase58(const char* psz, std::vector<unsigned char>& vchRet)
-{
-    CAutoBN_CTX pctx;
-    vchRet.clear();
-    CBigNum bn58 = 58;
-    CBigNum bn = 0;
-    CBigNum bnChar;
-    while (isspace(*psz))
-        psz++;
-
-    // Convert big endian string to bignum
-    for (const char* p = psz; *p; p++)
-    {
-        const char* p1 = strchr(pszBase58, *p);
-        if (p1 == NULL)
-        {
-            while (isspace(*p))
-                p++;
-            if (*p != '\0') {
-                //slog( "%s  '%c'", pszBase58,*p );
-                return false;
+         r.begin = psz;
+         const char* p = psz;
+         while( *p && base58_digits.digit[(unsigned char) *p] >= 0 )
+            ++p;
+         r.end = p;
+         // only trailing whitespace may follow the digits
+         while( isspace( (unsigned char) *p ) )
+            p++;
+         if( *p != '\0' )
+            return false;
+         while( r.begin + r.zeros < r.end && r.begin[r.zeros] == base58_chars[0] )
+            ++r.zeros;
+         return true;
+      }
+
+      /// the number in @p r as little endian 32 bit limbs, returns the limbs used
+      static size_t decode_base58_limbs( const base58_digits_range& r, uint32_t* limbs ) {
+         size_t used = 0;
+         // limbs = limbs * 58^n + value
+         auto push = [&]( uint32_t mul, uint32_t value ) {
+            uint64_t carry = value;
+            for( size_t j = 0; j < used; ++j ) {
+               const uint64_t t = uint64_t( limbs[j] ) * mul + carry;
+               limbs[j] = uint32_t( t );
+               carry = t >> 32;
             }
-            break;
-        }
-        bnChar.setulong(p1 - pszBase58);
-        if (!BN_mul(bn.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
-            throw bignum_error("DecodeBase58 : BN_mul failed");
-        bn += bnChar;
-    }
-
-    // Get bignum as little endian data
-    std::vector<unsigned char> vchTmp = bn.getvch();
-
-    // Trim off sign byte if present
-    if (vchTmp.size() >= 2 && vchTmp.end()[-1] == 0 && vchTmp.end()[-2] >= 0x80)
-        vchTmp.erase(vchTmp.end()-1);
-
-    // Restore leading zeros
-    int nLeadingZeros = 0;
-    for (const char* p = psz; *p == pszBase58[0]; p++)
-        nLeadingZeros++;
-    vchRet.assign(nLeadingZeros + vchTmp.size(), 0);
-
-    // Convert little endian data to big endian
-    reverse_copy(vchTmp.begin(), vchTmp.end(), vchRet.end() - vchTmp.size());
-    return true;
-}
-
-// Decode a base58-encoded string str into byte vector vchRet
-// returns true if decoding is succesful
-inline bool DecodeBase58(const std::string& str, std::vector<unsigned char>& vchRet)
-{
-    return DecodeBase58(str.c_str(), vchRet);
-}
-
-
-namespace fc {
+            if( carry )
+               limbs[used++] = uint32_t( carry );
+         };
+
+         const char* p = r.begin + r.zeros;
+         size_t head = ( r.end - p ) % 5;
+         for( size_t n = head ? head : 5; p < r.end; p += n, n = 5 ) {
+            uint32_t value = 0;
+            for( size_t k = 0; k < n; ++k )
+               value = value * 58 + base58_digits.digit[(unsigned char) p[k]];
+            push( base58_pow[n], value );
+         }
+         return used;
+      }
+
+      /// bytes of the number in @p limbs, without leading zero bytes
+      static size_t base58_number_bytes( const uint32_t* limbs, size_t used ) {
+         if( used == 0 )
+            return 0;
+         size_t top_bytes = 0;
+         for( uint32_t top = limbs[used - 1]; top; top >>= 8 )
+            ++top_bytes;
+         return top_bytes + 4 * ( used - 1 );
+      }
+
+      /// writes the zeros and the number big endian to @p out of @p size bytes
+      static void store_base58_bytes( const base58_digits_range& r, const uint32_t* limbs, char* out, size_t size ) {
+         memset( out, 0, r.zeros );
+         char* o = out + size;
+         const size_t bytes = size - r.zeros;
+         for( size_t k = 0; k < bytes; ++k )
+            *--o = char( limbs[k / 4] >> ( 8 * ( k % 4 ) ) );
+      }
+
+      /// decodes into the limbs of a stack buffer for the common sizes, otherwise of a vector
+      template<typename F>
+      static auto with_decoded_limbs( const base58_digits_range& r, F&& f ) {
+         const size_t digits = r.end - r.begin;
+         if( digits <= 160 ) {
+            uint32_t limbs[base58_decode_limbs( 160 )];
+            return f( limbs, decode_base58_limbs( r, limbs ) );
+         }
+         std::vector<uint32_t> limbs( base58_decode_limbs( digits ) );
+         return f( limbs.data(), decode_base58_limbs( r, limbs.data() ) );
+      }
+
+      template<size_t Size>
+      static std::string encode_base58_fixed( const unsigned char* d, const fc::yield_function_t& yield ) {
+         uint32_t limbs[base58_encode_limbs( Size )];
+         return encode_base58( d, std::integral_constant<size_t, Size>(), limbs, yield );
+      }
+
+   } // namespace detail
 
 std::string to_base58( const char* d, size_t s, const fc::yield_function_t& yield ) {
-  return EncodeBase58( (const unsigned char*)d, (const unsigned char*)d+s, yield );
+  const unsigned char* data = (const unsigned char*) d;
+  yield();
+  switch( s ) {
+     case 33: return detail::encode_base58_fixed<33>( data, yield );
+     case 37: return detail::encode_base58_fixed<37>( data, yield );
+     case 65: return detail::encode_base58_fixed<65>( data, yield );
+     case 69: return detail::encode_base58_fixed<69>( data, yield );
+  }
+  std::vector<uint32_t> limbs( detail::base58_encode_limbs( s ) );
+  return detail::encode_base58( data, s, limbs.data(), yield );
 }
 
 std::string to_base58( const std::vector<char>& d, const fc::yield_function_t& yield )
@@ -626,25 +212,29 @@ std::string to_base58( const std::vector<char>& d, const fc::yield_function_t& y
   return std::string();
 }
 std::vector<char> from_base58( const std::string& base58_str ) {
-   std::vector<unsigned char> out;
-   if( !DecodeBase58( base58_str.c_str(), out ) ) {
+   detail::base58_digits_range r;
+   if( !detail::parse_base58( base58_str.c_str(), r ) ) {
      FC_THROW_EXCEPTION( parse_error_exception, "Unable to decode base58 string ${base58_str}", ("base58_str",base58_str) );
    }
-   return std::vector<char>((const char*)out.data(), ((const char*)out.data())+out.size() );
+   return detail::with_decoded_limbs( r, [&]( const uint32_t* limbs, size_t used ) {
+      std::vector<char> out( r.zeros + detail::base58_number_bytes( limbs, used ) );
+      detail::store_base58_bytes( r, limbs, out.data(), out.size() );
+      return out;
+   } );
 }
 /**
  *  @return the number of bytes decoded
  */
 size_t from_base58( const std::string& base58_str, char* out_data, size_t out_data_len ) {
-  //slog( "%s", base58_str.c_str() );
-  std::vector<unsigned char> out;
-  if( !DecodeBase58( base58_str.c_str(), out ) ) {
+  detail::base58_digits_range r;
+  if( !detail::parse_base58( base58_str.c_str(), r ) ) {
     FC_THROW_EXCEPTION( parse_error_exception, "Unable to decode base58 string ${base58_str}", ("base58_str",base58_str) );
   }
-  FC_ASSERT( out.size() <= out_data_len );
-  memcpy( out_data, out.data(), out.size() );
-  return out.size();
+  return detail::with_decoded_limbs( r, [&]( const uint32_t* limbs, size_t used ) {
+     const size_t size = r.zeros + detail::base58_number_bytes( limbs, used );
+     FC_ASSERT( size <= out_data_len );
+     detail::store_base58_bytes( r, limbs, out_data, size );
+     return size;
+  } );
 }
 }
-
-#endif
@@ -1,6 +1,13 @@
 #include <fc/crypto/base64.hpp>
 #include <fc/exception/exception.hpp>
-#include <ctype.h>
+
+#include <atomic>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_BASE64_X86 1
+#include <immintrin.h>
+#endif
 /* 
    base64.cpp and base64.h
 
@@ -28,6 +35,14 @@
 
 */
 
+/* Altered for fc: the encoder and decoder are table driven, work on caller buffers and have AVX2 kernels.
+ * The AVX2 encoder spreads each 3 bytes over a 32 bit lane with pshufb and cuts out the four 6 bit indices
+ * with multiplies; a pshufb on how far an index is into its range of the alphabet gives what to add to it.
+ * The AVX2 decoder classifies characters by range, keeps a mask of the ones outside the alphabet and joins
+ * the 6 bit values with pmaddubsw and pmaddwd.
+ */
+
+
 namespace fc {
 
 static constexpr char base64_chars[] =
@@ -41,56 +56,232 @@ static constexpr char base64url_chars[] =
 
 static_assert(sizeof(base64_chars) == sizeof(base64url_chars), "base64 and base64url must have the same amount of chars");
 
-static inline void throw_on_nonbase64(unsigned char c, const char* const b64_chars) {
-  FC_ASSERT(isalnum(c) || (c == b64_chars[sizeof(base64_chars)-3]) || (c == b64_chars[sizeof(base64_chars)-2]), "encountered non-base64 character");
+namespace detail {
+
+   struct base64_tables {
+      uint8_t values[2][256];  ///< the value of every character of each alphabet, 0xff for other characters
+
+      constexpr base64_tables() : values{} {
+         for( int a = 0; a < 2; ++a ) {
+            for( int i = 0; i < 256; ++i )
+               values[a][i] = 0xff;
+            for( int i = 0; i < 64; ++i )
+               values[a][uint8_t( ( a ? base64url_chars : base64_chars )[i] )] = i;
+         }
+      }
+   };
+
+   static constexpr base64_tables base64_table;
+
+   static void encode_scalar( const uint8_t* in, size_t len, char* out, const char* chars ) {
+      size_t i = 0;
+      for( ; i + 3 <= len; i += 3, out += 4 ) {
+         const uint32_t v = uint32_t( in[i] ) << 16 | uint32_t( in[i + 1] ) << 8 | in[i + 2];
+         out[0] = chars[v >> 18];
+         out[1] = chars[v >> 12 & 63];
+         out[2] = chars[v >> 6 & 63];
+         out[3] = chars[v & 63];
+      }
+      if( i < len ) {
+         const bool two = i + 1 < len;
+         const uint32_t v = uint32_t( in[i] ) << 16 | ( two ? uint32_t( in[i + 1] ) << 8 : 0 );
+         out[0] = chars[v >> 18];
+         out[1] = chars[v >> 12 & 63];
+         out[2] = two ? chars[v >> 6 & 63] : '=';
+         out[3] = '=';
+      }
+   }
+
+   /// decodes groups of four characters, false if any is not in the alphabet of @p values
+   static bool decode_scalar( const uint8_t* in, size_t groups, uint8_t* out, const uint8_t* values ) {
+      uint8_t bad = 0;
+      for( size_t g = 0; g < groups; ++g, in += 4, out += 3 ) {
+         const uint8_t a = values[in[0]], b = values[in[1]], c = values[in[2]], d = values[in[3]];
+         bad |= a | b | c | d;
+         const uint32_t v = uint32_t( a ) << 18 | uint32_t( b ) << 12 | uint32_t( c ) << 6 | d;
+         out[0] = uint8_t( v >> 16 );
+         out[1] = uint8_t( v >> 8 );
+         out[2] = uint8_t( v );
+      }
+      return !( bad & 0xc0 );
+   }
+
+#ifdef FC_BASE64_X86
+
+   __attribute__((target("avx2")))
+   static void encode_avx2( const uint8_t* in, size_t len, char* out, const char* chars ) {
+      const __m256i spread = _mm256_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                               1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+      // added to an index by range: 26-51, ten times 52-61, 62, 63, then 0-25
+      const char c62 = chars[62] - 62, c63 = chars[63] - 63;
+      const __m256i shift = _mm256_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0,
+                                              'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0 );
+      size_t i = 0;
+      // each round reads 28 bytes and encodes 24 of them
+      for( ; i + 28 <= len; i += 24, out += 32 ) {
+         const __m128i lo = _mm_loadu_si128( (const __m128i*)( in + i ) );
+         const __m128i hi = _mm_loadu_si128( (const __m128i*)( in + i + 12 ) );
+         const __m256i v = _mm256_shuffle_epi8( _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 ), spread );
+         // bytes b1 b0 b2 b1 of each lane, the four indices cut out to one per byte
+         const __m256i ac = _mm256_mulhi_epu16( _mm256_and_si256( v, _mm256_set1_epi32( 0x0fc0fc00 ) ), _mm256_set1_epi32( 0x04000040 ) );
+         const __m256i bd = _mm256_mullo_epi16( _mm256_and_si256( v, _mm256_set1_epi32( 0x003f03f0 ) ), _mm256_set1_epi32( 0x01000010 ) );
+         const __m256i idx = _mm256_or_si256( ac, bd );
+         __m256i range = _mm256_subs_epu8( idx, _mm256_set1_epi8( 51 ) );
+         range = _mm256_or_si256( range, _mm256_and_si256( _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), idx ), _mm256_set1_epi8( 13 ) ) );
+         _mm256_storeu_si256( (__m256i*)out, _mm256_add_epi8( idx, _mm256_shuffle_epi8( shift, range ) ) );
+      }
+      encode_scalar( in + i, len - i, out, chars );
+   }
+
+   /// the 6 bit value of each character in @p c, with the lanes outside the alphabet set in @p bad
+   __attribute__((target("avx2")))
+   static inline __m256i values_avx2( __m256i c, __m256i c62, __m256i c63, __m256i& bad ) {
+      const __m256i u = _mm256_sub_epi8( c, _mm256_set1_epi8( 'A' ) );
+      const __m256i l = _mm256_sub_epi8( c, _mm256_set1_epi8( 'a' ) );
+      const __m256i d = _mm256_sub_epi8( c, _mm256_set1_epi8( '0' ) );
+      const __m256i is_u = _mm256_cmpeq_epi8( _mm256_min_epu8( u, _mm256_set1_epi8( 25 ) ), u );
+      const __m256i is_l = _mm256_cmpeq_epi8( _mm256_min_epu8( l, _mm256_set1_epi8( 25 ) ), l );
+      const __m256i is_d = _mm256_cmpeq_epi8( _mm256_min_epu8( d, _mm256_set1_epi8( 9 ) ), d );
+      const __m256i is_62 = _mm256_cmpeq_epi8( c, c62 );
+      const __m256i is_63 = _mm256_cmpeq_epi8( c, c63 );
+      const __m256i valid = _mm256_or_si256( _mm256_or_si256( is_u, is_l ), _mm256_or_si256( is_d, _mm256_or_si256( is_62, is_63 ) ) );
+      bad = _mm256_or_si256( bad, _mm256_cmpeq_epi8( valid, _mm256_setzero_si256() ) );
+      __m256i v = _mm256_and_si256( is_u, u );
+      v = _mm256_or_si256( v, _mm256_and_si256( is_l, _mm256_add_epi8( l, _mm256_set1_epi8( 26 ) ) ) );
+      v = _mm256_or_si256( v, _mm256_and_si256( is_d, _mm256_add_epi8( d, _mm256_set1_epi8( 52 ) ) ) );
+      v = _mm256_or_si256( v, _mm256_and_si256( is_62, _mm256_set1_epi8( 62 ) ) );
+      return _mm256_or_si256( v, _mm256_and_si256( is_63, _mm256_set1_epi8( 63 ) ) );
+   }
+
+   __attribute__((target("avx2")))
+   static bool decode_avx2( const uint8_t* in, size_t groups, uint8_t* out, const char* chars, const uint8_t* values ) {
+      const __m256i c62 = _mm256_set1_epi8( chars[62] ), c63 = _mm256_set1_epi8( chars[63] );
+      // the 24 bits of a group end up in bytes 2 1 0 of its lane, 12 bytes to a 128 bit half
+      const __m256i order = _mm256_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+      __m256i bad = _mm256_setzero_si256();
+      size_t g = 0;
+      for( ; g + 8 <= groups; g += 8, in += 32, out += 24 ) {
+         const __m256i v = values_avx2( _mm256_loadu_si256( (const __m256i*)in ), c62, c63, bad );
+         const __m256i ab_cd = _mm256_maddubs_epi16( v, _mm256_set1_epi32( 0x01400140 ) );
+         const __m256i abcd = _mm256_madd_epi16( ab_cd, _mm256_set1_epi32( 0x00011000 ) );
+         const __m256i packed = _mm256_permutevar8x32_epi32( _mm256_shuffle_epi8( abcd, order ),
+                                                             _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 ) );
+         _mm_storeu_si128( (__m128i*)out, _mm256_castsi256_si128( packed ) );
+         _mm_storel_epi64( (__m128i*)( out + 16 ), _mm256_extracti128_si256( packed, 1 ) );
+      }
+      const bool tail_ok = decode_scalar( in, groups - g, out, values );
+      return tail_ok && _mm256_movemask_epi8( bad ) == 0;
+   }
+
+#endif // FC_BASE64_X86
+
+   static bool base64_backend_supported( base64_backend b ) {
+      switch( b ) {
+         case base64_backend::scalar:
+            return true;
+#ifdef FC_BASE64_X86
+         case base64_backend::avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports( "avx2" );
+#endif
+         default:
+            return false;
+      }
+   }
+
+   static std::atomic<base64_backend>& base64_backend_state() {
+      static std::atomic<base64_backend> b{ base64_backend_supported( base64_backend::avx2 ) ? base64_backend::avx2
+                                                                                           : base64_backend::scalar };
+      return b;
+   }
+
+} // namespace detail
+
+void base64_encode_to( const char* in, size_t len, char* out, base64_alphabet alphabet ) {
+   const char* chars = alphabet == base64_alphabet::url ? base64url_chars : base64_chars;
+#ifdef FC_BASE64_X86
+   if( detail::base64_backend_state().load( std::memory_order_relaxed ) == base64_backend::avx2 ) {
+      detail::encode_avx2( (const uint8_t*)in, len, out, chars );
+      return;
+   }
+#endif
+   detail::encode_scalar( (const uint8_t*)in, len, out, chars );
 }
 
-std::string base64_encode_impl(unsigned char const* bytes_to_encode, unsigned int in_len, const char* const b64_chars) {
-
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
-
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-
-      for(i = 0; (i <4) ; i++)
-        ret += b64_chars[char_array_4[i]];
-      i = 0;
-    }
-  }
-
-  if (i)
-  {
-    for(j = i; j < 3; j++)
-      char_array_3[j] = '\0';
-
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-    char_array_4[3] = char_array_3[2] & 0x3f;
-
-    for (j = 0; (j < i + 1); j++)
-      ret += b64_chars[char_array_4[j]];
-
-    while((i++ < 3))
-      ret += '=';
+bool base64_decode_to( const char* in, size_t len, char* out, size_t out_size, size_t& out_len,
+                       base64_alphabet alphabet, base64_mode mode ) {
+   out_len = 0;
+   size_t n = len;
+   if( mode == base64_mode::lenient ) {
+      if( const void* pad = len ? memchr( in, '=', len ) : nullptr )
+         n = (const char*)pad - in;
+   } else {
+      size_t pad = 0;
+      for( ; pad < 2 && n && in[n - 1] == '='; ++pad )
+         --n;
+      if( ( pad && len % 4 ) || n % 4 == 1 )
+         return false;
+   }
+
+   const size_t groups = n / 4, rest = n % 4;
+   const size_t size = groups * 3 + ( rest > 1 ? rest - 1 : 0 );
+   if( size > out_size )
+      return false;
+
+   const uint8_t* values = detail::base64_table.values[alphabet == base64_alphabet::url];
+   const uint8_t* p = (const uint8_t*)in;
+   uint8_t* o = (uint8_t*)out;
+   bool ok;
+#ifdef FC_BASE64_X86
+   if( detail::base64_backend_state().load( std::memory_order_relaxed ) == base64_backend::avx2 )
+      ok = detail::decode_avx2( p, groups, o, alphabet == base64_alphabet::url ? base64url_chars : base64_chars, values );
+   else
+#endif
+      ok = detail::decode_scalar( p, groups, o, values );
+
+   if( rest ) {
+      p += 4 * groups;
+      o += 3 * groups;
+      const uint8_t a = values[p[0]];
+      const uint8_t b = rest > 1 ? values[p[1]] : 0;
+      const uint8_t c = rest > 2 ? values[p[2]] : 0;
+      ok = ok && !( ( a | b | c ) & 0xc0 );
+      if( rest > 1 )
+         o[0] = uint8_t( a << 2 | b >> 4 );
+      if( rest > 2 )
+         o[1] = uint8_t( b << 4 | c >> 2 );
+      // the canonical encoding leaves the bits past the last byte zero
+      if( mode == base64_mode::strict && ( rest == 2 ? b & 0x0f : c & 0x03 ) )
+         ok = false;
+   }
+   if( !ok )
+      return false;
+   out_len = size;
+   return true;
+}
 
-  }
+base64_backend get_base64_backend() {
+   return detail::base64_backend_state().load( std::memory_order_relaxed );
+}
 
-  return ret;
+bool set_base64_backend( base64_backend b ) {
+   if( !detail::base64_backend_supported( b ) )
+      return false;
+   detail::base64_backend_state() = b;
+   return true;
+}
 
+static std::string base64_encode_impl(unsigned char const* bytes_to_encode, unsigned int in_len, base64_alphabet alphabet) {
+   std::string ret( base64_encoded_size( in_len ), '\0' );
+   base64_encode_to( (const char*)bytes_to_encode, in_len, &ret[0], alphabet );
+   return ret;
 }
 
 std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-   return base64_encode_impl(bytes_to_encode, in_len, base64_chars);
+   return base64_encode_impl(bytes_to_encode, in_len, base64_alphabet::standard);
 }
 
 std::string base64_encode( const std::string& enc ) {
@@ -99,7 +290,7 @@ std::string base64_encode( const std::string& enc ) {
 }
 
 std::string base64url_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-   return base64_encode_impl(bytes_to_encode, in_len, base64url_chars);
+   return base64_encode_impl(bytes_to_encode, in_len, base64_alphabet::url);
 }
 
 std::string base64url_encode( const std::string& enc ) {
@@ -107,55 +298,21 @@ std::string base64url_encode( const std::string& enc ) {
   return base64url_encode( (unsigned char const*)s, enc.size() );
 }
 
-std::string base64_decode_impl(std::string const& encoded_string, const char* const b64_chars) {
-  int in_len = encoded_string.size();
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
-
-  while (in_len-- && encoded_string[in_] != '=') {
-    throw_on_nonbase64(encoded_string[in_], b64_chars);
-    char_array_4[i++] = encoded_string[in_]; in_++;
-    if (i ==4) {
-      for (i = 0; i <4; i++)
-        char_array_4[i] = strchr(b64_chars, char_array_4[i]) - b64_chars;
-
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-      for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
-      i = 0;
-    }
-  }
-
-  if (i) {
-    for (j = i; j <4; j++)
-      char_array_4[j] = 0;
-
-    for (j = 0; j <4; j++)
-      char_array_4[j] = strchr(b64_chars, char_array_4[j]) - b64_chars;
-
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
-  }
-
-  return ret;
+static std::string base64_decode_impl(std::string const& encoded_string, base64_alphabet alphabet) {
+   std::string ret( base64_decoded_max_size( encoded_string.size() ), '\0' );
+   size_t len = 0;
+   FC_ASSERT( base64_decode_to( encoded_string.data(), encoded_string.size(), &ret[0], ret.size(), len, alphabet, base64_mode::lenient ),
+              "encountered non-base64 character" );
+   ret.resize( len );
+   return ret;
 }
 
 std::string base64_decode(std::string const& encoded_string) {
-   return base64_decode_impl(encoded_string, base64_chars);
+   return base64_decode_impl(encoded_string, base64_alphabet::standard);
 }
 
 std::string base64url_decode(std::string const& encoded_string) {
-   return base64_decode_impl(encoded_string, base64url_chars);
+   return base64_decode_impl(encoded_string, base64_alphabet::url);
 }
 
 } // namespace fc
-
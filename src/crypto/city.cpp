@@ -33,13 +33,13 @@
 #include <algorithm>
 #include <string.h>  // for memcpy and memset
 #include <fc/crypto/city.hpp>
+#include <fc/crypto/crc32c.hpp>
 #include <fc/uint128.hpp>
 #include <fc/array.hpp>
 
-#if defined(__SSE4_2__) && defined(__x86_64__)
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_CITY_CRC_X86 1
 #include <nmmintrin.h>
-#else
-uint64_t _mm_crc32_u64(uint64_t a, uint64_t b );
 #endif
 
 namespace fc {
@@ -544,9 +544,23 @@ uint128 city_hash128(const char *s, size_t len) {
 //#include <citycrc.h>
 //#include <nmmintrin.h>
 
+// The crc32 instruction when the CPU has it, otherwise the table; see crc32c().
+struct CrcTable {
+  uint64_t operator()(uint64_t a, uint64_t b) const { return detail::crc32c_u64_table(uint32_t(a), b); }
+};
+
+#ifdef FC_CITY_CRC_X86
+struct CrcSse42 {
+  __attribute__((target("sse4.2")))
+  uint64_t operator()(uint64_t a, uint64_t b) const { return _mm_crc32_u64(a, b); }
+};
+#endif
+
 // Requires len >= 240.
-static void CityHashCrc256Long(const char *s, size_t len,
-                               uint32_t seed, uint64_t *result) {
+template<typename Crc>
+static inline __attribute__((always_inline))
+void CityHashCrc256Long(const char *s, size_t len,
+                        uint32_t seed, uint64_t *result, Crc crc) {
   uint64_t a = Fetch64(s + 56) + k0;
   uint64_t b = Fetch64(s + 96) + k0;
   uint64_t c = result[0] = HashLen16(b, len);
@@ -578,9 +592,9 @@ static void CityHashCrc256Long(const char *s, size_t len,
     g += e;                                     \
     e += z;                                     \
     g += x;                                     \
-    z = _mm_crc32_u64(z, b + g);                \
-    y = _mm_crc32_u64(y, e + h);                \
-    x = _mm_crc32_u64(x, f + a);                \
+    z = crc(z, b + g);                          \
+    y = crc(y, e + h);                          \
+    x = crc(x, f + a);                          \
     e = Rotate(e, r);                           \
     c += e;                                     \
     s += 40
@@ -632,17 +646,41 @@ static void CityHashCrc256Long(const char *s, size_t len,
   result[3] = a + result[2];
 }
 
+static void CityHashCrc256LongTable(const char *s, size_t len,
+                                    uint32_t seed, uint64_t *result) {
+  CityHashCrc256Long(s, len, seed, result, CrcTable());
+}
+
+#ifdef FC_CITY_CRC_X86
+__attribute__((target("sse4.2")))
+static void CityHashCrc256LongSse42(const char *s, size_t len,
+                                    uint32_t seed, uint64_t *result) {
+  CityHashCrc256Long(s, len, seed, result, CrcSse42());
+}
+#endif
+
+static void CityHashCrc256Dispatch(const char *s, size_t len,
+                                   uint32_t seed, uint64_t *result) {
+#ifdef FC_CITY_CRC_X86
+  if (get_crc32c_backend() != crc32c_backend::table) {
+    CityHashCrc256LongSse42(s, len, seed, result);
+    return;
+  }
+#endif
+  CityHashCrc256LongTable(s, len, seed, result);
+}
+
 // Requires len < 240.
 static void CityHashCrc256Short(const char *s, size_t len, uint64_t *result) {
   char buf[240];
   memcpy(buf, s, len);
   memset(buf + len, 0, 240 - len);
-  CityHashCrc256Long(buf, 240, ~static_cast<uint32_t>(len), result);
+  CityHashCrc256Dispatch(buf, 240, ~static_cast<uint32_t>(len), result);
 }
 
 void CityHashCrc256(const char *s, size_t len, uint64_t *result) {
   if (LIKELY(len >= 240)) {
-    CityHashCrc256Long(s, len, 0, result);
+    CityHashCrc256Dispatch(s, len, 0, result);
   } else {
     CityHashCrc256Short(s, len, result);
   }
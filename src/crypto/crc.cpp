@@ -1,6 +1,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 //#include <zlib.h>
+#include <fc/crypto/crc32c.hpp>
+#include <atomic>
+#include <string.h>
 /* Tables generated with code like the following:
 
 #define CRCPOLY 0x82f63b78 // reversed 0x1EDC6F41
@@ -601,27 +604,199 @@ static const uint32_t crc_c[256] = {
          0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E,
          0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351,
  };
-#if !defined __SSE4_2__ || (defined __SSE4_2__ && !defined __x86_64__)
-
-
-uint64_t _mm_crc32_u64(uint64_t a, uint64_t b )
-{
-    return crc32cSlicingBy8(a, (unsigned char*)&b, sizeof(b)); 
-}
-/*
-//#include "citycrc.h"
-#include <nmmintrin.h>
-#include <iostream>
-
-int main( int argc, char** argv )
-{
-    uint64_t f = 0x1234;
-    uint64_t a = 0x5678;
-    uint32_t f1 = _mm_crc32_u64(f, a); 
-    uint32_t f4  = crc32cSlicingBy8(f, (unsigned char*)&a, sizeof(a)); 
-    std::cout<<std::hex<<f1<<"\n"<<f2<<"\n"<<f3<<"\n"<<f4<<"\n";
-    return 0;
-}
-*/
 
+namespace fc {
+
+   namespace detail {
+
+      constexpr uint32_t crc32c_poly = 0x82f63b78; // reflected 0x1EDC6F41
+
+      uint32_t crc32c_u64_table( uint32_t crc, uint64_t v ) {
+         return crc32cSlicingBy8( crc, &v, sizeof(v) );
+      }
+
+      /// a * b modulo the polynomial, bit 31 is x^0
+      static uint32_t crc32c_multmodp( uint32_t a, uint32_t b ) {
+         uint32_t p = 0;
+         for( uint32_t m = 1u << 31; m; m >>= 1 ) {
+            if( a & m )
+               p ^= b;
+            b = b & 1 ? ( b >> 1 ) ^ crc32c_poly : b >> 1;
+         }
+         return p;
+      }
+
+      /// x^n modulo the polynomial
+      static uint32_t crc32c_xpow( uint64_t n ) {
+         uint32_t r = 1u << 31, sq = 1u << 30;
+         for( ; n; n >>= 1 ) {
+            if( n & 1 )
+               r = crc32c_multmodp( r, sq );
+            sq = crc32c_multmodp( sq, sq );
+         }
+         return r;
+      }
+
+      /* The hardware tiers run the crc32 instruction, which has a latency of three cycles and a throughput of one,
+       * on three adjacent streams of one block at a time and merge them as crc = shift( shift( c0 ) ^ c1 ) ^ c2,
+       * where shift multiplies by x^(8 * stream bytes). Blocks of long streams go first, then of short ones.
+       */
+      constexpr size_t crc32c_long = 4096;
+      constexpr size_t crc32c_short = 256;
+
+      /// shift by four table lookups, one per byte of the crc
+      struct crc32c_shift_table {
+         uint32_t t[4][256];
+
+         explicit crc32c_shift_table( size_t bytes ) {
+            const uint32_t xn = crc32c_xpow( 8 * uint64_t( bytes ) );
+            for( int k = 0; k < 4; ++k )
+               for( uint32_t b = 0; b < 256; ++b )
+                  t[k][b] = crc32c_multmodp( b << ( 8 * k ), xn );
+         }
+
+         uint32_t operator()( uint32_t c )const {
+            return t[0][c & 0xff] ^ t[1][( c >> 8 ) & 0xff] ^ t[2][( c >> 16 ) & 0xff] ^ t[3][c >> 24];
+         }
+      };
+
+   } // namespace detail
+
+} // namespace fc
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_CRC32C_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+
+namespace fc { namespace detail {
+
+   /// shift by a carry-less multiply with x^(8 * bytes - 33), the crc32 of the 64 bit product reduces it
+   struct crc32c_shift_clmul {
+      uint32_t k;
+
+      explicit crc32c_shift_clmul( size_t bytes ) : k( crc32c_xpow( 8 * uint64_t( bytes ) - 33 ) ) {}
+
+      __attribute__((target("sse4.2,pclmul")))
+      uint32_t operator()( uint32_t c )const {
+         const __m128i p = _mm_clmulepi64_si128( _mm_cvtsi32_si128( int( c ) ), _mm_cvtsi32_si128( int( k ) ), 0 );
+         return uint32_t( _mm_crc32_u64( 0, uint64_t( _mm_cvtsi128_si64( p ) ) ) );
+      }
+   };
+
+   /// blocks of three streams of @p stream bytes each
+   template<typename Shift>
+   __attribute__((target("sse4.2")))
+   static void crc32c_sse42_blocks( uint64_t& c0, const char*& p, size_t& len, size_t stream, const Shift& shift ) {
+      for( ; len >= 3 * stream; len -= 3 * stream, p += 2 * stream ) {
+         uint64_t c1 = 0, c2 = 0;
+         for( const char* end = p + stream; p < end; p += 8 ) {
+            uint64_t w0, w1, w2;
+            memcpy( &w0, p, 8 );
+            memcpy( &w1, p + stream, 8 );
+            memcpy( &w2, p + 2 * stream, 8 );
+            c0 = _mm_crc32_u64( c0, w0 );
+            c1 = _mm_crc32_u64( c1, w1 );
+            c2 = _mm_crc32_u64( c2, w2 );
+         }
+         c0 = shift( shift( uint32_t( c0 ) ) ^ uint32_t( c1 ) ) ^ uint32_t( c2 );
+      }
+   }
+
+   template<typename Shift>
+   __attribute__((target("sse4.2")))
+   static uint32_t crc32c_sse42( uint32_t crc, const char* p, size_t len, const Shift& long_shift, const Shift& short_shift ) {
+      uint64_t c0 = crc;
+      for( ; len && ( uintptr_t( p ) & 7 ); --len )
+         c0 = _mm_crc32_u8( uint32_t( c0 ), uint8_t( *p++ ) );
+      crc32c_sse42_blocks( c0, p, len, crc32c_long, long_shift );
+      crc32c_sse42_blocks( c0, p, len, crc32c_short, short_shift );
+      for( ; len >= 8; len -= 8, p += 8 ) {
+         uint64_t w;
+         memcpy( &w, p, 8 );
+         c0 = _mm_crc32_u64( c0, w );
+      }
+      for( ; len; --len )
+         c0 = _mm_crc32_u8( uint32_t( c0 ), uint8_t( *p++ ) );
+      return uint32_t( c0 );
+   }
+
+   static bool cpu_has_sse42() {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports( "sse4.2" );
+   }
+
+   static bool cpu_has_pclmul() {
+      unsigned int eax, ebx, ecx, edx;
+      return cpu_has_sse42() && __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) && ( ecx & bit_PCLMUL );
+   }
+
+} } // fc::detail
+
+#endif // FC_CRC32C_X86
+
+namespace fc {
+
+   namespace detail {
+
+      static bool crc32c_backend_supported( crc32c_backend b ) {
+         switch( b ) {
+            case crc32c_backend::table:
+               return true;
+#ifdef FC_CRC32C_X86
+            case crc32c_backend::sse42:
+               return cpu_has_sse42();
+            case crc32c_backend::pclmul:
+               return cpu_has_pclmul();
 #endif
+            default:
+               return false;
+         }
+      }
+
+      static crc32c_backend detect_crc32c_backend() {
+         if( crc32c_backend_supported( crc32c_backend::pclmul ) )
+            return crc32c_backend::pclmul;
+         if( crc32c_backend_supported( crc32c_backend::sse42 ) )
+            return crc32c_backend::sse42;
+         return crc32c_backend::table;
+      }
+
+      static std::atomic<crc32c_backend>& crc32c_backend_state() {
+         static std::atomic<crc32c_backend> b{ detect_crc32c_backend() };
+         return b;
+      }
+
+   } // namespace detail
+
+   crc32c_backend get_crc32c_backend() {
+      return detail::crc32c_backend_state().load( std::memory_order_relaxed );
+   }
+
+   bool set_crc32c_backend( crc32c_backend b ) {
+      if( !detail::crc32c_backend_supported( b ) )
+         return false;
+      detail::crc32c_backend_state() = b;
+      return true;
+   }
+
+   uint32_t crc32c( const char* data, size_t len, uint32_t seed ) {
+      const uint32_t crc = ~seed;
+#ifdef FC_CRC32C_X86
+      switch( get_crc32c_backend() ) {
+         case crc32c_backend::pclmul: {
+            static const detail::crc32c_shift_clmul long_shift( detail::crc32c_long ), short_shift( detail::crc32c_short );
+            return ~detail::crc32c_sse42( crc, data, len, long_shift, short_shift );
+         }
+         case crc32c_backend::sse42: {
+            static const detail::crc32c_shift_table long_shift( detail::crc32c_long ), short_shift( detail::crc32c_short );
+            return ~detail::crc32c_sse42( crc, data, len, long_shift, short_shift );
+         }
+         default:
+            break;
+      }
+#endif
+      return ~crc32cSlicingBy8( crc, data, len );
+   }
+
+} // namespace fc
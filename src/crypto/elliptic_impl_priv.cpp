@@ -2,6 +2,8 @@
 
 #include <secp256k1.h>
 
+#include <atomic>
+
 #include "_elliptic_impl_priv.hpp"
 
 /* used by mixed + secp256k1 */
@@ -9,6 +11,26 @@
 namespace fc { namespace ecc {
     namespace detail {
 
+        static secp256k1_context_t* _get_shared_context() {
+            static secp256k1_context_t* ctx = secp256k1_context_create( SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN );
+            return ctx;
+        }
+
+        static std::atomic<bool> _per_thread_contexts{false};
+
+        /// a clone of the shared context owned by one thread, freed when the thread exits
+        struct thread_context {
+            secp256k1_context_t* ctx = secp256k1_context_clone( _get_shared_context() );
+            ~thread_context() { secp256k1_context_destroy( ctx ); }
+        };
+
+        const secp256k1_context_t* _get_context() {
+            if( !_per_thread_contexts.load( std::memory_order_relaxed ) )
+                return _get_shared_context();
+            thread_local thread_context tc;
+            return tc.ctx;
+        }
+
         private_key_impl::private_key_impl() BOOST_NOEXCEPT
         {
             _init_lib();
@@ -27,6 +49,13 @@ namespace fc { namespace ecc {
         }
     }
 
+    void init_context( bool per_thread_contexts )
+    {
+        detail::_get_shared_context();
+        detail::_per_thread_contexts = per_thread_contexts;
+        detail::_get_context();
+    }
+
     static const private_key_secret empty_priv;
 
     private_key::private_key() {}
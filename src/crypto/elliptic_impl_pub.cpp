@@ -355,4 +355,38 @@ namespace fc { namespace ecc {
         ECDSA_SIG_free(sig);
         FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
     }
+
+    bool public_key::verify( const fc::sha256& digest, const compact_signature& c, bool check_canonical )const
+    {
+        const int nV = c.data[0];
+        if( nV < 27 || nV >= 35 || !my->_key )
+            return false;
+        if( check_canonical && !is_canonical( c ) )
+            return false;
+
+        // SEC1 4.1.4 by hand, as ECDSA_do_verify does not give the point it computes: R = e s^-1 G + r s^-1 Q
+        // must have x = r mod n, and the y parity and x overflow the recovery id names, or recovering from c
+        // would give another key. The digest is the 256 bit order exactly, so it needs no shift.
+        const int recid = (nV - 27) & 3;
+        const EC_GROUP* group = EC_KEY_get0_group( my->_key );
+        bn_ctx ctx( BN_CTX_new() );
+        ec_point R( EC_POINT_new( group ) );
+        ssl_bignum order, r, s, e, w, u1, u2, x, y;
+        if( !ctx || !R || !EC_GROUP_get_order( group, order, ctx ) )
+            return false;
+        if( !BN_bin2bn( &c.data[1], 32, r ) || !BN_bin2bn( &c.data[33], 32, s ) ||
+            !BN_bin2bn( (const unsigned char*) digest.data(), sizeof(digest), e ) )
+            return false;
+        if( BN_is_zero( r ) || BN_is_zero( s ) || BN_cmp( r, order ) >= 0 || BN_cmp( s, order ) >= 0 )
+            return false;
+        if( !BN_mod_inverse( w, s, order, ctx ) || !BN_mod_mul( u1, e, w, order, ctx ) || !BN_mod_mul( u2, r, w, order, ctx ) )
+            return false;
+        if( !EC_POINT_mul( group, R, u1, EC_KEY_get0_public_key( my->_key ), u2, ctx ) || EC_POINT_is_at_infinity( group, R ) )
+            return false;
+        if( !EC_POINT_get_affine_coordinates_GFp( group, R, x, y, ctx ) )
+            return false;
+        if( BN_is_odd( y ) != ( recid & 1 ) || ( BN_cmp( x, order ) >= 0 ) != bool( recid & 2 ) )
+            return false;
+        return BN_nnmod( x, x, order, ctx ) && BN_cmp( x, r ) == 0;
+    }
 }}
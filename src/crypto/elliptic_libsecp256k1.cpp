@@ -0,0 +1,307 @@
+#include <fc/crypto/elliptic.hpp>
+
+#include <fc/crypto/base58.hpp>
+#include <fc/crypto/openssl.hpp>
+#include <fc/crypto/sha512.hpp>
+
+#include <fc/fwd_impl.hpp>
+#include <fc/exception/exception.hpp>
+
+// only the recovery header, it includes the matching <secp256k1.h> from its own directory rather than the
+// bundled secp256k1-zkp header which is also on the include path
+#include <secp256k1_recovery.h>
+
+#include <atomic>
+
+/* K1 keys and signatures on a current libsecp256k1: safegcd inversion and the GLV endomorphism are always
+ * enabled there. Commitments and range proofs stay on the bundled secp256k1-zkp, see elliptic_commitments.cpp
+ */
+
+namespace fc { namespace ecc {
+    namespace detail
+    {
+        static secp256k1_context* _get_shared_context() {
+            static secp256k1_context* ctx = secp256k1_context_create( SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY );
+            return ctx;
+        }
+
+        static std::atomic<bool> _per_thread_contexts{false};
+
+        /// a clone of the shared context owned by one thread, freed when the thread exits
+        struct thread_context {
+            secp256k1_context* ctx = secp256k1_context_clone( _get_shared_context() );
+            ~thread_context() { secp256k1_context_destroy( ctx ); }
+        };
+
+        static const secp256k1_context* _get_context() {
+            if( !_per_thread_contexts.load( std::memory_order_relaxed ) )
+                return _get_shared_context();
+            thread_local thread_context tc;
+            return tc.ctx;
+        }
+
+        static void _init_lib() {
+            static const secp256k1_context* ctx = _get_shared_context();
+            static int init_o = init_openssl();
+            (void)ctx;
+            (void)init_o;
+        }
+
+        class public_key_impl
+        {
+            public:
+                public_key_impl() BOOST_NOEXCEPT
+                {
+                    _init_lib();
+                }
+
+                public_key_impl( const public_key_impl& cpy ) BOOST_NOEXCEPT
+                    : _key( cpy._key )
+                {
+                    _init_lib();
+                }
+
+                public_key_data _key;
+        };
+
+        class private_key_impl
+        {
+            public:
+                private_key_impl() BOOST_NOEXCEPT
+                {
+                    _init_lib();
+                }
+
+                private_key_impl( const private_key_impl& cpy ) BOOST_NOEXCEPT
+                    : _key( cpy._key )
+                {
+                    _init_lib();
+                }
+
+                private_key_impl& operator=( const private_key_impl& pk ) BOOST_NOEXCEPT
+                {
+                    _key = pk._key;
+                    return *this;
+                }
+
+                private_key_secret _key;
+        };
+
+        static secp256k1_pubkey _parse( const char* data, size_t len )
+        {
+            secp256k1_pubkey pk;
+            FC_ASSERT( secp256k1_ec_pubkey_parse( _get_context(), &pk, (const unsigned char*) data, len ), "invalid public key" );
+            return pk;
+        }
+
+        static void _serialize( const secp256k1_pubkey& pk, char* out, size_t len, unsigned int flags )
+        {
+            size_t out_len = len;
+            FC_ASSERT( secp256k1_ec_pubkey_serialize( _get_context(), (unsigned char*) out, &out_len, &pk, flags ) );
+            FC_ASSERT( out_len == len );
+        }
+    }
+
+    static const public_key_data empty_pub;
+    static const private_key_secret empty_priv;
+
+    void init_context( bool per_thread_contexts )
+    {
+        detail::_get_shared_context();
+        detail::_per_thread_contexts = per_thread_contexts;
+        detail::_get_context();
+    }
+
+    fc::sha512 private_key::get_shared_secret( const public_key& other )const
+    {
+      FC_ASSERT( my->_key != empty_priv );
+      FC_ASSERT( other.my->_key != empty_pub );
+      secp256k1_pubkey pk = detail::_parse( other.my->_key.begin(), other.my->_key.size() );
+      FC_ASSERT( secp256k1_ec_pubkey_tweak_mul( detail::_get_context(), &pk, (const unsigned char*) my->_key.data() ) );
+      public_key_data pub;
+      detail::_serialize( pk, pub.begin(), pub.size(), SECP256K1_EC_COMPRESSED );
+      return fc::sha512::hash( pub.begin() + 1, pub.size() - 1 );
+    }
+
+    public_key::public_key() {}
+
+    public_key::public_key( const public_key &pk ) : my( pk.my ) {}
+
+    public_key::public_key( public_key &&pk ) : my( std::move( pk.my ) ) {}
+
+    public_key::~public_key() {}
+
+    public_key& public_key::operator=( const public_key& pk )
+    {
+        my = pk.my;
+        return *this;
+    }
+
+    public_key& public_key::operator=( public_key&& pk )
+    {
+        my = pk.my;
+        return *this;
+    }
+
+    bool public_key::valid()const
+    {
+      return my->_key != empty_pub;
+    }
+
+    public_key public_key::add( const fc::sha256& digest )const
+    {
+        FC_ASSERT( my->_key != empty_pub );
+        secp256k1_pubkey pk = detail::_parse( my->_key.begin(), my->_key.size() );
+        FC_ASSERT( secp256k1_ec_pubkey_tweak_add( detail::_get_context(), &pk, (const unsigned char*) digest.data() ) );
+        public_key_data new_key;
+        detail::_serialize( pk, new_key.begin(), new_key.size(), SECP256K1_EC_COMPRESSED );
+        return public_key( new_key );
+    }
+
+    std::string public_key::to_base58() const
+    {
+        FC_ASSERT( my->_key != empty_pub );
+        return to_base58( my->_key );
+    }
+
+    public_key_data public_key::serialize()const
+    {
+        FC_ASSERT( my->_key != empty_pub );
+        return my->_key;
+    }
+
+    public_key_point_data public_key::serialize_ecc_point()const
+    {
+        FC_ASSERT( my->_key != empty_pub );
+        public_key_point_data dat;
+        detail::_serialize( detail::_parse( my->_key.begin(), my->_key.size() ), dat.begin(), dat.size(), SECP256K1_EC_UNCOMPRESSED );
+        return dat;
+    }
+
+    public_key::public_key( const public_key_point_data& dat )
+    {
+        if( dat.data[0] == 0 ) {}
+        else
+        {
+            detail::_serialize( detail::_parse( dat.begin(), dat.size() ), my->_key.begin(), my->_key.size(), SECP256K1_EC_COMPRESSED );
+        }
+    }
+
+    public_key::public_key( const public_key_data& dat )
+    {
+        my->_key = dat;
+    }
+
+    public_key::public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical )
+    {
+        int nV = c.data[0];
+        if (nV<27 || nV>=35)
+            FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+
+        if( check_canonical )
+        {
+            FC_ASSERT( is_canonical( c ), "signature is not canonical" );
+        }
+
+        secp256k1_ecdsa_recoverable_signature sig;
+        FC_ASSERT( secp256k1_ecdsa_recoverable_signature_parse_compact( detail::_get_context(), &sig, c.begin() + 1, (nV - 27) & 3 ) );
+        secp256k1_pubkey pk;
+        FC_ASSERT( secp256k1_ecdsa_recover( detail::_get_context(), &pk, &sig, (const unsigned char*) digest.data() ) );
+        detail::_serialize( pk, my->_key.begin(), my->_key.size(), SECP256K1_EC_COMPRESSED );
+    }
+
+    bool public_key::verify( const fc::sha256& digest, const compact_signature& c, bool check_canonical )const
+    {
+        const int nV = c.data[0];
+        if( nV < 27 || nV >= 35 || my->_key == empty_pub )
+            return false;
+        if( check_canonical && !is_canonical( c ) )
+            return false;
+
+        // the library does not expose the point secp256k1_ecdsa_verify computes, so the recovery id is bound
+        // by recovering with it, the same one double multiplication, and comparing
+        const secp256k1_context* ctx = detail::_get_context();
+        secp256k1_ecdsa_recoverable_signature sig;
+        secp256k1_pubkey pk;
+        if( !secp256k1_ecdsa_recoverable_signature_parse_compact( ctx, &sig, c.begin() + 1, (nV - 27) & 3 ) ||
+            !secp256k1_ecdsa_recover( ctx, &pk, &sig, (const unsigned char*) digest.data() ) )
+            return false;
+        public_key_data recovered;
+        detail::_serialize( pk, recovered.begin(), recovered.size(), SECP256K1_EC_COMPRESSED );
+        return recovered == my->_key;
+    }
+
+    private_key::private_key() {}
+
+    private_key::private_key( const private_key& pk ) : my( pk.my ) {}
+
+    private_key::private_key( private_key&& pk ) : my( std::move( pk.my ) ) {}
+
+    private_key::~private_key() {}
+
+    private_key& private_key::operator=( private_key&& pk )
+    {
+        my = std::move( pk.my );
+        return *this;
+    }
+
+    private_key& private_key::operator=( const private_key& pk )
+    {
+        my = pk.my;
+        return *this;
+    }
+
+    private_key private_key::regenerate( const fc::sha256& secret )
+    {
+       private_key self;
+       self.my->_key = secret;
+       return self;
+    }
+
+    fc::sha256 private_key::get_secret()const
+    {
+        return my->_key;
+    }
+
+    private_key::private_key( EC_KEY* k )
+    {
+       my->_key = get_secret( k );
+       EC_KEY_free(k);
+    }
+
+    public_key private_key::get_public_key()const
+    {
+       FC_ASSERT( my->_key != empty_priv );
+       secp256k1_pubkey pk;
+       FC_ASSERT( secp256k1_ec_pubkey_create( detail::_get_context(), &pk, (const unsigned char*) my->_key.data() ) );
+       public_key_data pub;
+       detail::_serialize( pk, pub.begin(), pub.size(), SECP256K1_EC_COMPRESSED );
+       return public_key(pub);
+    }
+
+    /// same nonce sequence as the secp256k1 backend: every attempt asks rfc6979 for its next candidate
+    static int extended_nonce_function( unsigned char *nonce32, const unsigned char *msg32,
+                                        const unsigned char *key32, const unsigned char *algo16,
+                                        void *data, unsigned int attempt ) {
+        unsigned int* extra = (unsigned int*) data;
+        (*extra)++;
+        return secp256k1_nonce_function_default( nonce32, msg32, key32, algo16, nullptr, *extra );
+    }
+
+    compact_signature private_key::sign_compact( const fc::sha256& digest, bool require_canonical )const
+    {
+        FC_ASSERT( my->_key != empty_priv );
+        compact_signature result;
+        int recid;
+        unsigned int counter = 0;
+        do
+        {
+            secp256k1_ecdsa_recoverable_signature sig;
+            FC_ASSERT( secp256k1_ecdsa_sign_recoverable( detail::_get_context(), &sig, (const unsigned char*) digest.data(), (const unsigned char*) my->_key.data(), extended_nonce_function, &counter ) );
+            FC_ASSERT( secp256k1_ecdsa_recoverable_signature_serialize_compact( detail::_get_context(), result.begin() + 1, &recid, &sig ) );
+        } while( require_canonical && !public_key::is_canonical( result ) );
+        result.begin()[0] = 27 + 4 + recid;
+        return result;
+    }
+
+} }
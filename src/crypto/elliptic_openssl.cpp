@@ -256,4 +256,9 @@ namespace fc { namespace ecc {
             } // while true
         } FC_RETHROW_EXCEPTIONS( warn, "sign ${digest}", ("digest", digest)("private_key",*this) );
     }
+
+    void init_context( bool per_thread_contexts )
+    {
+        detail::_init_lib();
+    }
 } }
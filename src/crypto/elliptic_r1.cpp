@@ -530,49 +530,53 @@ namespace fc { namespace crypto { namespace r1 {
     }
 
     public_key::public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical )
+    : public_key( recover( c, digest ) )
     {
+    }
+
+    static const unsigned char halforder[32] = {
+       0x7f, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+       0xde, 0x73, 0x7d, 0x56, 0xd3, 0x8b, 0xcf, 0x42, 0x79, 0xdc, 0xe5, 0x61, 0x7e, 0x31, 0x92, 0xa8
+    };
+
+    public_key_data public_key::recover( const compact_signature& c, const fc::sha256& digest )
+    {
+
         int nV = c.data[0];
         if (nV<27 || nV>=35)
             FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
 
-        ecdsa_sig sig = ECDSA_SIG_new();
-        BIGNUM *r = BN_new(), *s = BN_new();
-        BN_bin2bn(&c.data[1],32,r);
-        BN_bin2bn(&c.data[33],32,s);
-        ECDSA_SIG_set0(sig, r, s);
-
-        my->_key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
-
-        const EC_GROUP* group = EC_KEY_get0_group(my->_key);
-        ssl_bignum order, halforder;
-        EC_GROUP_get_order(group, order, nullptr);
-        BN_rshift1(halforder, order);
-        if(BN_cmp(s, halforder) > 0)
+        if(memcmp(&c.data[33], halforder, sizeof(halforder)) > 0)
            FC_THROW_EXCEPTION( exception, "invalid high s-value encountered in r1 signature" );
 
+        // the compressed flag only picks the encoding, keys are always serialized compressed
         if (nV >= 31)
-        {
-            EC_KEY_set_conv_form( my->_key, POINT_CONVERSION_COMPRESSED );
             nV -= 4;
-//            fprintf( stderr, "compressed\n" );
-        }
 
-        if (ECDSA_SIG_recover_key_GFp(my->_key, sig, (unsigned char*)&digest, sizeof(digest), nV - 27, 0) == 1)
-            return;
+        public_key_data dat;
+        if (recover_public_key_data(&c.data[1], digest, nV - 27, dat))
+            return dat;
         FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
     }
 
+    bool public_key::verify( const public_key_data& key, const compact_signature& c, const fc::sha256& digest )
+    {
+        const int nV = c.data[0];
+        if( nV < 27 || nV >= 35 )
+            return false;
+        if( memcmp( &c.data[33], halforder, sizeof(halforder) ) > 0 )
+            return false;
+        return verify_public_key_data( &c.data[1], digest, ( nV - 27 ) & 3, key );
+    }
+
     compact_signature private_key::sign_compact( const fc::sha256& digest )const
     {
       try {
         FC_ASSERT( my->_key != nullptr );
-        auto my_pub_key = get_public_key().serialize(); // just for good measure
-        ecdsa_sig sig = ECDSA_do_sign((unsigned char*)&digest, sizeof(digest), my->_key);
-
-        if (sig==nullptr)
+        compact_signature sig;
+        if( !sign_compact_data( get_secret(), digest, sig ) )
           FC_THROW_EXCEPTION( exception, "Unable to sign" );
-
-        return signature_from_ecdsa(my->_key, my_pub_key, sig, digest);
+        return sig;
       } FC_RETHROW_EXCEPTIONS( warn, "sign ${digest}", ("digest", digest)("private_key",*this) );
     }
 
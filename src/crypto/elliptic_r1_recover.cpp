@@ -0,0 +1,184 @@
+#include <fc/crypto/elliptic_r1.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/scoped_exit.hpp>
+
+#include <cstring>
+
+/* P-256 public key recovery, signature verification and signing on OpenSSL's P-256 implementation
+ * (assembly with a precomputed generator table on the common targets) with the group, BN_CTX, points and
+ * bignums kept per thread. Unlike ECDSA_SIG_recover_key_GFp, ECDSA_do_verify or ECDSA_do_sign no EC_KEY,
+ * ECDSA_SIG, EC_GROUP or BN_CTX is built per call. OpenSSL still allocates inside EC_POINT_mul and, when
+ * signing, inside BN_generate_dsa_nonce, BN_rand_range and the inversions.
+ */
+
+namespace fc { namespace crypto { namespace r1 {
+
+   namespace detail {
+
+      struct recovery_context {
+         ec_group      group{ EC_GROUP_new_by_curve_name( NID_X9_62_prime256v1 ) };
+         bn_ctx        ctx{ BN_CTX_new() };
+         ec_point      R{ EC_POINT_new( group ) };
+         ec_point      Q{ EC_POINT_new( group ) };
+         ssl_bignum    order, half_order, field, x, y, r, s, e, rr, sor, eor;
+         /// signing secret, nonce and blinding factor, cleared before sign_compact_data returns
+         ssl_bignum    d, k, blind;
+         /// the key last verified against, decoded
+         ec_point        K{ EC_POINT_new( group ) };
+         public_key_data key;
+         bool            have_key = false;
+
+         recovery_context() {
+            FC_ASSERT( group && ctx && R && Q && K, "unable to create P-256 recovery context" );
+            FC_ASSERT( EC_GROUP_get_order( group, order, ctx ) );
+            FC_ASSERT( BN_rshift1( half_order, order ) );
+            FC_ASSERT( EC_GROUP_get_curve_GFp( group, field, nullptr, nullptr, ctx ) );
+         }
+      };
+
+      static recovery_context& get_recovery_context() {
+         thread_local recovery_context c;
+         return c;
+      }
+
+   } // namespace detail
+
+   bool recover_public_key_data( const unsigned char* rs, const fc::sha256& digest, int recid, public_key_data& out )
+   {
+      detail::recovery_context& c = detail::get_recovery_context();
+      const EC_GROUP* group = c.group;
+
+      // SEC1 4.1.6 as in ECDSA_SIG_recover_key_GFp without the extra check, the digest is exactly the
+      // 256 bit degree so it needs no shift
+      if( !BN_bin2bn( rs, 32, c.r ) || !BN_bin2bn( rs + 32, 32, c.s ) ||
+          !BN_bin2bn( (const unsigned char*) digest.data(), digest.data_size(), c.e ) )
+         return false;
+      if( !BN_copy( c.x, c.r ) )
+         return false;
+      if( recid / 2 && !BN_add( c.x, c.x, c.order ) )
+         return false;
+      if( BN_cmp( c.x, c.field ) >= 0 )
+         return false;
+      if( !EC_POINT_set_compressed_coordinates_GFp( group, c.R, c.x, recid % 2, c.ctx ) )
+         return false;
+
+      // Q = r^-1 (s R - e G)
+      BN_zero( c.x );
+      if( !BN_mod_sub( c.e, c.x, c.e, c.order, c.ctx ) )
+         return false;
+      if( !BN_mod_inverse( c.rr, c.r, c.order, c.ctx ) )
+         return false;
+      if( !BN_mod_mul( c.sor, c.s, c.rr, c.order, c.ctx ) || !BN_mod_mul( c.eor, c.e, c.rr, c.order, c.ctx ) )
+         return false;
+      if( !EC_POINT_mul( group, c.Q, c.eor, c.R, c.sor, c.ctx ) )
+         return false;
+
+      memset( out.data, 0, sizeof(out.data) );
+      if( EC_POINT_is_at_infinity( group, c.Q ) )
+         return true; // what serializing the EC_KEY of a key at infinity gives
+      return EC_POINT_point2oct( group, c.Q, POINT_CONVERSION_COMPRESSED, (unsigned char*) out.data, out.size(), c.ctx ) == out.size();
+   }
+
+   bool verify_public_key_data( const unsigned char* rs, const fc::sha256& digest, int recid, const public_key_data& key )
+   {
+      detail::recovery_context& c = detail::get_recovery_context();
+      const EC_GROUP* group = c.group;
+
+      if( !c.have_key || c.key != key ) {
+         c.have_key = EC_POINT_oct2point( group, c.K, (const unsigned char*) key.data, key.size(), c.ctx ) &&
+                      !EC_POINT_is_at_infinity( group, c.K );
+         if( !c.have_key )
+            return false;
+         c.key = key;
+      }
+
+      if( !BN_bin2bn( rs, 32, c.r ) || !BN_bin2bn( rs + 32, 32, c.s ) ||
+          !BN_bin2bn( (const unsigned char*) digest.data(), digest.data_size(), c.e ) )
+         return false;
+      if( BN_is_zero( c.r ) || BN_is_zero( c.s ) || BN_cmp( c.r, c.order ) >= 0 || BN_cmp( c.s, c.order ) >= 0 )
+         return false;
+
+      // SEC1 4.1.4: R = e s^-1 G + r s^-1 K must have x = r mod n, and the y parity and x overflow recid
+      // names, or recovering from rs would give another key
+      if( !BN_mod_inverse( c.rr, c.s, c.order, c.ctx ) )
+         return false;
+      if( !BN_mod_mul( c.eor, c.e, c.rr, c.order, c.ctx ) || !BN_mod_mul( c.sor, c.r, c.rr, c.order, c.ctx ) )
+         return false;
+      if( !EC_POINT_mul( group, c.R, c.eor, c.K, c.sor, c.ctx ) || EC_POINT_is_at_infinity( group, c.R ) )
+         return false;
+      if( !EC_POINT_get_affine_coordinates_GFp( group, c.R, c.x, c.y, c.ctx ) )
+         return false;
+      if( BN_is_odd( c.y ) != ( recid & 1 ) || ( BN_cmp( c.x, c.order ) >= 0 ) != bool( recid & 2 ) )
+         return false;
+      if( !BN_nnmod( c.x, c.x, c.order, c.ctx ) )
+         return false;
+      return BN_cmp( c.x, c.r ) == 0;
+   }
+
+   bool sign_compact_data( const private_key_secret& secret, const fc::sha256& digest, compact_signature& out )
+   {
+      detail::recovery_context& c = detail::get_recovery_context();
+      const EC_GROUP* group = c.group;
+      // nothing derived from the secret or nonce outlives the call in the per thread bignums
+      auto clear_secrets = fc::make_scoped_exit( [&c]() {
+         BN_clear( c.d ); BN_clear( c.k ); BN_clear( c.blind );
+         BN_clear( c.sor ); BN_clear( c.eor ); BN_clear( c.rr ); BN_clear( c.s );
+      } );
+
+      if( !BN_bin2bn( (const unsigned char*) secret.data(), secret.data_size(), c.d ) ||
+          !BN_bin2bn( (const unsigned char*) digest.data(), digest.data_size(), c.e ) )
+         return false;
+      if( BN_is_zero( c.d ) || BN_cmp( c.d, c.order ) >= 0 )
+         return false;
+      BN_set_flags( c.d, BN_FLG_CONSTTIME );
+
+      // a zero r or s needs another nonce, which happens with probability about 2^-255
+      for( int attempt = 0; attempt < 8; ++attempt ) {
+         // the nonce hashes fresh randomness with the secret and digest, as ECDSA_do_sign does
+         if( !BN_generate_dsa_nonce( c.k, c.order, c.d, (const unsigned char*) digest.data(), digest.data_size(), c.ctx ) )
+            return false;
+         BN_set_flags( c.k, BN_FLG_CONSTTIME );
+         if( !EC_POINT_mul( group, c.R, c.k, nullptr, nullptr, c.ctx ) ||
+             !EC_POINT_get_affine_coordinates_GFp( group, c.R, c.x, c.y, c.ctx ) )
+            return false;
+         // the recovery id follows from R: y parity, and whether x was reduced
+         int recid = BN_is_odd( c.y ) ? 1 : 0;
+         if( BN_cmp( c.x, c.order ) >= 0 )
+            recid |= 2;
+         if( !BN_nnmod( c.r, c.x, c.order, c.ctx ) )
+            return false;
+         if( BN_is_zero( c.r ) )
+            continue;
+
+         // s = k^-1 ( e + r d ), with the secret only multiplied in blinded: b^-1 k^-1 ( b e + b d r )
+         do {
+            if( !BN_rand_range( c.blind, c.order ) )
+               return false;
+         } while( BN_is_zero( c.blind ) );
+         if( !BN_mod_mul( c.sor, c.blind, c.d, c.order, c.ctx ) || !BN_mod_mul( c.sor, c.sor, c.r, c.order, c.ctx ) ||
+             !BN_mod_mul( c.eor, c.blind, c.e, c.order, c.ctx ) || !BN_mod_add( c.s, c.eor, c.sor, c.order, c.ctx ) )
+            return false;
+         if( !BN_mod_inverse( c.rr, c.k, c.order, c.ctx ) || !BN_mod_mul( c.s, c.s, c.rr, c.order, c.ctx ) ||
+             !BN_mod_inverse( c.rr, c.blind, c.order, c.ctx ) || !BN_mod_mul( c.s, c.s, c.rr, c.order, c.ctx ) )
+            return false;
+         if( BN_is_zero( c.s ) )
+            continue;
+
+         // the low s, which is what recovery accepts; negating s negates R, the other y
+         if( BN_cmp( c.s, c.half_order ) > 0 ) {
+            if( !BN_sub( c.s, c.order, c.s ) )
+               return false;
+            recid ^= 1;
+         }
+
+         memset( out.data, 0, sizeof(out.data) );
+         out.data[0] = 27 + 4 + recid;
+         BN_bn2bin( c.r, &out.data[33 - BN_num_bytes( c.r )] );
+         BN_bn2bin( c.s, &out.data[65 - BN_num_bytes( c.s )] );
+         return true;
+      }
+      return false;
+   }
+
+} } } // fc::crypto::r1
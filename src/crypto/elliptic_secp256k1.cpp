@@ -24,11 +24,6 @@
 namespace fc { namespace ecc {
     namespace detail
     {
-        const secp256k1_context_t* _get_context() {
-            static secp256k1_context_t* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_RANGEPROOF | SECP256K1_CONTEXT_COMMIT );
-            return ctx;
-        }
-
         void _init_lib() {
             static const secp256k1_context_t* ctx = _get_context();
             static int init_o = init_openssl();
@@ -169,103 +164,22 @@ namespace fc { namespace ecc {
         FC_ASSERT( pk_len == my->_key.size() );
     }
 
-
-     commitment_type blind( const blind_factor_type& blind, uint64_t value )
-     {
-        commitment_type result;
-        FC_ASSERT( secp256k1_pedersen_commit( detail::_get_context(), (unsigned char*)&result, (unsigned char*)&blind, value ) );
-        return result;
-     }
-
-     blind_factor_type blind_sum( const std::vector<blind_factor_type>& blinds_in, uint32_t non_neg )
-     {
-        blind_factor_type result;
-        std::vector<const unsigned char*> blinds(blinds_in.size());
-        for( uint32_t i = 0; i < blinds_in.size(); ++i ) blinds[i] = (const unsigned char*)&blinds_in[i];
-        FC_ASSERT( secp256k1_pedersen_blind_sum( detail::_get_context(), (unsigned char*)&result, blinds.data(), blinds_in.size(), non_neg ) );
-        return result;
-     }
-
-     /**  verifies taht commnits + neg_commits + excess == 0 */
-     bool            verify_sum( const std::vector<commitment_type>& commits_in, const std::vector<commitment_type>& neg_commits_in, int64_t excess )
-     {
-        std::vector<const unsigned char*> commits(commits_in.size());
-        for( uint32_t i = 0; i < commits_in.size(); ++i ) commits[i] = (const unsigned char*)&commits_in[i];
-        std::vector<const unsigned char*> neg_commits(neg_commits_in.size());
-        for( uint32_t i = 0; i < neg_commits_in.size(); ++i ) neg_commits[i] = (const unsigned char*)&neg_commits_in[i];
-
-        return secp256k1_pedersen_verify_tally( detail::_get_context(), commits.data(), commits.size(), neg_commits.data(), neg_commits.size(), excess  );
-     }
-
-     bool            verify_range( uint64_t& min_val, uint64_t& max_val, const commitment_type& commit, const std::vector<char>& proof )
-     {
-        return secp256k1_rangeproof_verify( detail::_get_context(), &min_val, &max_val, (const unsigned char*)&commit, (const unsigned char*)proof.data(), proof.size() );
-     }
-
-     std::vector<char>    range_proof_sign( uint64_t min_value, 
-                                       const commitment_type& commit, 
-                                       const blind_factor_type& commit_blind, 
-                                       const blind_factor_type& nonce,
-                                       int8_t base10_exp,
-                                       uint8_t min_bits,
-                                       uint64_t actual_value
-                                     )
-     {
-        int proof_len = 5134; 
-        std::vector<char> proof(proof_len);
-
-        FC_ASSERT( secp256k1_rangeproof_sign( detail::_get_context(), 
-                                              (unsigned char*)proof.data(), 
-                                              &proof_len, min_value, 
-                                              (const unsigned char*)&commit, 
-                                              (const unsigned char*)&commit_blind, 
-                                              (const unsigned char*)&nonce, 
-                                              base10_exp, min_bits, actual_value ) );
-        proof.resize(proof_len);
-        return proof;
-     }
-
-
-     bool            verify_range_proof_rewind( blind_factor_type& blind_out,
-                                                uint64_t& value_out,
-                                                string& message_out, 
-                                                const blind_factor_type& nonce,
-                                                uint64_t& min_val, 
-                                                uint64_t& max_val, 
-                                                commitment_type commit, 
-                                                const std::vector<char>& proof )
-     {
-        char msg[4096];
-        int  mlen = 0;
-        FC_ASSERT( secp256k1_rangeproof_rewind( detail::_get_context(), 
-                                                (unsigned char*)&blind_out,
-                                                &value_out,
-                                                (unsigned char*)msg,
-                                                &mlen,
-                                                (const unsigned char*)&nonce,
-                                                &min_val,
-                                                &max_val,
-                                                (const unsigned char*)&commit,
-                                                (const unsigned char*)proof.data(),
-                                                proof.size() ) );
-
-        message_out = std::string( msg, mlen );
-        return true;
-     }
-
-     range_proof_info range_get_info( const std::vector<char>& proof )
-     {
-        range_proof_info result;
-        FC_ASSERT( secp256k1_rangeproof_info( detail::_get_context(), 
-                                              (int*)&result.exp, 
-                                              (int*)&result.mantissa, 
-                                              (uint64_t*)&result.min_value, 
-                                              (uint64_t*)&result.max_value, 
-                                              (const unsigned char*)proof.data(), 
-                                              (int)proof.size() ) );
-
-        return result;
-     }
-
+    bool public_key::verify( const fc::sha256& digest, const compact_signature& c, bool check_canonical )const
+    {
+        const int nV = c.data[0];
+        if( nV < 27 || nV >= 35 || my->_key == empty_pub )
+            return false;
+        if( check_canonical && !is_canonical( c ) )
+            return false;
+
+        // the library does not expose the point secp256k1_ecdsa_verify computes, so the recovery id is bound
+        // by recovering with it, the same one double multiplication, and comparing
+        public_key_data recovered;
+        int pk_len = 0;
+        if( !secp256k1_ecdsa_recover_compact( detail::_get_context(), (const unsigned char*) digest.data(), c.begin() + 1,
+                                              (unsigned char*) recovered.begin(), &pk_len, 1, (nV - 27) & 3 ) )
+            return false;
+        return pk_len == int( recovered.size() ) && recovered == my->_key;
+    }
 
 } }
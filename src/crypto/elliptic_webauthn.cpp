@@ -1,6 +1,7 @@
 #include <fc/crypto/elliptic_webauthn.hpp>
 #include <fc/crypto/elliptic_r1.hpp>
 #include <fc/crypto/base58.hpp>
+#include <fc/crypto/base64.hpp>
 #include <fc/crypto/openssl.hpp>
 
 #include <fc/fwd_impl.hpp>
@@ -183,19 +184,29 @@ struct webauthn_json_handler : public rapidjson::BaseReaderHandler<rapidjson::UT
       }
    }
 };
-} //detail
-
 
-public_key::public_key(const signature& c, const fc::sha256& digest, bool) {
-   detail::webauthn_json_handler handler;
-   detail::rapidjson::Reader reader;
-   detail::rapidjson::StringStream ss(c.client_json.c_str());
-   FC_ASSERT(reader.Parse<detail::rapidjson::kParseIterativeFlag>(ss, handler), "Failed to parse client data JSON");
+/// checks the client data of a signature against digest, returns the digest the authenticator signed
+static fc::sha256 signed_digest(const fc::sha256& digest, const std::string& client_json,
+                                const std::vector<uint8_t>& auth_data, std::string& rpid,
+                                public_key::user_presence_t& user_verification_type) {
+   webauthn_json_handler handler;
+   rapidjson::Reader reader;
+   rapidjson::StringStream ss(client_json.c_str());
+   FC_ASSERT(reader.Parse<rapidjson::kParseIterativeFlag>(ss, handler), "Failed to parse client data JSON");
 
    FC_ASSERT(handler.found_type == "webauthn.get", "webauthn signature type not an assertion");
 
-   std::string challenge_bytes = fc::base64url_decode(handler.found_challenge);
-   FC_ASSERT(fc::sha256(challenge_bytes.data(), challenge_bytes.size()) == digest, "Wrong webauthn challenge");
+   // the challenge is a digest, decoded straight into one
+   const std::string& challenge_str = handler.found_challenge;
+   fc::sha256 challenge;
+   size_t challenge_len = 0;
+   if(!fc::base64_decode_to(challenge_str.data(), challenge_str.size(), challenge.data(), challenge.data_size(), challenge_len,
+                            fc::base64_alphabet::url, fc::base64_mode::lenient) || challenge_len != challenge.data_size()) {
+      // throws as base64url_decode and the sha256 constructor always have
+      std::string challenge_bytes = fc::base64url_decode(challenge_str);
+      challenge = fc::sha256(challenge_bytes.data(), challenge_bytes.size());
+   }
+   FC_ASSERT(challenge == digest, "Wrong webauthn challenge");
 
    char required_origin_scheme[] = "https://";
    size_t https_len = strlen(required_origin_scheme);
@@ -203,46 +214,59 @@ public_key::public_key(const signature& c, const fc::sha256& digest, bool) {
    rpid = handler.found_origin.substr(https_len, handler.found_origin.rfind(':')-https_len);
 
    constexpr static size_t min_auth_data_size = 37;
-   FC_ASSERT(c.auth_data.size() >= min_auth_data_size, "auth_data not as large as required");
-   if(c.auth_data[32] & 0x01)
-      user_verification_type = user_presence_t::USER_PRESENCE_PRESENT;
-   if(c.auth_data[32] & 0x04)
-      user_verification_type = user_presence_t::USER_PRESENCE_VERIFIED;
+   FC_ASSERT(auth_data.size() >= min_auth_data_size, "auth_data not as large as required");
+   if(auth_data[32] & 0x01)
+      user_verification_type = public_key::user_presence_t::USER_PRESENCE_PRESENT;
+   if(auth_data[32] & 0x04)
+      user_verification_type = public_key::user_presence_t::USER_PRESENCE_VERIFIED;
 
    static_assert(min_auth_data_size >= sizeof(fc::sha256), "auth_data min size not enough to store a sha256");
-   FC_ASSERT(memcmp(c.auth_data.data(), fc::sha256::hash(rpid).data(), sizeof(fc::sha256)) == 0, "webauthn rpid hash doesn't match origin");
+   FC_ASSERT(memcmp(auth_data.data(), fc::sha256::hash(rpid).data(), sizeof(fc::sha256)) == 0, "webauthn rpid hash doesn't match origin");
 
    //the signature (and thus public key we need to return) will be over
    // sha256(auth_data || client_data_hash)
-   fc::sha256 client_data_hash = fc::sha256::hash(c.client_json);
+   fc::sha256 client_data_hash = fc::sha256::hash(client_json);
    fc::sha256::encoder e;
-   e.write((char*)c.auth_data.data(), c.auth_data.size());
+   e.write((char*)auth_data.data(), auth_data.size());
    e.write(client_data_hash.data(), client_data_hash.data_size());
-   fc::sha256 signed_digest = e.result();
+   return e.result();
+}
+
+} //detail
+
+public_key::public_key(const signature& c, const fc::sha256& digest, bool) {
+   fc::sha256 signed_digest = detail::signed_digest(digest, c.client_json, c.auth_data, rpid, user_verification_type);
 
    //quite a bit of this copied from elliptic_r1, can probably commonize
    int nV = c.compact_signature.data[0];
    if (nV<31 || nV>=35)
       FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
-   ecdsa_sig sig = ECDSA_SIG_new();
-   BIGNUM *r = BN_new(), *s = BN_new();
-   BN_bin2bn(&c.compact_signature.data[1],32,r);
-   BN_bin2bn(&c.compact_signature.data[33],32,s);
-   ECDSA_SIG_set0(sig, r, s);
-
-   fc::ec_key key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
    nV -= 4;
 
-   if (r1::ECDSA_SIG_recover_key_GFp(key, sig, (uint8_t*)signed_digest.data(), signed_digest.data_size(), nV - 27, 0) == 1) {
-      const EC_POINT* point = EC_KEY_get0_public_key(key);
-      const EC_GROUP* group = EC_KEY_get0_group(key);
-      size_t sz = EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, (uint8_t*)public_key_data.data, public_key_data.size(), NULL);
-      if(sz == public_key_data.size())
-         return;
-   }
+   // a key at infinity has no 33 byte encoding
+   if (r1::recover_public_key_data(&c.compact_signature.data[1], signed_digest, nV - 27, public_key_data) && public_key_data.data[0])
+      return;
    FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
 }
 
+bool public_key::verify(const signature& c, const fc::sha256& digest) const {
+   try {
+      std::string signed_rpid;
+      user_presence_t signed_presence = user_presence_t::USER_PRESENCE_NONE;
+      fc::sha256 signed_digest = detail::signed_digest(digest, c.client_json, c.auth_data, signed_rpid, signed_presence);
+      // the key recovered from c would differ in these
+      if (signed_rpid != rpid || signed_presence != user_verification_type)
+         return false;
+
+      int nV = c.compact_signature.data[0];
+      if (nV<31 || nV>=35)
+         return false;
+      return r1::verify_public_key_data(&c.compact_signature.data[1], signed_digest, nV - 31, public_key_data);
+   } catch( const fc::exception& ) {
+      return false;
+   }
+}
+
 void public_key::post_init() {
    FC_ASSERT(rpid.length(), "webauthn pubkey must have non empty rpid");
 }
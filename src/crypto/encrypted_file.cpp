@@ -0,0 +1,198 @@
+#include <fc/crypto/encrypted_file.hpp>
+#include <fc/crypto/hmac.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/io/raw.hpp>
+
+#include <string.h>
+
+namespace fc {
+
+   namespace {
+      constexpr uint32_t max_chunk_size = uint32_t( 1 ) << 30;
+      constexpr size_t   hmac_size = sizeof(fc::sha256);
+
+      /// the packed header, and from its part before the check the file key and the check
+      void pack_header( encrypted_file_header& h, const fc::sha512& key, char* out, fc::sha256& file_key ) {
+         fc::datastream<char*> ds( out, encrypted_file_header::header_size );
+         fc::raw::pack( ds, h );
+         const size_t keyed = encrypted_file_header::header_size - hmac_size;
+         file_key = fc::hmac<fc::sha256>( key.data(), sizeof(key) ).digest( out, keyed );
+         static const char check[] = "key check";
+         h.check = fc::hmac<fc::sha256>( file_key.data(), sizeof(file_key) ).digest( check, sizeof(check) - 1 );
+         memcpy( out + keyed, h.check.data(), hmac_size );
+      }
+   }
+
+   fc::array<char, 8> encrypted_file_header::expected_magic()
+   {
+      fc::array<char, 8> m;
+      memcpy( m.data, "fcaesgcm", 8 );
+      return m;
+   }
+
+   encrypted_file_writer::encrypted_file_writer( const fc::path& file, const fc::sha512& key, uint32_t chunk_size )
+   : _chunk_size( chunk_size )
+   { try {
+      FC_ASSERT( chunk_size > 0 && chunk_size <= max_chunk_size, "chunk size ${c} out of range", ("c", chunk_size) );
+      encrypted_file_header h;
+      h.magic = encrypted_file_header::expected_magic();
+      h.chunk_size = chunk_size;
+      rand_bytes( h.salt.data, sizeof(h.salt.data) );
+      h.nonce = aes_gcm::random_nonce();
+      char packed[encrypted_file_header::header_size];
+      fc::sha256 file_key;
+      pack_header( h, key, packed, file_key );
+      _nonce = h.nonce;
+      _gcm.reset( new aes_gcm( file_key ) );
+      _buffer.resize( size_t( chunk_size ) + aes_gcm::tag_size );
+
+      _file.set_file_path( file );
+      _file.open( "wb" );
+      _file.write( packed, sizeof(packed) );
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("file", file) ) }
+
+   encrypted_file_writer::~encrypted_file_writer()
+   {
+   }
+
+   void encrypted_file_writer::write_chunk( const char* data, size_t len, bool last )
+   {
+      aes_gcm::tag_type tag;
+      _gcm->encrypt( aes_gcm::chunk_nonce( _nonce, _chunks, last ), data, len, _buffer.data(), tag );
+      memcpy( _buffer.data() + len, tag.data, aes_gcm::tag_size );
+      _file.write( _buffer.data(), len + aes_gcm::tag_size );
+      ++_chunks;
+   }
+
+   void encrypted_file_writer::write( const char* data, size_t len )
+   { try {
+      FC_ASSERT( _file.is_open(), "write to a closed encrypted file" );
+      _size += len;
+      while( len ) {
+         // a full chunk is written once more data shows it is not the last one
+         if( _fill == _chunk_size ) {
+            write_chunk( _buffer.data(), _fill, false );
+            _fill = 0;
+         }
+         if( _fill == 0 && len > _chunk_size ) {
+            write_chunk( data, _chunk_size, false );
+            data += _chunk_size;
+            len -= _chunk_size;
+            continue;
+         }
+         const size_t n = std::min( len, _chunk_size - _fill );
+         memcpy( _buffer.data() + _fill, data, n );
+         _fill += n;
+         data += n;
+         len -= n;
+      }
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("file", _file.get_file_path()) ) }
+
+   void encrypted_file_writer::close()
+   { try {
+      FC_ASSERT( _file.is_open(), "encrypted file closed twice" );
+      write_chunk( _buffer.data(), _fill, true );
+      _fill = 0;
+      _file.flush();
+      _file.close();
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("file", _file.get_file_path()) ) }
+
+   encrypted_file_reader::encrypted_file_reader( const fc::path& file, const fc::sha512& key )
+   { try {
+      FC_ASSERT( fc::exists( file ) );
+      _file.set_file_path( file );
+      _file.open( "rb" );
+      const uint64_t file_size = fc::file_size( file );
+      FC_ASSERT( file_size >= encrypted_file_header::header_size, "not an encrypted file" );
+
+      char packed[encrypted_file_header::header_size];
+      _file.read( packed, sizeof(packed) );
+      fc::datastream<const char*> ds( packed, sizeof(packed) );
+      fc::raw::unpack( ds, _header );
+      FC_ASSERT( _header.magic == encrypted_file_header::expected_magic(), "not an encrypted file" );
+      FC_ASSERT( _header.version == encrypted_file_header::current_version, "unknown encrypted file version ${v}",
+                 ("v", _header.version) );
+      FC_ASSERT( _header.chunk_size > 0 && _header.chunk_size <= max_chunk_size, "chunk size ${c} out of range",
+                 ("c", _header.chunk_size) );
+
+      encrypted_file_header expected = _header;
+      char repacked[encrypted_file_header::header_size];
+      fc::sha256 file_key;
+      pack_header( expected, key, repacked, file_key );
+      FC_ASSERT( expected.check == _header.check, "wrong key or damaged header" );
+      _gcm.reset( new aes_gcm( file_key ) );
+
+      const uint64_t body = file_size - encrypted_file_header::header_size;
+      const uint64_t stride = uint64_t( _header.chunk_size ) + aes_gcm::tag_size;
+      FC_ASSERT( body >= aes_gcm::tag_size, "encrypted file is truncated" );
+      _chunk_count = ( body + stride - 1 ) / stride;
+      const uint64_t last = body - ( _chunk_count - 1 ) * stride;
+      FC_ASSERT( last >= aes_gcm::tag_size, "encrypted file is truncated" );
+      _size = ( _chunk_count - 1 ) * _header.chunk_size + ( last - aes_gcm::tag_size );
+      _buffer.resize( _header.chunk_size );
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("file", file) ) }
+
+   size_t encrypted_file_reader::read_chunk( uint64_t index, char* out )
+   { try {
+      FC_ASSERT( index < _chunk_count, "chunk ${i} of ${n}", ("i", index)("n", _chunk_count) );
+      const bool last = index + 1 == _chunk_count;
+      const size_t len = last ? size_t( _size - index * _header.chunk_size ) : _header.chunk_size;
+      aes_gcm::tag_type tag;
+      _file.seek( long( encrypted_file_header::header_size + index * ( uint64_t( _header.chunk_size ) + aes_gcm::tag_size ) ) );
+      _file.read( out, len );
+      _file.read( tag.data, aes_gcm::tag_size );
+      FC_ASSERT( _gcm->decrypt( aes_gcm::chunk_nonce( _header.nonce, index, last ), out, len, tag ),
+                 "chunk ${i} is not authentic", ("i", index) );
+      return len;
+   } FC_RETHROW_EXCEPTIONS( warn, "", ("file", _file.get_file_path()) ) }
+
+   size_t encrypted_file_reader::read( char* out, size_t len )
+   {
+      const uint64_t cs = _header.chunk_size;
+      size_t done = 0;
+      while( len && _pos < _size ) {
+         const uint64_t index = _pos / cs;
+         const size_t   offset = size_t( _pos % cs );
+         const size_t   chunk_len = size_t( std::min( cs, _size - index * cs ) );
+         size_t n;
+         if( offset == 0 && len >= chunk_len && index != _buffered_chunk ) {
+            // whole chunks go straight to the caller
+            n = read_chunk( index, out );
+         } else {
+            if( index != _buffered_chunk ) {
+               _buffered_chunk = uint64_t( -1 );
+               read_chunk( index, _buffer.data() );
+               _buffered_chunk = index;
+            }
+            n = std::min( len, chunk_len - offset );
+            memcpy( out, _buffer.data() + offset, n );
+         }
+         out += n;
+         len -= n;
+         _pos += n;
+         done += n;
+      }
+      return done;
+   }
+
+   void encrypted_file_reader::seek( uint64_t pos )
+   {
+      FC_ASSERT( pos <= _size, "seek to ${p} past the end ${s}", ("p", pos)("s", _size) );
+      _pos = pos;
+   }
+
+   bool encrypted_file_reader::is_encrypted_file( const fc::path& file )
+   {
+      if( !fc::exists( file ) || fc::file_size( file ) < encrypted_file_header::header_size )
+         return false;
+      fc::cfile f;
+      f.set_file_path( file );
+      f.open( "rb" );
+      fc::array<char, 8> magic;
+      f.read( magic.data, sizeof(magic.data) );
+      return magic == encrypted_file_header::expected_magic();
+   }
+
+} // namespace fc
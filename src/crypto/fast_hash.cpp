@@ -0,0 +1,194 @@
+#include <fc/crypto/fast_hash.hpp>
+
+#include <atomic>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_FAST_HASH_X86 1
+#include <immintrin.h>
+#endif
+
+/* Up to a kilobyte the hash is wyhash: the key is read as 64 bit words that are mixed with the seed by
+ * multiplying to 128 bits and folding the halves. From a kilobyte on, whole kilobyte blocks go through eight
+ * lanes that each add one 32x32->64 bit product of the data and a secret per 8 bytes, the arithmetic of
+ * AVX2's vpmuludq, and are scrambled after every block. The lanes are folded into the seed for the tail.
+ */
+
+namespace fc {
+
+   namespace detail {
+
+      constexpr uint64_t fast_hash_prime32 = 0x9e3779b1u;
+      constexpr size_t   fast_hash_stripe = 64;
+      constexpr size_t   fast_hash_block = 16 * fast_hash_stripe;
+
+      /// secrets of the accumulator lanes, words n..n+7 for stripe n of a block and 16..23 for the scramble
+      struct fast_hash_secret {
+         uint64_t w[24];
+         constexpr fast_hash_secret() : w() {
+            uint64_t x = 0x6a09e667f3bcc908ull;
+            for( auto& v : w ) {
+               // splitmix64
+               uint64_t z = ( x += 0x9e3779b97f4a7c15ull );
+               z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+               z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+               v = z ^ ( z >> 31 );
+            }
+         }
+      };
+      static constexpr fast_hash_secret secret{};
+
+      static inline uint64_t read64( const uint8_t* p ) {
+         uint64_t v;
+         memcpy( &v, p, 8 );
+         return v;
+      }
+
+      /// @p len bytes at @p p, the last of an input of @p total bytes
+      static inline uint64_t wyhash_tail( const uint8_t* p, size_t len, uint64_t seed, uint64_t total ) {
+         uint64_t a, b;
+         if( len <= 16 ) {
+            fast_hash_short_words( (const char*)p, len, a, b );
+         } else {
+            size_t i = len;
+            if( i >= 48 ) {
+               uint64_t see1 = seed, see2 = seed;
+               do {
+                  seed = fast_hash_mix( read64( p ) ^ fast_hash_p[1], read64( p + 8 ) ^ seed );
+                  see1 = fast_hash_mix( read64( p + 16 ) ^ fast_hash_p[2], read64( p + 24 ) ^ see1 );
+                  see2 = fast_hash_mix( read64( p + 32 ) ^ fast_hash_p[3], read64( p + 40 ) ^ see2 );
+                  p += 48;
+                  i -= 48;
+               } while( i >= 48 );
+               seed ^= see1 ^ see2;
+            }
+            while( i > 16 ) {
+               seed = fast_hash_mix( read64( p ) ^ fast_hash_p[1], read64( p + 8 ) ^ seed );
+               i -= 16;
+               p += 16;
+            }
+            a = read64( p + i - 16 );
+            b = read64( p + i - 8 );
+         }
+         return fast_hash_final( a, b, seed, total );
+      }
+
+      static void accumulate_scalar( uint64_t* acc, const uint8_t* p, size_t blocks ) {
+         for( ; blocks; --blocks, p += fast_hash_block ) {
+            for( size_t n = 0; n < 16; ++n ) {
+               const uint8_t* s = p + n * fast_hash_stripe;
+               for( size_t i = 0; i < 8; ++i ) {
+                  const uint64_t d = read64( s + 8 * i );
+                  const uint64_t k = d ^ secret.w[n + i];
+                  acc[i ^ 1] += d;
+                  acc[i] += ( k & 0xffffffff ) * ( k >> 32 );
+               }
+            }
+            for( size_t i = 0; i < 8; ++i ) {
+               uint64_t a = acc[i];
+               a ^= a >> 47;
+               a ^= secret.w[16 + i];
+               acc[i] = a * fast_hash_prime32;
+            }
+         }
+      }
+
+#ifdef FC_FAST_HASH_X86
+
+      __attribute__((target("avx2")))
+      static void accumulate_avx2( uint64_t* acc, const uint8_t* p, size_t blocks ) {
+         __m256i a[2] = { _mm256_loadu_si256( (const __m256i*)acc ), _mm256_loadu_si256( (const __m256i*)( acc + 4 ) ) };
+         const __m256i prime = _mm256_set1_epi64x( fast_hash_prime32 );
+         for( ; blocks; --blocks, p += fast_hash_block ) {
+            for( size_t n = 0; n < 16; ++n ) {
+               const uint8_t* s = p + n * fast_hash_stripe;
+               for( int h = 0; h < 2; ++h ) {
+                  const __m256i d = _mm256_loadu_si256( (const __m256i*)( s + 32 * h ) );
+                  const __m256i k = _mm256_xor_si256( d, _mm256_loadu_si256( (const __m256i*)( secret.w + n + 4 * h ) ) );
+                  const __m256i prod = _mm256_mul_epu32( k, _mm256_srli_epi64( k, 32 ) );
+                  // lane i ^ 1 adds the data of lane i
+                  a[h] = _mm256_add_epi64( a[h], _mm256_add_epi64( prod, _mm256_shuffle_epi32( d, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+               }
+            }
+            for( int h = 0; h < 2; ++h ) {
+               __m256i x = _mm256_xor_si256( a[h], _mm256_srli_epi64( a[h], 47 ) );
+               x = _mm256_xor_si256( x, _mm256_loadu_si256( (const __m256i*)( secret.w + 16 + 4 * h ) ) );
+               const __m256i lo = _mm256_mul_epu32( x, prime );
+               const __m256i hi = _mm256_mul_epu32( _mm256_srli_epi64( x, 32 ), prime );
+               a[h] = _mm256_add_epi64( lo, _mm256_slli_epi64( hi, 32 ) );
+            }
+         }
+         _mm256_storeu_si256( (__m256i*)acc, a[0] );
+         _mm256_storeu_si256( (__m256i*)( acc + 4 ), a[1] );
+      }
+
+      static bool cpu_has_avx2() {
+         __builtin_cpu_init();
+         return __builtin_cpu_supports( "avx2" );
+      }
+
+#endif // FC_FAST_HASH_X86
+
+      static bool fast_hash_backend_supported( fast_hash_backend b ) {
+         switch( b ) {
+            case fast_hash_backend::scalar:
+               return true;
+#ifdef FC_FAST_HASH_X86
+            case fast_hash_backend::avx2:
+               return cpu_has_avx2();
+#endif
+            default:
+               return false;
+         }
+      }
+
+      static std::atomic<fast_hash_backend>& fast_hash_backend_state() {
+         static std::atomic<fast_hash_backend> b{ fast_hash_backend_supported( fast_hash_backend::avx2 )
+                                                  ? fast_hash_backend::avx2 : fast_hash_backend::scalar };
+         return b;
+      }
+
+      static uint64_t fast_hash_blocks( const uint8_t* p, size_t len, uint64_t seed ) {
+         uint64_t acc[8];
+         for( size_t i = 0; i < 8; ++i )
+            acc[i] = seed ^ secret.w[i];
+         const size_t blocks = len / fast_hash_block;
+#ifdef FC_FAST_HASH_X86
+         if( fast_hash_backend_state().load( std::memory_order_relaxed ) == fast_hash_backend::avx2 )
+            accumulate_avx2( acc, p, blocks );
+         else
+#endif
+            accumulate_scalar( acc, p, blocks );
+
+         uint64_t m = seed ^ len;
+         for( size_t i = 0; i < 8; i += 2 )
+            m = fast_hash_mix( acc[i] ^ secret.w[16 + i], acc[i + 1] ^ secret.w[17 + i] ^ m );
+         const size_t rest = len - blocks * fast_hash_block;
+         return wyhash_tail( p + len - rest, rest, m, len );
+      }
+
+      uint64_t fast_hash_long( const char* data, size_t len, uint64_t seed ) {
+         const uint8_t* p = (const uint8_t*)data;
+         if( len < fast_hash_block )
+            return wyhash_tail( p, len, seed, len );
+         return fast_hash_blocks( p, len, seed );
+      }
+
+   } // namespace detail
+
+   fast_hash_backend get_fast_hash_backend() {
+      return detail::fast_hash_backend_state().load( std::memory_order_relaxed );
+   }
+
+   bool set_fast_hash_backend( fast_hash_backend b ) {
+      if( !detail::fast_hash_backend_supported( b ) )
+         return false;
+      detail::fast_hash_backend_state() = b;
+      return true;
+   }
+
+   uint128 fast_hash128( const char* data, size_t len, uint64_t seed ) {
+      return uint128( fast_hash64( data, len, seed ^ detail::secret.w[23] ), fast_hash64( data, len, seed ) );
+   }
+
+} // namespace fc
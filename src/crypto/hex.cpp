@@ -1,8 +1,177 @@
 #include <fc/crypto/hex.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FC_HEX_X86 1
+#include <immintrin.h>
+#endif
+
+/* The vector kernels split each byte into nibbles and look both up in a 16 entry table with pshufb. Decoding
+ * maps each character c to c - '0' when that is at most 9 and to (c | 0x20) - 'a' + 10 when (c | 0x20) - 'a' is
+ * at most 5, keeps a mask of the characters that were neither, and joins nibble pairs with pmaddubsw by 16 and 1.
+ */
+
 namespace fc {
 
+   namespace detail {
+
+      struct hex_tables {
+         char    pairs[512];   ///< the two digits of every byte
+         uint8_t values[256];  ///< the value of every digit, 0xff for other characters
+
+         constexpr hex_tables() : pairs{}, values{} {
+            const char* digits = "0123456789abcdef";
+            for( int i = 0; i < 256; ++i ) {
+               pairs[2 * i] = digits[i >> 4];
+               pairs[2 * i + 1] = digits[i & 15];
+               values[i] = 0xff;
+            }
+            for( int i = 0; i < 10; ++i )
+               values['0' + i] = i;
+            for( int i = 0; i < 6; ++i )
+               values['a' + i] = values['A' + i] = 10 + i;
+         }
+      };
+
+      static constexpr hex_tables hex_table;
+
+      static void encode_scalar( const uint8_t* in, size_t len, char* out ) {
+         for( size_t i = 0; i < len; ++i ) {
+            out[2 * i] = hex_table.pairs[2 * in[i]];
+            out[2 * i + 1] = hex_table.pairs[2 * in[i] + 1];
+         }
+      }
+
+      static bool decode_scalar( const uint8_t* hex, size_t len, uint8_t* out ) {
+         uint8_t bad = 0;
+         for( size_t i = 0; i < len; ++i ) {
+            const uint8_t hi = hex_table.values[hex[2 * i]];
+            const uint8_t lo = hex_table.values[hex[2 * i + 1]];
+            bad |= hi | lo;
+            out[i] = uint8_t( hi << 4 | lo );
+         }
+         return !( bad & 0xf0 );
+      }
+
+#ifdef FC_HEX_X86
+
+      __attribute__((target("ssse3")))
+      static void encode_ssse3( const uint8_t* in, size_t len, char* out ) {
+         const __m128i lut = _mm_setr_epi8( '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' );
+         const __m128i mask = _mm_set1_epi8( 0x0f );
+         size_t i = 0;
+         for( ; i + 16 <= len; i += 16 ) {
+            const __m128i b = _mm_loadu_si128( (const __m128i*)( in + i ) );
+            const __m128i hi = _mm_shuffle_epi8( lut, _mm_and_si128( _mm_srli_epi16( b, 4 ), mask ) );
+            const __m128i lo = _mm_shuffle_epi8( lut, _mm_and_si128( b, mask ) );
+            _mm_storeu_si128( (__m128i*)( out + 2 * i ), _mm_unpacklo_epi8( hi, lo ) );
+            _mm_storeu_si128( (__m128i*)( out + 2 * i + 16 ), _mm_unpackhi_epi8( hi, lo ) );
+         }
+         encode_scalar( in + i, len - i, out + 2 * i );
+      }
+
+      __attribute__((target("avx2")))
+      static void encode_avx2( const uint8_t* in, size_t len, char* out ) {
+         const __m256i lut = _mm256_setr_epi8( '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                               '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' );
+         const __m256i mask = _mm256_set1_epi8( 0x0f );
+         size_t i = 0;
+         for( ; i + 32 <= len; i += 32 ) {
+            const __m256i b = _mm256_loadu_si256( (const __m256i*)( in + i ) );
+            const __m256i hi = _mm256_shuffle_epi8( lut, _mm256_and_si256( _mm256_srli_epi16( b, 4 ), mask ) );
+            const __m256i lo = _mm256_shuffle_epi8( lut, _mm256_and_si256( b, mask ) );
+            // unpacking works within 128 bit lanes: bytes 0-7 and 16-23, then 8-15 and 24-31
+            const __m256i a = _mm256_unpacklo_epi8( hi, lo );
+            const __m256i c = _mm256_unpackhi_epi8( hi, lo );
+            _mm256_storeu_si256( (__m256i*)( out + 2 * i ), _mm256_permute2x128_si256( a, c, 0x20 ) );
+            _mm256_storeu_si256( (__m256i*)( out + 2 * i + 32 ), _mm256_permute2x128_si256( a, c, 0x31 ) );
+         }
+         encode_ssse3( in + i, len - i, out + 2 * i );
+      }
+
+      /// the nibble of each hex digit in @p c, with the lanes that are not digits set in @p bad
+      __attribute__((target("ssse3")))
+      static inline __m128i nibbles_ssse3( __m128i c, __m128i& bad ) {
+         const __m128i d = _mm_sub_epi8( c, _mm_set1_epi8( '0' ) );
+         const __m128i l = _mm_sub_epi8( _mm_or_si128( c, _mm_set1_epi8( 0x20 ) ), _mm_set1_epi8( 'a' ) );
+         const __m128i is_d = _mm_cmpeq_epi8( _mm_min_epu8( d, _mm_set1_epi8( 9 ) ), d );
+         const __m128i is_l = _mm_cmpeq_epi8( _mm_min_epu8( l, _mm_set1_epi8( 5 ) ), l );
+         bad = _mm_or_si128( bad, _mm_cmpeq_epi8( _mm_or_si128( is_d, is_l ), _mm_setzero_si128() ) );
+         return _mm_or_si128( _mm_and_si128( is_d, d ), _mm_and_si128( is_l, _mm_add_epi8( l, _mm_set1_epi8( 10 ) ) ) );
+      }
+
+      __attribute__((target("ssse3")))
+      static bool decode_ssse3( const uint8_t* hex, size_t len, uint8_t* out ) {
+         const __m128i weights = _mm_set1_epi16( 0x0110 ); // 16 for the high digit, 1 for the low one
+         __m128i bad = _mm_setzero_si128();
+         size_t i = 0;
+         for( ; i + 16 <= len; i += 16 ) {
+            const __m128i a = nibbles_ssse3( _mm_loadu_si128( (const __m128i*)( hex + 2 * i ) ), bad );
+            const __m128i b = nibbles_ssse3( _mm_loadu_si128( (const __m128i*)( hex + 2 * i + 16 ) ), bad );
+            _mm_storeu_si128( (__m128i*)( out + i ),
+                              _mm_packus_epi16( _mm_maddubs_epi16( a, weights ), _mm_maddubs_epi16( b, weights ) ) );
+         }
+         const bool tail_ok = decode_scalar( hex + 2 * i, len - i, out + i );
+         return tail_ok && _mm_movemask_epi8( bad ) == 0;
+      }
+
+      __attribute__((target("avx2")))
+      static inline __m256i nibbles_avx2( __m256i c, __m256i& bad ) {
+         const __m256i d = _mm256_sub_epi8( c, _mm256_set1_epi8( '0' ) );
+         const __m256i l = _mm256_sub_epi8( _mm256_or_si256( c, _mm256_set1_epi8( 0x20 ) ), _mm256_set1_epi8( 'a' ) );
+         const __m256i is_d = _mm256_cmpeq_epi8( _mm256_min_epu8( d, _mm256_set1_epi8( 9 ) ), d );
+         const __m256i is_l = _mm256_cmpeq_epi8( _mm256_min_epu8( l, _mm256_set1_epi8( 5 ) ), l );
+         bad = _mm256_or_si256( bad, _mm256_cmpeq_epi8( _mm256_or_si256( is_d, is_l ), _mm256_setzero_si256() ) );
+         return _mm256_or_si256( _mm256_and_si256( is_d, d ), _mm256_and_si256( is_l, _mm256_add_epi8( l, _mm256_set1_epi8( 10 ) ) ) );
+      }
+
+      __attribute__((target("avx2")))
+      static bool decode_avx2( const uint8_t* hex, size_t len, uint8_t* out ) {
+         const __m256i weights = _mm256_set1_epi16( 0x0110 );
+         __m256i bad = _mm256_setzero_si256();
+         size_t i = 0;
+         for( ; i + 32 <= len; i += 32 ) {
+            const __m256i a = nibbles_avx2( _mm256_loadu_si256( (const __m256i*)( hex + 2 * i ) ), bad );
+            const __m256i b = nibbles_avx2( _mm256_loadu_si256( (const __m256i*)( hex + 2 * i + 32 ) ), bad );
+            // packing works within 128 bit lanes, giving the quarters of the output in the order 0 2 1 3
+            const __m256i p = _mm256_packus_epi16( _mm256_maddubs_epi16( a, weights ), _mm256_maddubs_epi16( b, weights ) );
+            _mm256_storeu_si256( (__m256i*)( out + i ), _mm256_permute4x64_epi64( p, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+         }
+         const bool tail_ok = decode_ssse3( hex + 2 * i, len - i, out + i );
+         return tail_ok && _mm256_movemask_epi8( bad ) == 0;
+      }
+
+#endif // FC_HEX_X86
+
+      static bool hex_backend_supported( hex_backend b ) {
+         switch( b ) {
+            case hex_backend::scalar:
+               return true;
+#ifdef FC_HEX_X86
+            case hex_backend::ssse3:
+               __builtin_cpu_init();
+               return __builtin_cpu_supports( "ssse3" );
+            case hex_backend::avx2:
+               __builtin_cpu_init();
+               return __builtin_cpu_supports( "avx2" );
+#endif
+            default:
+               return false;
+         }
+      }
+
+      static std::atomic<hex_backend>& hex_backend_state() {
+         static std::atomic<hex_backend> b{ hex_backend_supported( hex_backend::avx2 )  ? hex_backend::avx2
+                                          : hex_backend_supported( hex_backend::ssse3 ) ? hex_backend::ssse3
+                                                                                        : hex_backend::scalar };
+         return b;
+      }
+
+   } // namespace detail
+
     uint8_t from_hex( char c ) {
       if( c >= '0' && c <= '9' )
         return c - '0';
@@ -14,30 +183,67 @@ namespace fc {
       return 0;
     }
 
-    std::string to_hex( const char* d, uint32_t s ) 
+    void hex_encode( const char* in, size_t len, char* out ) {
+       switch( detail::hex_backend_state().load( std::memory_order_relaxed ) ) {
+#ifdef FC_HEX_X86
+          case hex_backend::avx2:
+             detail::encode_avx2( (const uint8_t*)in, len, out );
+             return;
+          case hex_backend::ssse3:
+             detail::encode_ssse3( (const uint8_t*)in, len, out );
+             return;
+#endif
+          default:
+             detail::encode_scalar( (const uint8_t*)in, len, out );
+       }
+    }
+
+    bool hex_decode( const char* hex, size_t hex_len, char* out ) {
+       if( hex_len % 2 )
+          return false;
+       switch( detail::hex_backend_state().load( std::memory_order_relaxed ) ) {
+#ifdef FC_HEX_X86
+          case hex_backend::avx2:
+             return detail::decode_avx2( (const uint8_t*)hex, hex_len / 2, (uint8_t*)out );
+          case hex_backend::ssse3:
+             return detail::decode_ssse3( (const uint8_t*)hex, hex_len / 2, (uint8_t*)out );
+#endif
+          default:
+             return detail::decode_scalar( (const uint8_t*)hex, hex_len / 2, (uint8_t*)out );
+       }
+    }
+
+    hex_backend get_hex_backend() {
+       return detail::hex_backend_state().load( std::memory_order_relaxed );
+    }
+
+    bool set_hex_backend( hex_backend b ) {
+       if( !detail::hex_backend_supported( b ) )
+          return false;
+       detail::hex_backend_state() = b;
+       return true;
+    }
+
+    std::string to_hex( const char* d, uint32_t s )
     {
-        std::string r;
-        const char* to_hex="0123456789abcdef";
-        uint8_t* c = (uint8_t*)d;
-        for( uint32_t i = 0; i < s; ++i )
-            (r += to_hex[(c[i]>>4)]) += to_hex[(c[i] &0x0f)];
+        std::string r( size_t( s ) * 2, '\0' );
+        hex_encode( d, s, &r[0] );
         return r;
     }
 
     size_t from_hex( const fc::string& hex_str, char* out_data, size_t out_data_len ) {
-        fc::string::const_iterator i = hex_str.begin();
-        uint8_t* out_pos = (uint8_t*)out_data;
-        uint8_t* out_end = out_pos + out_data_len;
-        while( i != hex_str.end() && out_end != out_pos ) {
-          *out_pos = from_hex( *i ) << 4;   
-          ++i;
-          if( i != hex_str.end() )  {
-              *out_pos |= from_hex( *i );
-              ++i;
-          }
-          ++out_pos;
+        const size_t pairs = std::min( hex_str.size() / 2, out_data_len );
+        if( !hex_decode( hex_str.data(), 2 * pairs, out_data ) ) {
+           // throws naming the first character that is not a digit
+           for( size_t i = 0; i < 2 * pairs; ++i )
+              from_hex( hex_str[i] );
+        }
+        if( pairs < out_data_len && 2 * pairs < hex_str.size() ) {
+           // an odd trailing digit is the high nibble of one more byte
+           out_data[pairs] = from_hex( hex_str[2 * pairs] ) << 4;
+           return pairs + 1;
         }
-        return out_pos - (uint8_t*)out_data;
+        return pairs;
     }
     std::string to_hex( const std::vector<char>& data )
     {
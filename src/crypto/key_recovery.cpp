@@ -0,0 +1,144 @@
+#include <fc/crypto/key_recovery.hpp>
+#include "_batch_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace fc { namespace crypto {
+
+   namespace detail {
+
+      /// signatures claimed by a thread at a time, small enough to balance uneven K1/R1/WebAuthn costs
+      constexpr size_t key_recovery_chunk_size = 8;
+
+      /// recovers keys into results or, given keys, verifies into verified
+      struct key_recovery_batch {
+         const signature*           sigs = nullptr;
+         const sha256*              digests = nullptr;
+         size_t                     digest_stride = 1;
+         size_t                     size = 0;
+         bool                       check_canonical = true;
+         public_key*                results = nullptr;
+         fc::exception_ptr*         errors = nullptr;
+         const public_key*          keys = nullptr;
+         size_t                     key_stride = 1;
+         char*                      verified = nullptr;
+         std::atomic<size_t>        next{0};
+
+         void run() {
+            for( size_t begin = next.fetch_add( key_recovery_chunk_size ); begin < size;
+                 begin = next.fetch_add( key_recovery_chunk_size ) ) {
+               const size_t end = std::min( begin + key_recovery_chunk_size, size );
+               if( keys ) {
+                  for( size_t i = begin; i < end; ++i )
+                     verified[i] = verify( keys[i * key_stride], digests[i * digest_stride], sigs[i], check_canonical );
+               } else {
+                  for( size_t i = begin; i < end; ++i )
+                     recover( i );
+               }
+            }
+         }
+
+         void recover( size_t i ) {
+            try {
+               results[i] = public_key( sigs[i], digests[i * digest_stride], check_canonical );
+            } catch( const fc::exception& e ) {
+               if( errors )
+                  errors[i] = e.dynamic_copy_exception();
+            } catch( const std::exception& e ) {
+               if( errors )
+                  errors[i] = std::make_shared<fc::std_exception_wrapper>(
+                        FC_LOG_MESSAGE( warn, "key recovery failed: ${what}", ("what", e.what()) ),
+                        std::current_exception(), BOOST_CORE_TYPEID( e ).name(), e.what() );
+            }
+         }
+      };
+
+   } // namespace detail
+
+   class key_recovery_pool::impl : public fc::detail::batch_pool<detail::key_recovery_batch> {
+   public:
+      using batch_pool::batch_pool;
+
+      void run( detail::key_recovery_batch& b ) {
+         if( get_num_threads() > 0 && b.size > detail::key_recovery_chunk_size )
+            batch_pool::run( b );
+         else
+            b.run();
+      }
+   };
+
+   key_recovery_pool::key_recovery_pool( size_t num_threads )
+   : my( new impl( num_threads ) )
+   {}
+
+   key_recovery_pool::~key_recovery_pool() {}
+
+   size_t key_recovery_pool::get_num_threads()const {
+      return my->get_num_threads();
+   }
+
+   std::vector<public_key> key_recovery_pool::recover_keys( const std::vector<signature>& sigs, const std::vector<sha256>& digests,
+                                                            std::vector<fc::exception_ptr>* errors, bool check_canonical ) {
+      FC_ASSERT( digests.size() == sigs.size() || digests.size() == 1 || sigs.empty(),
+                 "recover_keys given ${d} digests for ${s} signatures", ("d", digests.size())("s", sigs.size()) );
+      std::vector<public_key> results( sigs.size() );
+      if( errors ) {
+         errors->clear();
+         errors->resize( sigs.size() );
+      }
+      if( sigs.empty() )
+         return results;
+
+      detail::key_recovery_batch b;
+      b.sigs = sigs.data();
+      b.digests = digests.data();
+      b.digest_stride = digests.size() == 1 ? 0 : 1;
+      b.size = sigs.size();
+      b.check_canonical = check_canonical;
+      b.results = results.data();
+      b.errors = errors ? errors->data() : nullptr;
+      my->run( b );
+      return results;
+   }
+
+   std::vector<bool> key_recovery_pool::verify_many( const std::vector<public_key>& keys, const std::vector<sha256>& digests,
+                                                     const std::vector<signature>& sigs, bool check_canonical ) {
+      FC_ASSERT( keys.size() == sigs.size() || keys.size() == 1 || sigs.empty(),
+                 "verify_many given ${k} keys for ${s} signatures", ("k", keys.size())("s", sigs.size()) );
+      FC_ASSERT( digests.size() == sigs.size() || digests.size() == 1 || sigs.empty(),
+                 "verify_many given ${d} digests for ${s} signatures", ("d", digests.size())("s", sigs.size()) );
+      if( sigs.empty() )
+         return {};
+
+      // bytes, as threads cannot write neighbouring elements of a vector<bool>
+      std::vector<char> verified( sigs.size() );
+      detail::key_recovery_batch b;
+      b.sigs = sigs.data();
+      b.digests = digests.data();
+      b.digest_stride = digests.size() == 1 ? 0 : 1;
+      b.size = sigs.size();
+      b.check_canonical = check_canonical;
+      b.keys = keys.data();
+      b.key_stride = keys.size() == 1 ? 0 : 1;
+      b.verified = verified.data();
+      my->run( b );
+      return std::vector<bool>( verified.begin(), verified.end() );
+   }
+
+   static key_recovery_pool& shared_pool() {
+      static key_recovery_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+      return pool;
+   }
+
+   std::vector<public_key> recover_keys( const std::vector<signature>& sigs, const std::vector<sha256>& digests,
+                                         std::vector<fc::exception_ptr>* errors, bool check_canonical ) {
+      return shared_pool().recover_keys( sigs, digests, errors, check_canonical );
+   }
+
+   std::vector<bool> verify_many( const std::vector<public_key>& keys, const std::vector<sha256>& digests,
+                                  const std::vector<signature>& sigs, bool check_canonical ) {
+      return shared_pool().verify_many( keys, digests, sigs, check_canonical );
+   }
+
+} } // fc::crypto
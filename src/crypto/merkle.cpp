@@ -0,0 +1,150 @@
+#include <fc/crypto/merkle.hpp>
+#include <fc/exception/exception.hpp>
+#include "_batch_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace fc { namespace merkle {
+
+   namespace detail {
+
+      /// pairs claimed by a thread at a time, a multiple of the eight AVX2 lanes of sha256::hash_pairs
+      constexpr size_t pairs_chunk_size = 2048;
+
+      struct pairs_batch {
+         const sha256*              in = nullptr;
+         sha256*                    out = nullptr;
+         size_t                     size = 0;
+         std::atomic<size_t>        next{0};
+
+         void run() {
+            for( size_t begin = next.fetch_add( pairs_chunk_size ); begin < size;
+                 begin = next.fetch_add( pairs_chunk_size ) ) {
+               const size_t end = std::min( begin + pairs_chunk_size, size );
+               sha256::hash_pairs( in + 2 * begin, end - begin, out + begin );
+            }
+         }
+      };
+
+      /// hashes the pairs of @p level into @p next, the odd last node with itself
+      static void hash_level( std::vector<sha256>& level, std::vector<sha256>& next, thread_pool& pool ) {
+         const bool odd = level.size() % 2;
+         if( odd )
+            level.push_back( level.back() );
+         next.resize( level.size() / 2 );
+         pool.hash_pairs( level.data(), next.size(), next.data() );
+         if( odd )
+            level.pop_back();
+      }
+
+   } // namespace detail
+
+   sha256 proof::root( const sha256& leaf )const {
+      sha256 node = leaf;
+      for( size_t l = 0; l < path.size(); ++l )
+         node = ( index >> l ) & 1 ? sha256::hash_pair( path[l], node ) : sha256::hash_pair( node, path[l] );
+      return node;
+   }
+
+   class thread_pool::impl : public fc::detail::batch_pool<detail::pairs_batch> {
+   public:
+      using batch_pool::batch_pool;
+   };
+
+   thread_pool::thread_pool( size_t num_threads )
+   : my( new impl( num_threads ) )
+   {}
+
+   thread_pool::~thread_pool() {}
+
+   size_t thread_pool::get_num_threads()const {
+      return my->get_num_threads();
+   }
+
+   void thread_pool::hash_pairs( const sha256* in, size_t count, sha256* out ) {
+      if( my->get_num_threads() == 0 || count < 2 * detail::pairs_chunk_size ) {
+         sha256::hash_pairs( in, count, out );
+         return;
+      }
+      detail::pairs_batch b;
+      b.in = in;
+      b.out = out;
+      b.size = count;
+      my->run( b );
+   }
+
+   thread_pool& default_thread_pool() {
+      static thread_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+      return pool;
+   }
+
+   sha256 root( std::vector<sha256> leaves, thread_pool& pool ) {
+      if( leaves.empty() )
+         return sha256();
+      leaves.reserve( leaves.size() + 1 );
+      std::vector<sha256> next;
+      next.reserve( leaves.size() / 2 + 1 );
+      while( leaves.size() > 1 ) {
+         detail::hash_level( leaves, next, pool );
+         std::swap( leaves, next );
+      }
+      return leaves.front();
+   }
+
+   tree::tree( std::vector<sha256> leaves, thread_pool& pool ) {
+      _levels.emplace_back( std::move( leaves ) );
+      while( _levels.back().size() > 1 ) {
+         std::vector<sha256> next;
+         detail::hash_level( _levels.back(), next, pool );
+         _levels.emplace_back( std::move( next ) );
+      }
+   }
+
+   sha256 tree::root()const {
+      return _levels.back().empty() ? sha256() : _levels.back().front();
+   }
+
+   proof tree::get_proof( uint64_t index )const {
+      FC_ASSERT( index < size(), "leaf ${i} of a tree of ${n} leaves", ("i", index)("n", size()) );
+      proof p;
+      p.index = index;
+      for( size_t l = 0; l + 1 < _levels.size(); ++l ) {
+         const auto& level = _levels[l];
+         const uint64_t i = index >> l;
+         p.path.push_back( ( i ^ 1 ) < level.size() ? level[i ^ 1] : level[i] );
+      }
+      return p;
+   }
+
+   void incremental::append( const sha256& leaf ) {
+      sha256 node = leaf;
+      size_t l = 0;
+      for( ; ( _size >> l ) & 1; ++l )
+         node = sha256::hash_pair( _peaks[l], node );
+      if( l == _peaks.size() )
+         _peaks.emplace_back();
+      _peaks[l] = node;
+      ++_size;
+   }
+
+   sha256 incremental::root()const {
+      if( _size == 0 )
+         return sha256();
+      // walk up the right edge; partial is the last node of a level when it is not a complete subtree
+      sha256 partial;
+      bool has_partial = false;
+      for( size_t l = 0; ; ++l ) {
+         const uint64_t nodes = ( ( _size - 1 ) >> l ) + 1;
+         const bool complete = ( _size >> l ) & 1;
+         if( nodes == 1 )
+            return has_partial ? partial : _peaks[l];
+         if( has_partial )
+            partial = complete ? sha256::hash_pair( _peaks[l], partial ) : sha256::hash_pair( partial, partial );
+         else if( complete )
+            partial = sha256::hash_pair( _peaks[l], _peaks[l] );
+         has_partial = has_partial || complete;
+      }
+   }
+
+} } // fc::merkle
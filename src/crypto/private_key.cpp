@@ -39,6 +39,33 @@ namespace fc { namespace crypto {
       return signature(_storage.visit(sign_visitor(digest, require_canonical)));
    }
 
+   struct sign_many_visitor : visitor<std::vector<signature::storage_type>> {
+      sign_many_visitor( const std::vector<sha256>& digests, bool require_canonical )
+      :_digests(digests)
+      ,_require_canonical(require_canonical)
+      {}
+
+      template<typename KeyType>
+      std::vector<signature::storage_type> operator()(const KeyType& key) const
+      {
+         auto sigs = key.sign_many(_digests, _require_canonical);
+         return std::vector<signature::storage_type>(std::make_move_iterator(sigs.begin()), std::make_move_iterator(sigs.end()));
+      }
+
+      const std::vector<sha256>&  _digests;
+      bool                        _require_canonical;
+   };
+
+   std::vector<signature> private_key::sign_many( const std::vector<sha256>& digests, bool require_canonical ) const
+   {
+      auto storage = _storage.visit(sign_many_visitor(digests, require_canonical));
+      std::vector<signature> sigs;
+      sigs.reserve(storage.size());
+      for( auto& s : storage )
+         sigs.emplace_back(signature(std::move(s)));
+      return sigs;
+   }
+
    struct generate_shared_secret_visitor : visitor<sha512> {
       generate_shared_secret_visitor( const public_key::storage_type& pub_storage )
       :_pub_storage(pub_storage)
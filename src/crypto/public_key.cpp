@@ -1,9 +1,105 @@
 #include <fc/crypto/public_key.hpp>
 #include <fc/crypto/common.hpp>
+#include <fc/crypto/string_cache.hpp>
 #include <fc/exception/exception.hpp>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace fc { namespace crypto {
 
+   namespace detail {
+
+      struct recovery_cache_key {
+         signature   sig;
+         sha256      digest;
+         bool        check_canonical = true;
+         size_t      hash = 0;
+
+         recovery_cache_key( const signature& s, const sha256& d, bool c )
+         :sig(s), digest(d), check_canonical(c)
+         {
+            // digests are uniformly distributed, the signature hash only has to separate signatures of one digest
+            hash = ( hash_value( sig ) * 0x9e3779b97f4a7c15ull ) ^ digest._hash[0] ^ ( check_canonical ? 1 : 0 );
+         }
+
+         bool operator==( const recovery_cache_key& o )const {
+            return hash == o.hash && digest == o.digest && check_canonical == o.check_canonical && sig == o.sig;
+         }
+      };
+
+      struct recovery_cache_key_hash {
+         size_t operator()( const recovery_cache_key& k )const { return k.hash; }
+      };
+
+      /// least recently used entries are at the back of the list
+      struct recovery_cache_shard {
+         using entry = std::pair<recovery_cache_key, public_key>;
+
+         std::mutex                  mtx;
+         std::list<entry>            lru;
+         std::unordered_map<recovery_cache_key, std::list<entry>::iterator, recovery_cache_key_hash> index;
+         size_t                      capacity = 0;
+
+         bool get( const recovery_cache_key& k, public_key& out ) {
+            std::lock_guard g( mtx );
+            auto itr = index.find( k );
+            if( itr == index.end() )
+               return false;
+            lru.splice( lru.begin(), lru, itr->second );
+            out = itr->second->second;
+            return true;
+         }
+
+         void put( recovery_cache_key&& k, const public_key& key ) {
+            std::lock_guard g( mtx );
+            if( capacity == 0 || index.count( k ) )
+               return;
+            if( lru.size() >= capacity ) {
+               index.erase( lru.back().first );
+               lru.pop_back();
+            }
+            lru.emplace_front( std::move( k ), key );
+            index.emplace( lru.front().first, lru.begin() );
+         }
+      };
+
+      class recovery_cache {
+      public:
+         static constexpr size_t num_shards = 16;
+
+         static recovery_cache& instance() {
+            static recovery_cache c;
+            return c;
+         }
+
+         recovery_cache_shard& shard_for( const recovery_cache_key& k ) {
+            return shards[( k.hash >> 32 ) % num_shards];
+         }
+
+         /// the first max_entries % num_shards shards hold one more, so the shards sum to exactly max_entries
+         void set_capacity( size_t max_entries ) {
+            for( size_t i = 0; i < num_shards; ++i ) {
+               auto& s = shards[i];
+               std::lock_guard g( s.mtx );
+               s.capacity = max_entries / num_shards + ( i < max_entries % num_shards );
+               s.lru.clear();
+               s.index.clear();
+            }
+            capacity = max_entries;
+            hits = 0;
+            misses = 0;
+         }
+
+         recovery_cache_shard      shards[num_shards];
+         std::atomic<size_t>       capacity{0};
+         std::atomic<uint64_t>     hits{0};
+         std::atomic<uint64_t>     misses{0};
+      };
+
+   } // namespace detail
+
    struct recovery_visitor : fc::visitor<public_key::storage_type> {
       recovery_visitor(const sha256& digest, bool check_canonical)
       :_digest(digest)
@@ -20,8 +116,75 @@ namespace fc { namespace crypto {
    };
 
    public_key::public_key( const signature& c, const sha256& digest, bool check_canonical )
-   :_storage(c._storage.visit(recovery_visitor(digest, check_canonical)))
    {
+      auto& cache = detail::recovery_cache::instance();
+      if( cache.capacity.load( std::memory_order_relaxed ) == 0 ) {
+         _storage = c._storage.visit(recovery_visitor(digest, check_canonical));
+         return;
+      }
+
+      detail::recovery_cache_key k( c, digest, check_canonical );
+      auto& shard = cache.shard_for( k );
+      if( shard.get( k, *this ) ) {
+         cache.hits.fetch_add( 1, std::memory_order_relaxed );
+         return;
+      }
+      cache.misses.fetch_add( 1, std::memory_order_relaxed );
+      _storage = c._storage.visit(recovery_visitor(digest, check_canonical));
+      shard.put( std::move( k ), *this );
+   }
+
+   struct verify_visitor : fc::visitor<bool> {
+      verify_visitor(const public_key::storage_type& key, const sha256& digest, bool check_canonical)
+      :_key(key)
+      ,_digest(digest)
+      ,_check_canonical(check_canonical)
+      {}
+
+      template<typename SignatureType>
+      bool operator()(const SignatureType& s) const {
+         using key_type = typename SignatureType::public_key_type;
+         return _key.contains<key_type>() && s.verify(_key.get<key_type>(), _digest, _check_canonical);
+      }
+
+      const public_key::storage_type& _key;
+      const sha256& _digest;
+      bool _check_canonical;
+   };
+
+   bool verify( const public_key& key, const sha256& digest, const signature& sig, bool check_canonical ) {
+      try {
+         return sig._storage.visit(verify_visitor(key._storage, digest, check_canonical));
+      } catch( const fc::exception& ) {
+         // keys that do not decode
+         return false;
+      } catch( ... ) {
+         // std exceptions from the R1 and WebAuthn paths, or bad_alloc; batch verification runs this on worker
+         // threads, where nothing may escape
+         return false;
+      }
+   }
+
+   void set_recovery_cache_size( size_t max_entries ) {
+      detail::recovery_cache::instance().set_capacity( max_entries );
+   }
+
+   recovery_cache_stats get_recovery_cache_stats() {
+      auto& cache = detail::recovery_cache::instance();
+      recovery_cache_stats stats;
+      stats.hits = cache.hits.load();
+      stats.misses = cache.misses.load();
+      stats.capacity = cache.capacity.load();
+      for( auto& s : cache.shards ) {
+         std::lock_guard g( s.mtx );
+         stats.size += s.lru.size();
+      }
+      return stats;
+   }
+
+   void clear_recovery_cache() {
+      auto& cache = detail::recovery_cache::instance();
+      cache.set_capacity( cache.capacity.load() );
    }
 
    int public_key::which() const {
@@ -57,8 +220,16 @@ namespace fc { namespace crypto {
    }
 
    public_key::public_key(const std::string& base58str)
-   :_storage(parse_base58(base58str))
-   {}
+   {
+      if( !detail::string_cache_enabled() ) {
+         _storage = parse_base58(base58str);
+         return;
+      }
+      if( detail::get_cached_value(base58str, *this) )
+         return;
+      _storage = parse_base58(base58str);
+      detail::cache_value(base58str, *this);
+   }
 
    struct is_valid_visitor : public fc::visitor<bool> {
       template< typename KeyType >
@@ -74,14 +245,22 @@ namespace fc { namespace crypto {
 
    std::string public_key::to_string(const fc::yield_function_t& yield) const
    {
+      const bool cached = detail::string_cache_enabled();
+      std::string str;
+      if( cached && detail::get_cached_string(*this, str) )
+         return str;
+
       auto data_str = _storage.visit(base58str_visitor<storage_type, config::public_key_prefix, 0>(yield));
 
       auto which = _storage.which();
       if (which == 0) {
-         return std::string(config::public_key_legacy_prefix) + data_str;
+         str = std::string(config::public_key_legacy_prefix) + data_str;
       } else {
-         return std::string(config::public_key_base_prefix) + "_" + data_str;
+         str = std::string(config::public_key_base_prefix) + "_" + data_str;
       }
+      if( cached )
+         detail::cache_string(*this, str);
+      return str;
    }
 
    std::ostream& operator<<(std::ostream& s, const public_key& k) {
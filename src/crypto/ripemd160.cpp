@@ -40,6 +40,16 @@ ripemd160::encoder::~encoder() {}
 ripemd160::encoder::encoder() {
   reset();
 }
+ripemd160::encoder::encoder( const encoder& e )
+: my( e.my ), _buffered( e._buffered ) {
+  memcpy( _buffer, e._buffer, _buffered );
+}
+ripemd160::encoder& ripemd160::encoder::operator=( const encoder& e ) {
+  my = e.my;
+  _buffered = e._buffered;
+  memcpy( _buffer, e._buffer, _buffered );
+  return *this;
+}
 
 ripemd160 ripemd160::hash( const fc::sha512& h )
 {
@@ -58,15 +68,31 @@ ripemd160 ripemd160::hash( const string& s ) {
   return hash( s.c_str(), s.size() );
 }
 
-void ripemd160::encoder::write( const char* d, uint32_t dlen ) {
-  RIPEMD160_Update( &my->ctx, d, dlen);
+void ripemd160::encoder::write_blocks( const char* d, uint32_t dlen ) {
+  if( _buffered ) {
+    // complete the staged block
+    const uint32_t n = sizeof(_buffer) - _buffered;
+    memcpy( _buffer + _buffered, d, n );
+    RIPEMD160_Update( &my->ctx, _buffer, sizeof(_buffer) );
+    _buffered = 0;
+    d += n;
+    dlen -= n;
+  }
+  if( dlen < sizeof(_buffer) ) {
+    memcpy( _buffer, d, dlen );
+    _buffered = dlen;
+  } else
+    RIPEMD160_Update( &my->ctx, d, dlen );
 }
 ripemd160 ripemd160::encoder::result() {
+  RIPEMD160_Update( &my->ctx, _buffer, _buffered );
+  _buffered = 0;
   ripemd160 h;
   RIPEMD160_Final((uint8_t*)h.data(), &my->ctx );
   return h;
 }
 void ripemd160::encoder::reset() {
+  _buffered = 0;
   RIPEMD160_Init( &my->ctx);
 }
 
@@ -32,6 +32,11 @@ namespace fc {
     sha224::encoder::encoder() {
       reset();
     }
+    sha224::encoder::encoder( const encoder& e ) : my( e.my ) {}
+    sha224::encoder& sha224::encoder::operator=( const encoder& e ) {
+      my = e.my;
+      return *this;
+    }
 
     sha224 sha224::hash( const char* d, uint32_t dlen ) {
       encoder e;
@@ -39,6 +39,16 @@ namespace fc {
     sha256::encoder::encoder() {
       reset();
     }
+    sha256::encoder::encoder( const encoder& e )
+    : my( e.my ), _buffered( e._buffered ) {
+      memcpy( _buffer, e._buffer, _buffered );
+    }
+    sha256::encoder& sha256::encoder::operator=( const encoder& e ) {
+      my = e.my;
+      _buffered = e._buffered;
+      memcpy( _buffer, e._buffer, _buffered );
+      return *this;
+    }
 
     sha256 sha256::hash( const char* d, uint32_t dlen ) {
       encoder e;
@@ -55,15 +65,31 @@ namespace fc {
         return hash( s.data(), sizeof( s._hash ) );
     }
 
-    void sha256::encoder::write( const char* d, uint32_t dlen ) {
-      SHA256_Update( &my->ctx, d, dlen);
+    void sha256::encoder::write_blocks( const char* d, uint32_t dlen ) {
+      if( _buffered ) {
+        // complete the staged block
+        const uint32_t n = sizeof(_buffer) - _buffered;
+        memcpy( _buffer + _buffered, d, n );
+        SHA256_Update( &my->ctx, _buffer, sizeof(_buffer) );
+        _buffered = 0;
+        d += n;
+        dlen -= n;
+      }
+      if( dlen < sizeof(_buffer) ) {
+        memcpy( _buffer, d, dlen );
+        _buffered = dlen;
+      } else
+        SHA256_Update( &my->ctx, d, dlen );
     }
     sha256 sha256::encoder::result() {
+      SHA256_Update( &my->ctx, _buffer, _buffered );
+      _buffered = 0;
       sha256 h;
       SHA256_Final((uint8_t*)h.data(), &my->ctx );
       return h;
     }
     void sha256::encoder::reset() {
+      _buffered = 0;
       SHA256_Init( &my->ctx);
     }
 
@@ -0,0 +1,432 @@
+#include <fc/crypto/sha256.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+#define FC_SHA256_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+/* Batch SHA-256 without the per message SHA256_Init/Update/Final of sha256::encoder: the padding of the last
+ * blocks is built on the stack and the blocks go straight to the compression function. On CPUs with the SHA
+ * extensions two messages at a time run on sha256rnds2, otherwise AVX2 compresses eight messages with the same
+ * number of blocks side by side, one per 32 bit lane. Anything else falls back to sha256::hash.
+ */
+
+namespace fc {
+
+   namespace detail {
+
+      static constexpr uint32_t sha256_k[64] = {
+         0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+         0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+         0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+         0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+         0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+         0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+         0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+         0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+      };
+
+      static constexpr uint32_t sha256_init[8] = {
+         0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+      };
+
+      static constexpr uint32_t rotr( uint32_t x, int n ) { return ( x >> n ) | ( x << ( 32 - n ) ); }
+
+      /// K + W of the block that follows a 64 byte message: 0x80, zeros and the bit length 512
+      struct pair_padding {
+         alignas(32) uint32_t wk[64] = {};
+
+         constexpr pair_padding() {
+            uint32_t w[64] = { 0x80000000 };
+            w[15] = 512;
+            for( int t = 16; t < 64; ++t ) {
+               const uint32_t s0 = rotr( w[t-15], 7 ) ^ rotr( w[t-15], 18 ) ^ ( w[t-15] >> 3 );
+               const uint32_t s1 = rotr( w[t-2], 17 ) ^ rotr( w[t-2], 19 ) ^ ( w[t-2] >> 10 );
+               w[t] = w[t-16] + s0 + w[t-7] + s1;
+            }
+            for( int t = 0; t < 64; ++t )
+               wk[t] = w[t] + sha256_k[t];
+         }
+      };
+      static constexpr pair_padding sha256_pair_padding{};
+
+      /// the padded tail of a message, one or two blocks
+      struct sha256_tail {
+         alignas(16) unsigned char data[128];
+         size_t                    blocks;
+         size_t                    full;   ///< whole blocks of the message before the tail
+
+         void set( const char* msg, size_t size ) {
+            const size_t rest = size % 64;
+            full = size / 64;
+            blocks = rest < 56 ? 1 : 2;
+            if( rest )
+               memcpy( data, msg + size - rest, rest );
+            memset( data + rest, 0, blocks * 64 - rest );
+            data[rest] = 0x80;
+            const uint64_t bits = uint64_t( size ) * 8;
+            for( int i = 0; i < 8; ++i )
+               data[blocks * 64 - 1 - i] = uint8_t( bits >> ( 8 * i ) );
+         }
+      };
+
+      static inline void store_digest( const uint32_t state[8], sha256& out ) {
+         unsigned char* p = (unsigned char*) out.data();
+         for( int i = 0; i < 8; ++i ) {
+            p[4*i]   = uint8_t( state[i] >> 24 );
+            p[4*i+1] = uint8_t( state[i] >> 16 );
+            p[4*i+2] = uint8_t( state[i] >> 8 );
+            p[4*i+3] = uint8_t( state[i] );
+         }
+      }
+
+#ifdef FC_SHA256_X86
+
+      static bool cpu_has_sha_ni() {
+         unsigned int eax, ebx, ecx, edx;
+         if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+            return false;
+         const bool ssse3 = ecx & ( 1u << 9 ), sse41 = ecx & ( 1u << 19 );
+         if( !ssse3 || !sse41 || !__get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) )
+            return false;
+         return ebx & ( 1u << 29 );
+      }
+
+      static bool cpu_has_avx2() {
+         __builtin_cpu_init();
+         return __builtin_cpu_supports( "avx2" );
+      }
+
+      /**
+       * One block of each of @p N independent messages, interleaved so that the dependent sha256rnds2 chains
+       * overlap. state is a b c d e f g h; the rounds use the precomputed @p wk instead of @p data when given.
+       */
+      template<int N>
+      __attribute__((target("sha,sse4.1,ssse3")))
+      static void compress_sha_ni( uint32_t* const state[N], const unsigned char* const data[N], const uint32_t* wk = nullptr ) {
+         const __m128i mask = _mm_set_epi64x( 0x0c0d0e0f08090a0bull, 0x0405060700010203ull );
+         __m128i state0[N], state1[N], abef[N], cdgh[N], m[N][4];
+
+         for( int n = 0; n < N; ++n ) {
+            const __m128i tmp = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) &state[n][0] ), 0xb1 );   // c d a b
+            state1[n] = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i*) &state[n][4] ), 0x1b );          // e f g h
+            state0[n] = _mm_alignr_epi8( tmp, state1[n], 8 );                                                   // a b e f
+            state1[n] = _mm_blend_epi16( state1[n], tmp, 0xf0 );                                                // c d g h
+            abef[n] = state0[n];
+            cdgh[n] = state1[n];
+            if( !wk )
+               for( int i = 0; i < 4; ++i )
+                  m[n][i] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*) ( data[n] + 16 * i ) ), mask );
+         }
+
+#pragma GCC unroll 16
+         for( int i = 0; i < 16; ++i ) {
+            const __m128i k = wk ? _mm_load_si128( (const __m128i*) &wk[4*i] )
+                                 : _mm_loadu_si128( (const __m128i*) &sha256_k[4*i] );
+            for( int n = 0; n < N; ++n ) {
+               __m128i msg = wk ? k : _mm_add_epi32( m[n][i&3], k );
+               state1[n] = _mm_sha256rnds2_epu32( state1[n], state0[n], msg );
+               msg = _mm_shuffle_epi32( msg, 0x0e );
+               state0[n] = _mm_sha256rnds2_epu32( state0[n], state1[n], msg );
+               if( !wk && i < 12 ) {
+                  // W[4i+16..4i+19] from W[4i..4i+15]
+                  const __m128i t = _mm_add_epi32( _mm_sha256msg1_epu32( m[n][i&3], m[n][(i+1)&3] ),
+                                                   _mm_alignr_epi8( m[n][(i+3)&3], m[n][(i+2)&3], 4 ) );
+                  m[n][i&3] = _mm_sha256msg2_epu32( t, m[n][(i+3)&3] );
+               }
+            }
+         }
+
+         for( int n = 0; n < N; ++n ) {
+            const __m128i tmp = _mm_shuffle_epi32( _mm_add_epi32( state0[n], abef[n] ), 0x1b );       // f e b a
+            const __m128i cdgh_sum = _mm_shuffle_epi32( _mm_add_epi32( state1[n], cdgh[n] ), 0xb1 );  // d c h g
+            _mm_storeu_si128( (__m128i*) &state[n][0], _mm_blend_epi16( tmp, cdgh_sum, 0xf0 ) );      // d c b a
+            _mm_storeu_si128( (__m128i*) &state[n][4], _mm_alignr_epi8( cdgh_sum, tmp, 8 ) );         // h g f e
+         }
+      }
+
+      /// one or two messages, the blocks both of them have are compressed together
+      static void hash_sha_ni( const std::pair<const char*, size_t>* msgs, size_t count, sha256* out ) {
+         sha256_tail tails[2];
+         uint32_t states[2][8];
+         size_t blocks[2] = {};
+         for( size_t i = 0; i < count; ++i ) {
+            tails[i].set( msgs[i].first, msgs[i].second );
+            blocks[i] = tails[i].full + tails[i].blocks;
+            memcpy( states[i], sha256_init, sizeof(states[i]) );
+         }
+         auto block = [&]( size_t i, size_t b ) {
+            const size_t full = tails[i].full;
+            return b < full ? (const unsigned char*) msgs[i].first + 64 * b : tails[i].data + 64 * ( b - full );
+         };
+
+         const size_t both = count == 2 ? std::min( blocks[0], blocks[1] ) : 0;
+         uint32_t* const s[2] = { states[0], states[1] };
+         for( size_t b = 0; b < both; ++b ) {
+            const unsigned char* const d[2] = { block( 0, b ), block( 1, b ) };
+            compress_sha_ni<2>( s, d );
+         }
+         for( size_t i = 0; i < count; ++i ) {
+            for( size_t b = both; b < blocks[i]; ++b ) {
+               const unsigned char* const d[1] = { block( i, b ) };
+               compress_sha_ni<1>( &s[i], d );
+            }
+            store_digest( states[i], out[i] );
+         }
+      }
+
+      /// @p count of one or two pairs of @p in, the inputs are read before any output is written
+      static void hash_pairs_sha_ni( const sha256* in, size_t count, sha256* out ) {
+         uint32_t states[2][8];
+         const unsigned char* d[2];
+         for( size_t i = 0; i < count; ++i ) {
+            memcpy( states[i], sha256_init, sizeof(states[i]) );
+            d[i] = (const unsigned char*) in[2 * i].data();   // a and b are adjacent
+         }
+         uint32_t* const s[2] = { states[0], states[1] };
+         if( count == 2 ) {
+            compress_sha_ni<2>( s, d );
+            compress_sha_ni<2>( s, d, sha256_pair_padding.wk );
+         } else {
+            compress_sha_ni<1>( s, d );
+            compress_sha_ni<1>( s, d, sha256_pair_padding.wk );
+         }
+         for( size_t i = 0; i < count; ++i )
+            store_digest( states[i], out[i] );
+      }
+
+      namespace avx2 {
+
+#define FC_SHA256_AVX2 __attribute__((target("avx2")))
+
+         FC_SHA256_AVX2 static inline __m256i rotr( __m256i x, int n ) {
+            return _mm256_or_si256( _mm256_srli_epi32( x, n ), _mm256_slli_epi32( x, 32 - n ) );
+         }
+
+         FC_SHA256_AVX2 static inline __m256i load_be32( const unsigned char* const p[8], int offset ) {
+            auto be = [&]( int lane ) {
+               uint32_t v;
+               memcpy( &v, p[lane] + offset, 4 );
+               return int( __builtin_bswap32( v ) );
+            };
+            return _mm256_set_epi32( be(7), be(6), be(5), be(4), be(3), be(2), be(1), be(0) );
+         }
+
+         FC_SHA256_AVX2 static inline void sha_round( __m256i s[8], int t, __m256i wk ) {
+            __m256i &a = s[(64-t)&7], &b = s[(65-t)&7], &c = s[(66-t)&7], &d = s[(67-t)&7],
+                    &e = s[(68-t)&7], &f = s[(69-t)&7], &g = s[(70-t)&7], &h = s[(71-t)&7];
+            const __m256i s1 = _mm256_xor_si256( _mm256_xor_si256( rotr( e, 6 ), rotr( e, 11 ) ), rotr( e, 25 ) );
+            const __m256i ch = _mm256_xor_si256( _mm256_and_si256( e, f ), _mm256_andnot_si256( e, g ) );
+            const __m256i t1 = _mm256_add_epi32( _mm256_add_epi32( _mm256_add_epi32( h, s1 ), ch ), wk );
+            const __m256i s0 = _mm256_xor_si256( _mm256_xor_si256( rotr( a, 2 ), rotr( a, 13 ) ), rotr( a, 22 ) );
+            const __m256i maj = _mm256_or_si256( _mm256_and_si256( a, b ), _mm256_and_si256( c, _mm256_or_si256( a, b ) ) );
+            d = _mm256_add_epi32( d, t1 );
+            h = _mm256_add_epi32( t1, _mm256_add_epi32( s0, maj ) );   // the next a
+         }
+
+         /// one block of each of the eight lanes, @p blocks[lane] or the precomputed @p wk of every lane
+         FC_SHA256_AVX2 static void compress( __m256i state[8], const unsigned char* const blocks[8], const uint32_t* wk = nullptr ) {
+            __m256i s[8];
+            for( int i = 0; i < 8; ++i )
+               s[i] = state[i];
+
+            if( wk ) {
+#pragma GCC unroll 64
+               for( int t = 0; t < 64; ++t )
+                  sha_round( s, t, _mm256_set1_epi32( int( wk[t] ) ) );
+            } else {
+               __m256i w[16];
+#pragma GCC unroll 16
+               for( int t = 0; t < 16; ++t ) {
+                  w[t] = load_be32( blocks, 4 * t );
+                  sha_round( s, t, _mm256_add_epi32( w[t], _mm256_set1_epi32( int( sha256_k[t] ) ) ) );
+               }
+#pragma GCC unroll 48
+               for( int t = 16; t < 64; ++t ) {
+                  const __m256i w15 = w[(t-15)&15], w2 = w[(t-2)&15];
+                  const __m256i s0 = _mm256_xor_si256( _mm256_xor_si256( rotr( w15, 7 ), rotr( w15, 18 ) ), _mm256_srli_epi32( w15, 3 ) );
+                  const __m256i s1 = _mm256_xor_si256( _mm256_xor_si256( rotr( w2, 17 ), rotr( w2, 19 ) ), _mm256_srli_epi32( w2, 10 ) );
+                  w[t&15] = _mm256_add_epi32( _mm256_add_epi32( w[t&15], s0 ), _mm256_add_epi32( w[(t-7)&15], s1 ) );
+                  sha_round( s, t, _mm256_add_epi32( w[t&15], _mm256_set1_epi32( int( sha256_k[t] ) ) ) );
+               }
+            }
+
+            // after 64 rounds the roles are back where they started
+            for( int i = 0; i < 8; ++i )
+               state[i] = _mm256_add_epi32( state[i], s[i] );
+         }
+
+         FC_SHA256_AVX2 static void init( __m256i state[8] ) {
+            for( int i = 0; i < 8; ++i )
+               state[i] = _mm256_set1_epi32( int( sha256_init[i] ) );
+         }
+
+         FC_SHA256_AVX2 static void store( const __m256i state[8], sha256* const out[8] ) {
+            alignas(32) uint32_t words[8][8];
+            for( int i = 0; i < 8; ++i )
+               _mm256_store_si256( (__m256i*) words[i], state[i] );
+            for( int lane = 0; lane < 8; ++lane ) {
+               uint32_t digest[8];
+               for( int i = 0; i < 8; ++i )
+                  digest[i] = words[i][lane];
+               store_digest( digest, *out[lane] );
+            }
+         }
+
+#undef FC_SHA256_AVX2
+
+      } // namespace avx2
+
+      /// eight messages with the same number of blocks
+      __attribute__((target("avx2")))
+      static void hash_avx2( const std::pair<const char*, size_t>* msgs, sha256* out ) {
+         sha256_tail tails[8];
+         for( int lane = 0; lane < 8; ++lane )
+            tails[lane].set( msgs[lane].first, msgs[lane].second );
+
+         const size_t blocks = tails[0].full + tails[0].blocks;
+         __m256i state[8];
+         avx2::init( state );
+         for( size_t b = 0; b < blocks; ++b ) {
+            const unsigned char* p[8];
+            for( int lane = 0; lane < 8; ++lane ) {
+               const size_t full = tails[lane].full;
+               p[lane] = b < full ? (const unsigned char*) msgs[lane].first + 64 * b : tails[lane].data + 64 * ( b - full );
+            }
+            avx2::compress( state, p );
+         }
+         sha256* o[8];
+         for( int lane = 0; lane < 8; ++lane )
+            o[lane] = &out[lane];
+         avx2::store( state, o );
+      }
+
+      /// eight pairs of @p in, the inputs are read before any output is written
+      __attribute__((target("avx2")))
+      static void hash_pairs_avx2( const sha256* in, sha256* out ) {
+         const unsigned char* p[8];
+         for( int lane = 0; lane < 8; ++lane )
+            p[lane] = (const unsigned char*) in[2 * lane].data();   // a and b are adjacent
+         __m256i state[8];
+         avx2::init( state );
+         avx2::compress( state, p );
+         avx2::compress( state, nullptr, sha256_pair_padding.wk );
+         sha256* o[8];
+         for( int lane = 0; lane < 8; ++lane )
+            o[lane] = &out[lane];
+         avx2::store( state, o );
+      }
+
+#endif // FC_SHA256_X86
+
+      static bool backend_supported( sha256::batch_backend b ) {
+         switch( b ) {
+            case sha256::batch_backend::openssl:
+               return true;
+#ifdef FC_SHA256_X86
+            case sha256::batch_backend::avx2:
+               return cpu_has_avx2();
+            case sha256::batch_backend::sha_ni:
+               return cpu_has_sha_ni();
+#endif
+            default:
+               return false;
+         }
+      }
+
+      static sha256::batch_backend detect_backend() {
+         if( backend_supported( sha256::batch_backend::sha_ni ) )
+            return sha256::batch_backend::sha_ni;
+         if( backend_supported( sha256::batch_backend::avx2 ) )
+            return sha256::batch_backend::avx2;
+         return sha256::batch_backend::openssl;
+      }
+
+      static std::atomic<sha256::batch_backend>& batch_backend() {
+         static std::atomic<sha256::batch_backend> b{ detect_backend() };
+         return b;
+      }
+
+   } // namespace detail
+
+   sha256::batch_backend sha256::get_batch_backend() {
+      return detail::batch_backend().load( std::memory_order_relaxed );
+   }
+
+   bool sha256::set_batch_backend( batch_backend b ) {
+      if( !detail::backend_supported( b ) )
+         return false;
+      detail::batch_backend() = b;
+      return true;
+   }
+
+   void sha256::hash_many( const std::pair<const char*, size_t>* messages, size_t count, sha256* out ) {
+      const batch_backend b = get_batch_backend();
+      size_t i = 0;
+#ifdef FC_SHA256_X86
+      if( b == batch_backend::sha_ni ) {
+         for( ; i < count; i += 2 )
+            detail::hash_sha_ni( messages + i, std::min<size_t>( count - i, 2 ), out + i );
+         return;
+      }
+      if( b == batch_backend::avx2 ) {
+         auto blocks = []( size_t size ) { return ( size + 9 + 63 ) / 64; };
+         while( i + 8 <= count ) {
+            const size_t n = blocks( messages[i].second );
+            bool same = true;
+            for( size_t lane = 1; lane < 8 && same; ++lane )
+               same = blocks( messages[i + lane].second ) == n;
+            if( same ) {
+               detail::hash_avx2( messages + i, out + i );
+               i += 8;
+            } else {
+               out[i] = hash( messages[i].first, messages[i].second );
+               ++i;
+            }
+         }
+      }
+#endif
+      for( ; i < count; ++i )
+         out[i] = hash( messages[i].first, messages[i].second );
+   }
+
+   sha256 sha256::hash_pair( const sha256& a, const sha256& b ) {
+      sha256 result;
+#ifdef FC_SHA256_X86
+      if( get_batch_backend() == batch_backend::sha_ni ) {
+         const sha256 in[2] = { a, b };
+         detail::hash_pairs_sha_ni( in, 1, &result );
+         return result;
+      }
+#endif
+      encoder e;
+      e.write( a.data(), a.data_size() );
+      e.write( b.data(), b.data_size() );
+      return e.result();
+   }
+
+   void sha256::hash_pairs( const sha256* in, size_t count, sha256* out ) {
+      size_t i = 0;
+#ifdef FC_SHA256_X86
+      const batch_backend b = get_batch_backend();
+      if( b == batch_backend::sha_ni ) {
+         for( ; i < count; i += 2 )
+            detail::hash_pairs_sha_ni( in + 2 * i, std::min<size_t>( count - i, 2 ), out + i );
+         return;
+      }
+      if( b == batch_backend::avx2 ) {
+         for( ; i + 8 <= count; i += 8 )
+            detail::hash_pairs_avx2( in + 2 * i, out + i );
+      }
+#endif
+      for( ; i < count; ++i )
+         out[i] = hash_pair( in[2 * i], in[2 * i + 1] );
+   }
+
+} // namespace fc
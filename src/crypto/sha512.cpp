@@ -32,6 +32,16 @@ namespace fc {
     sha512::encoder::encoder() {
       reset();
     }
+    sha512::encoder::encoder( const encoder& e )
+    : my( e.my ), _buffered( e._buffered ) {
+      memcpy( _buffer, e._buffer, _buffered );
+    }
+    sha512::encoder& sha512::encoder::operator=( const encoder& e ) {
+      my = e.my;
+      _buffered = e._buffered;
+      memcpy( _buffer, e._buffer, _buffered );
+      return *this;
+    }
 
     sha512 sha512::hash( const char* d, uint32_t dlen ) {
       encoder e;
@@ -42,15 +52,31 @@ namespace fc {
       return hash( s.c_str(), s.size() );
     }
 
-    void sha512::encoder::write( const char* d, uint32_t dlen ) {
-      SHA512_Update( &my->ctx, d, dlen);
+    void sha512::encoder::write_blocks( const char* d, uint32_t dlen ) {
+      if( _buffered ) {
+        // complete the staged block
+        const uint32_t n = sizeof(_buffer) - _buffered;
+        memcpy( _buffer + _buffered, d, n );
+        SHA512_Update( &my->ctx, _buffer, sizeof(_buffer) );
+        _buffered = 0;
+        d += n;
+        dlen -= n;
+      }
+      if( dlen < sizeof(_buffer) ) {
+        memcpy( _buffer, d, dlen );
+        _buffered = dlen;
+      } else
+        SHA512_Update( &my->ctx, d, dlen );
     }
     sha512 sha512::encoder::result() {
+      SHA512_Update( &my->ctx, _buffer, _buffered );
+      _buffered = 0;
       sha512 h;
       SHA512_Final((uint8_t*)h.data(), &my->ctx );
       return h;
     }
     void sha512::encoder::reset() {
+      _buffered = 0;
       SHA512_Init( &my->ctx);
     }
 
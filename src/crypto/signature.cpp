@@ -1,5 +1,6 @@
 #include <fc/crypto/signature.hpp>
 #include <fc/crypto/common.hpp>
+#include <fc/crypto/string_cache.hpp>
 #include <fc/exception/exception.hpp>
 
 namespace fc { namespace crypto {
@@ -32,8 +33,16 @@ namespace fc { namespace crypto {
    } FC_RETHROW_EXCEPTIONS( warn, "error parsing signature", ("str", base58str ) ) }
 
    signature::signature(const std::string& base58str)
-      :_storage(parse_base58(base58str))
-   {}
+   {
+      if( !detail::string_cache_enabled() ) {
+         _storage = parse_base58(base58str);
+         return;
+      }
+      if( detail::get_cached_value(base58str, *this) )
+         return;
+      _storage = parse_base58(base58str);
+      detail::cache_value(base58str, *this);
+   }
 
    int signature::which() const {
       return _storage.which();
@@ -55,9 +64,17 @@ namespace fc { namespace crypto {
 
    std::string signature::to_string(const fc::yield_function_t& yield) const
    {
+      const bool cached = detail::string_cache_enabled();
+      std::string str;
+      if( cached && detail::get_cached_string(*this, str) )
+         return str;
+
       auto data_str = _storage.visit(base58str_visitor<storage_type, config::signature_prefix>(yield));
       yield();
-      return std::string(config::signature_base_prefix) + "_" + data_str;
+      str = std::string(config::signature_base_prefix) + "_" + data_str;
+      if( cached )
+         detail::cache_string(*this, str);
+      return str;
    }
 
    std::ostream& operator<<(std::ostream& s, const signature& k) {
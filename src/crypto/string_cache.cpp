@@ -0,0 +1,234 @@
+#include <fc/crypto/string_cache.hpp>
+#include <fc/crypto/fast_hash.hpp>
+#include <fc/io/raw.hpp>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace fc { namespace crypto {
+
+   namespace detail {
+
+      /// hash of the packed value, on the stack for keys and K1/R1 signatures
+      template<typename T>
+      static size_t packed_hash( const T& v ) {
+         const size_t size = fc::raw::pack_size( v );
+         char buf[128];
+         if( size <= sizeof(buf) ) {
+            fc::datastream<char*> ds( buf, size );
+            fc::raw::pack( ds, v );
+            return fc::fast_hash64( buf, size );
+         }
+         const auto packed = fc::raw::pack( v );
+         return fc::fast_hash64( packed.data(), packed.size() );
+      }
+
+      template<typename T>
+      struct string_cache_key {
+         T        value;
+         size_t   hash = 0;
+
+         explicit string_cache_key( const T& v )
+         :value(v), hash(packed_hash(v))
+         {}
+
+         bool operator==( const string_cache_key& o )const {
+            return hash == o.hash && value == o.value;
+         }
+      };
+
+      struct string_cache_hash {
+         template<typename T>
+         size_t operator()( const string_cache_key<T>& k )const { return k.hash; }
+         size_t operator()( std::string_view s )const { return fc::fast_hash64( s.data(), s.size() ); }
+      };
+
+      /// one direction of the cache, least recently used entries are at the back of the list
+      template<typename Key, typename Value, typename IndexKey>
+      struct string_cache_lru {
+         using entry = std::pair<Key, Value>;
+
+         std::list<entry>                                                           lru;
+         std::unordered_map<IndexKey, typename std::list<entry>::iterator, string_cache_hash> index;
+
+         template<typename K>
+         bool get( const K& k, Value& out ) {
+            auto itr = index.find( k );
+            if( itr == index.end() )
+               return false;
+            lru.splice( lru.begin(), lru, itr->second );
+            out = itr->second->second;
+            return true;
+         }
+
+         template<typename K>
+         void put( K&& k, const Value& v, size_t capacity ) {
+            if( capacity == 0 || index.count( k ) )
+               return;
+            if( lru.size() >= capacity ) {
+               index.erase( IndexKey( lru.back().first ) );
+               lru.pop_back();
+            }
+            lru.emplace_front( std::forward<K>( k ), v );
+            // the string index refers to the string in the list node, which does not move
+            index.emplace( IndexKey( lru.front().first ), lru.begin() );
+         }
+
+         void clear() {
+            index.clear();
+            lru.clear();
+         }
+      };
+
+      template<typename T>
+      struct string_cache_shard {
+         std::mutex                                                                        mtx;
+         string_cache_lru<string_cache_key<T>, std::string, string_cache_key<T>>          to_string;
+         string_cache_lru<std::string, T, std::string_view>                               from_string;
+         size_t                                                                            capacity = 0;
+      };
+
+      template<typename T>
+      class string_cache {
+      public:
+         static constexpr size_t num_shards = 16;
+
+         string_cache_shard<T>& shard_for( size_t hash ) {
+            return shards[( hash >> 32 ) % num_shards];
+         }
+
+         bool get_string( const T& v, std::string& str ) {
+            string_cache_key<T> k( v );
+            auto& s = shard_for( k.hash );
+            std::lock_guard g( s.mtx );
+            return s.to_string.get( k, str );
+         }
+
+         void put_string( const T& v, const std::string& str ) {
+            string_cache_key<T> k( v );
+            auto& s = shard_for( k.hash );
+            std::lock_guard g( s.mtx );
+            s.to_string.put( std::move( k ), str, s.capacity );
+         }
+
+         bool get_value( const std::string& str, T& out ) {
+            auto& s = shard_for( string_cache_hash()( str ) );
+            std::lock_guard g( s.mtx );
+            return s.from_string.get( std::string_view( str ), out );
+         }
+
+         void put_value( const std::string& str, const T& v ) {
+            auto& s = shard_for( string_cache_hash()( str ) );
+            std::lock_guard g( s.mtx );
+            s.from_string.put( str, v, s.capacity );
+         }
+
+         /// the first max_entries % num_shards shards hold one more, so the shards sum to exactly max_entries
+         void set_capacity( size_t max_entries ) {
+            for( size_t i = 0; i < num_shards; ++i ) {
+               auto& s = shards[i];
+               std::lock_guard g( s.mtx );
+               s.capacity = max_entries / num_shards + ( i < max_entries % num_shards );
+               s.to_string.clear();
+               s.from_string.clear();
+            }
+         }
+
+         uint64_t size() {
+            uint64_t n = 0;
+            for( auto& s : shards ) {
+               std::lock_guard g( s.mtx );
+               n += s.to_string.lru.size() + s.from_string.lru.size();
+            }
+            return n;
+         }
+
+         string_cache_shard<T>     shards[num_shards];
+      };
+
+      struct string_caches {
+         static string_caches& instance() {
+            static string_caches c;
+            return c;
+         }
+
+         string_cache<public_key>   public_keys;
+         string_cache<signature>    signatures;
+         std::atomic<size_t>        capacity{0};
+         std::atomic<uint64_t>      hits{0};
+         std::atomic<uint64_t>      misses{0};
+
+         bool count( bool hit ) {
+            ( hit ? hits : misses ).fetch_add( 1, std::memory_order_relaxed );
+            return hit;
+         }
+      };
+
+      bool string_cache_enabled() {
+         return string_caches::instance().capacity.load( std::memory_order_relaxed ) != 0;
+      }
+
+      bool get_cached_string( const public_key& k, std::string& str ) {
+         auto& c = string_caches::instance();
+         return c.count( c.public_keys.get_string( k, str ) );
+      }
+
+      bool get_cached_string( const signature& s, std::string& str ) {
+         auto& c = string_caches::instance();
+         return c.count( c.signatures.get_string( s, str ) );
+      }
+
+      void cache_string( const public_key& k, const std::string& str ) {
+         string_caches::instance().public_keys.put_string( k, str );
+      }
+
+      void cache_string( const signature& s, const std::string& str ) {
+         string_caches::instance().signatures.put_string( s, str );
+      }
+
+      bool get_cached_value( const std::string& str, public_key& out ) {
+         auto& c = string_caches::instance();
+         return c.count( c.public_keys.get_value( str, out ) );
+      }
+
+      bool get_cached_value( const std::string& str, signature& out ) {
+         auto& c = string_caches::instance();
+         return c.count( c.signatures.get_value( str, out ) );
+      }
+
+      void cache_value( const std::string& str, const public_key& k ) {
+         string_caches::instance().public_keys.put_value( str, k );
+      }
+
+      void cache_value( const std::string& str, const signature& s ) {
+         string_caches::instance().signatures.put_value( str, s );
+      }
+
+   } // namespace detail
+
+   void set_string_cache_size( size_t max_entries ) {
+      auto& c = detail::string_caches::instance();
+      c.public_keys.set_capacity( max_entries );
+      c.signatures.set_capacity( max_entries );
+      c.capacity = max_entries;
+      c.hits = 0;
+      c.misses = 0;
+   }
+
+   string_cache_stats get_string_cache_stats() {
+      auto& c = detail::string_caches::instance();
+      string_cache_stats stats;
+      stats.hits = c.hits.load();
+      stats.misses = c.misses.load();
+      stats.capacity = c.capacity.load();
+      stats.size = c.public_keys.size() + c.signatures.size();
+      return stats;
+   }
+
+   void clear_string_cache() {
+      set_string_cache_size( detail::string_caches::instance().capacity.load() );
+   }
+
+} } // fc::crypto
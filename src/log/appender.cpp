@@ -2,6 +2,8 @@
 #include <fc/log/console_appender.hpp>
 #include <fc/log/gelf_appender.hpp>
 #include <fc/log/dmlog_appender.hpp>
+#include <fc/log/binary_appender.hpp>
+#include <fc/log/file_appender.hpp>
 #include <fc/log/logger_config.hpp>
 
 
@@ -10,6 +12,8 @@ namespace fc {
    static bool reg_console_appender = log_config::register_appender<console_appender>( "console" );
    static bool reg_gelf_appender = log_config::register_appender<gelf_appender>( "gelf" );
    static bool reg_dmlog_appender = log_config::register_appender<dmlog_appender>( "dmlog" );
+   static bool reg_binary_appender = log_config::register_appender<binary_appender>( "binary" );
+   static bool reg_file_appender = log_config::register_appender<file_appender>( "file" );
 
 
 } // namespace fc
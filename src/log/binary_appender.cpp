@@ -0,0 +1,344 @@
+#include <fc/log/binary_appender.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/io/cfile.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_variant.hpp>
+#include <fc/crypto/fast_hash.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/exception/exception.hpp>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace fc {
+
+   namespace detail {
+
+      /**
+       *  Header at the start of the ring file. Records live in [data_offset, data_offset + capacity), each
+       *  prefixed by its uint32_t size. A zero size, or less than 4 bytes left before the end of the data,
+       *  marks where the writer wrapped back to the start.
+       */
+      struct binary_log_header {
+         static constexpr char     magic_value[8] = "FCBLOG1";
+         static constexpr uint32_t current_version = 1;
+         static constexpr uint64_t data_offset = 4096;
+
+         char      magic[8];
+         uint32_t  version;
+         uint32_t  reserved;
+         uint64_t  capacity;   ///< size of the record area
+         uint64_t  head;       ///< offset the next record is written at
+         uint64_t  tail;       ///< offset of the oldest record, valid when records > 0
+         uint64_t  records;    ///< records currently in the ring
+         uint64_t  dropped;    ///< records larger than the ring that were not written
+      };
+      constexpr char binary_log_header::magic_value[8];
+
+      static fc::path binary_log_sites_path( const fc::path& file ) {
+         return file.generic_string() + ".sites";
+      }
+
+      static uint32_t read_record_size( const char* data, uint64_t pos ) {
+         uint32_t s;
+         memcpy( &s, data + pos, sizeof(s) );
+         return s;
+      }
+
+      /// appends to a reused buffer, so packing a record allocates only while the buffer grows
+      struct binary_log_buffer {
+         std::vector<char>& v;
+         bool write( const char* d, size_t s ) { v.insert( v.end(), d, d + s ); return true; }
+         bool put( char c ) { v.push_back( c ); return true; }
+         size_t tellp()const { return v.size(); }
+      };
+
+      /// offset of the site id in a record packed by pack_binary_log_record, after its size prefix
+      constexpr size_t binary_log_site_offset = sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint8_t);
+
+      /**
+       *  Packs a record prefixed by its size, with the same layout as fc::raw::pack( binary_log_record ) and
+       *  without copying the arguments. The size prefix and site id are placeholders filled in by the caller.
+       */
+      static void pack_binary_log_record( std::vector<char>& buf, const log_context& ctx, const variant_object& args ) {
+         buf.clear();
+         buf.resize( sizeof(uint32_t) );
+         binary_log_buffer s{ buf };
+         fc::raw::pack( s, ctx.get_timestamp().time_since_epoch().count() );
+         fc::raw::pack( s, static_cast<uint8_t>( ctx.get_log_level().value ) );
+         fc::raw::pack( s, uint32_t( 0 ) );
+         fc::raw::pack( s, ctx.get_thread_name() );
+         fc::raw::pack( s, unsigned_int( static_cast<uint32_t>( args.size() ) ) );
+         for( const auto& a : args )
+            fc::raw::pack( s, a.value() );
+      }
+
+      static uint64_t binary_log_site_hash( const string& file, uint64_t line, const string& format ) {
+         return fc::fast_hash64( format.data(), format.size(), fc::fast_hash64( file.data(), file.size(), line ) );
+      }
+
+   } // namespace detail
+
+   class binary_appender::impl {
+   public:
+      explicit impl( const config& c )
+      : cfg( c )
+      {
+         FC_ASSERT( cfg.size_mb > 0, "binary_appender size_mb must be greater than 0" );
+         const uint64_t file_size = cfg.size_mb * 1024 * 1024;
+         const fc::path sites_path = detail::binary_log_sites_path( cfg.file );
+
+         // records from before a restart or crash are kept when the ring and its sites are still readable
+         bool reopen = fc::exists( cfg.file ) && fc::file_size( cfg.file ) == file_size && fc::exists( sites_path );
+         if( !reopen ) {
+            cfile f;
+            f.set_file_path( cfg.file );
+            f.open( cfile::truncate_rw_mode );
+            f.close();
+            fc::resize_file( cfg.file, file_size );
+         }
+         mapping.reset( new file_mapping( cfg.file.generic_string().c_str(), read_write ) );
+         region.reset( new mapped_region( *mapping, read_write, 0, file_size ) );
+
+         header = reinterpret_cast<detail::binary_log_header*>( region->get_address() );
+         data = reinterpret_cast<char*>( region->get_address() ) + detail::binary_log_header::data_offset;
+         const uint64_t capacity = file_size - detail::binary_log_header::data_offset;
+         reopen = reopen && valid_header( capacity ) && load_sites( sites_path );
+         if( !reopen ) {
+            memset( header, 0, sizeof(*header) );
+            memcpy( header->magic, detail::binary_log_header::magic_value, sizeof(header->magic) );
+            header->version = detail::binary_log_header::current_version;
+            header->capacity = capacity;
+            sites.clear();
+            site_ids.clear();
+         }
+
+         sites_file.set_file_path( sites_path );
+         sites_file.open( reopen ? cfile::create_or_update_rw_mode : cfile::truncate_rw_mode );
+      }
+
+      bool valid_header( uint64_t capacity )const {
+         return memcmp( header->magic, detail::binary_log_header::magic_value, sizeof(header->magic) ) == 0 &&
+                header->version == detail::binary_log_header::current_version &&
+                header->capacity == capacity && header->head <= capacity &&
+                ( header->records == 0 || header->tail + sizeof(uint32_t) <= capacity );
+      }
+
+      /// reads the sites of a reopened ring, dropping a last entry cut short by a crash
+      bool load_sites( const fc::path& sites_path ) {
+         cfile sf;
+         sf.set_file_path( sites_path );
+         sf.open( cfile::update_rw_mode );
+         const size_t sites_size = fc::file_size( sites_path );
+         size_t good = 0;
+         auto ds = sf.create_datastream();
+         while( good < sites_size ) {
+            binary_log_site site;
+            try {
+               fc::raw::unpack( ds, site );
+            } catch( ... ) {
+               break;
+            }
+            if( site.id != sites.size() )
+               return false;
+            add_site( std::move( site ) );
+            good = sf.tellp();
+         }
+         sf.close();
+         if( good < sites_size )
+            fc::resize_file( sites_path, good );
+         return true;
+      }
+
+      void add_site( binary_log_site&& site ) {
+         site_ids.emplace( detail::binary_log_site_hash( site.file, site.line, site.format ), site.id );
+         sites.emplace_back( std::move( site ) );
+      }
+
+      uint32_t get_site( uint64_t hash, const log_context& ctx, const log_message& m, const variant_object& args ) {
+         auto range = site_ids.equal_range( hash );
+         for( auto itr = range.first; itr != range.second; ++itr ) {
+            const binary_log_site& s = sites[itr->second];
+            if( s.line != ctx.get_line_number() || s.file != ctx.get_file() || s.format != m.get_format() ||
+                s.arg_names.size() != args.size() )
+               continue;
+            if( std::equal( args.begin(), args.end(), s.arg_names.begin(),
+                            []( const variant_object::entry& a, const string& n ) { return a.key() == n; } ) )
+               return s.id;
+         }
+
+         binary_log_site site;
+         site.id = static_cast<uint32_t>( sites.size() );
+         site.file = ctx.get_file();
+         site.line = ctx.get_line_number();
+         site.method = ctx.get_method();
+         site.format = m.get_format();
+         site.arg_names.reserve( args.size() );
+         for( const auto& a : args )
+            site.arg_names.push_back( a.key() );
+
+         auto packed = fc::raw::pack( site );
+         sites_file.write( packed.data(), packed.size() );
+         sites_file.flush();
+         add_site( std::move( site ) );
+         return sites.back().id;
+      }
+
+      void pop_tail() {
+         header->tail += sizeof(uint32_t) + detail::read_record_size( data, header->tail );
+         --header->records;
+         if( header->records > 0 &&
+             ( header->tail + sizeof(uint32_t) > header->capacity || detail::read_record_size( data, header->tail ) == 0 ) )
+            header->tail = 0;
+      }
+
+      /// makes room for n contiguous bytes at head, overwriting the oldest records as needed
+      void reserve( uint64_t n ) {
+         if( header->head + n > header->capacity ) {
+            while( header->records > 0 && header->tail >= header->head )
+               pop_tail();
+            if( header->head + sizeof(uint32_t) <= header->capacity )
+               memset( data + header->head, 0, sizeof(uint32_t) );
+            header->head = 0;
+         }
+         while( header->records > 0 && header->tail >= header->head && header->tail < header->head + n )
+            pop_tail();
+         if( header->records == 0 )
+            header->tail = header->head;
+      }
+
+      config                                      cfg;
+      std::mutex                                  mtx;
+      std::unique_ptr<file_mapping>               mapping;
+      std::unique_ptr<mapped_region>              region;
+      detail::binary_log_header*                  header = nullptr;
+      char*                                       data = nullptr;
+      cfile                                       sites_file;
+      std::vector<binary_log_site>                sites;
+      /// site hash to id, ids of colliding sites share a hash
+      std::unordered_multimap<uint64_t, uint32_t> site_ids;
+   };
+
+   binary_appender::binary_appender( const variant& args )
+   : binary_appender( args.as<config>() )
+   {}
+
+   binary_appender::binary_appender( const config& cfg )
+   : my( new impl( cfg ) )
+   {}
+
+   binary_appender::~binary_appender() {}
+
+   uint64_t binary_appender::get_dropped_count()const {
+      std::lock_guard g( my->mtx );
+      return my->header->dropped;
+   }
+
+   void binary_appender::log( const log_message& m ) {
+      const log_context context = m.get_context();
+      const variant_object args = m.get_data();
+
+      // packed once, outside the lock, into a per thread buffer that is copied into the ring
+      thread_local std::vector<char> record;
+      detail::pack_binary_log_record( record, context, args );
+      const uint64_t hash = detail::binary_log_site_hash( context.get_file(), context.get_line_number(), m.get_format() );
+      const uint32_t payload_size = static_cast<uint32_t>( record.size() - sizeof(uint32_t) );
+      memcpy( record.data(), &payload_size, sizeof(payload_size) );
+
+      std::lock_guard g( my->mtx );
+      if( record.size() + sizeof(uint32_t) > my->header->capacity ) {
+         ++my->header->dropped;
+         return;
+      }
+      const uint32_t site = my->get_site( hash, context, m, args );
+      memcpy( record.data() + detail::binary_log_site_offset, &site, sizeof(site) );
+
+      my->reserve( record.size() );
+      memcpy( my->data + my->header->head, record.data(), record.size() );
+      my->header->head += record.size();
+      ++my->header->records;
+   }
+
+   class binary_log_reader::impl {
+   public:
+      std::vector<char>             ring;
+      detail::binary_log_header     header;
+      std::vector<binary_log_site>  sites;
+   };
+
+   binary_log_reader::binary_log_reader( const fc::path& file )
+   : my( new impl )
+   {
+      cfile f;
+      f.set_file_path( file );
+      f.open( "rb" );
+      f.read( reinterpret_cast<char*>( &my->header ), sizeof(my->header) );
+      FC_ASSERT( memcmp( my->header.magic, detail::binary_log_header::magic_value, sizeof(my->header.magic) ) == 0,
+                 "${f} is not a binary log file", ("f", file) );
+      FC_ASSERT( my->header.version == detail::binary_log_header::current_version,
+                 "unsupported binary log version ${v}", ("v", my->header.version) );
+      FC_ASSERT( fc::file_size( file ) >= detail::binary_log_header::data_offset + my->header.capacity,
+                 "binary log file ${f} is truncated", ("f", file) );
+      my->ring.resize( my->header.capacity );
+      f.seek( detail::binary_log_header::data_offset );
+      f.read( my->ring.data(), my->ring.size() );
+
+      const fc::path sites_path = detail::binary_log_sites_path( file );
+      cfile sf;
+      sf.set_file_path( sites_path );
+      sf.open( "rb" );
+      const size_t sites_size = fc::file_size( sites_path );
+      auto ds = sf.create_datastream();
+      while( sf.tellp() < sites_size ) {
+         binary_log_site site;
+         try {
+            fc::raw::unpack( ds, site );
+         } catch( ... ) {
+            break; // a last site cut short by a crash, no record refers to it as sites are written first
+         }
+         FC_ASSERT( site.id == my->sites.size(), "binary log sites out of order" );
+         my->sites.emplace_back( std::move( site ) );
+      }
+   }
+
+   binary_log_reader::~binary_log_reader() {}
+
+   const std::vector<binary_log_site>& binary_log_reader::get_sites()const {
+      return my->sites;
+   }
+
+   void binary_log_reader::for_each( const std::function<void(const binary_log_record&)>& cb )const {
+      uint64_t pos = my->header.tail;
+      for( uint64_t i = 0; i < my->header.records; ++i ) {
+         if( pos + sizeof(uint32_t) > my->ring.size() || detail::read_record_size( my->ring.data(), pos ) == 0 )
+            pos = 0;
+         const uint32_t size = detail::read_record_size( my->ring.data(), pos );
+         FC_ASSERT( pos + sizeof(uint32_t) + size <= my->ring.size(), "corrupt binary log record at ${p}", ("p", pos) );
+         binary_log_record r;
+         fc::datastream<const char*> ds( my->ring.data() + pos + sizeof(uint32_t), size );
+         fc::raw::unpack( ds, r );
+         cb( r );
+         pos += sizeof(uint32_t) + size;
+      }
+   }
+
+   log_message binary_log_reader::to_log_message( const binary_log_record& r )const {
+      FC_ASSERT( r.site < my->sites.size(), "unknown binary log site ${s}", ("s", r.site) );
+      const binary_log_site& site = my->sites[r.site];
+      log_context ctx( variant( mutable_variant_object()
+                       ( "level", log_level( r.level ) )
+                       ( "file", site.file )
+                       ( "line", site.line )
+                       ( "method", site.method )
+                       ( "hostname", "" )
+                       ( "thread_name", r.thread_name )
+                       ( "timestamp", time_point( microseconds( r.timestamp ) ) ) ) );
+      mutable_variant_object args;
+      for( size_t i = 0; i < r.args.size() && i < site.arg_names.size(); ++i )
+         args( site.arg_names[i], r.args[i] );
+      return log_message( std::move( ctx ), site.format, std::move( args ) );
+   }
+
+} // namespace fc
@@ -9,6 +9,8 @@
 #define COLOR_CONSOLE 1
 #include "console_defines.h"
 #include <fc/exception/exception.hpp>
+#include <charconv>
+#include <ctime>
 #include <iomanip>
 #include <mutex>
 #include <sstream>
@@ -82,68 +84,134 @@ namespace fc {
       }
    }
 
-   string fixed_size( size_t s, const string& str ) {
-      if( str.size() == s ) return str;
-      if( str.size() > s ) return str.substr( 0, s );
-      string tmp = str;
-      tmp.append( s - str.size(), ' ' );
-      return tmp;
+   static const char* fixed_size_level_name( log_level l ) {
+      switch( l.value ) {
+         case log_level::all:   return "all  ";
+         case log_level::debug: return "debug";
+         case log_level::info:  return "info ";
+         case log_level::warn:  return "warn ";
+         case log_level::error: return "error";
+         case log_level::off:   return "off  ";
+      }
+      return "unkno";
    }
 
-   void console_appender::log( const log_message& m ) {
-      //fc::string message = fc::format_string( m.get_format(), m.get_data() );
-      //fc::variant lmsg(m);
+   /// appends s truncated or space padded to n chars
+   static void append_fixed_size( string& out, std::string_view s, size_t n ) {
+      const size_t len = std::min( s.size(), n );
+      out.append( s.data(), len );
+      out.append( n - len, ' ' );
+   }
 
-      FILE* out = stream::std_error ? stderr : stdout;
+   /// appends the same text as string( time_point ), the date and time part is only recomputed when the second changes
+   static void append_timestamp( string& out, const time_point& t ) {
+      const int64_t count = t.time_since_epoch().count();
+      if( count < 0 ) {
+         out += string( t );
+         return;
+      }
 
-      //fc::string fmt_str = fc::format_string( cfg.format, mutable_variant_object(m.get_context())( "message", message)  );
+      struct cached_second {
+         int64_t  sec = -1;
+         char     text[32];
+         int      size = 0;
+      };
+      thread_local cached_second cache;
+
+      const int64_t sec = count / 1000000;
+      if( sec != cache.sec ) {
+         const time_t tt = static_cast<time_t>( sec );
+         struct tm tm;
+#ifdef WIN32
+         gmtime_s( &tm, &tt );
+#else
+         gmtime_r( &tt, &tm );
+#endif
+         cache.size = snprintf( cache.text, sizeof(cache.text), "%04d-%02d-%02dT%02d:%02d:%02d",
+                                tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec );
+         cache.sec = sec;
+      }
+      out.append( cache.text, cache.size );
 
-      const log_context context = m.get_context();
-      std::string file_line = context.get_file().substr( 0, 22 );
-      file_line += ':';
-      file_line += fixed_size(  6, fc::to_string( context.get_line_number() ) );
+      const int msec = static_cast<int>( ( count % 1000000 ) / 1000 );
+      const char frac[4] = { '.', char( '0' + msec / 100 ), char( '0' + msec / 10 % 10 ), char( '0' + msec % 10 ) };
+      out.append( frac, sizeof(frac) );
+   }
 
-      std::string line;
-      line.reserve( 256 );
-      if(my->use_syslog_header) {
-         switch(m.get_context().get_log_level()) {
-            case log_level::error:
-               line += "<3>";
-               break;
-            case log_level::warn:
-               line += "<4>";
-               break;
-            case log_level::info:
-               line += "<6>";
-               break;
-            case log_level::debug:
-               line += "<7>";
-               break;
-         }
-      }
-      line += fixed_size(  5, context.get_log_level().to_string() ); line += ' ';
-      // use now() instead of context.get_timestamp() because log_message construction can include user provided long running calls
-      line += string( time_point::now() ); line += ' ';
-      line += fixed_size(  9, context.get_thread_name() ); line += ' ';
-      line += fixed_size( 29, file_line ); line += ' ';
+   void console_appender::format_log_line( string& out, const log_message& m, const time_point& timestamp ) {
+      const log_context context = m.get_context();
 
-      auto me = context.get_method();
+      append_fixed_size( out, fixed_size_level_name( context.get_log_level() ), 5 ); out += ' ';
+      append_timestamp( out, timestamp ); out += ' ';
+      append_fixed_size( out, context.get_thread_name(), 9 ); out += ' ';
+
+      // file:line, at most 22 + 1 + 6 chars, padded to 29
+      const size_t file_line_start = out.size();
+      const string& file = context.get_file();
+      out.append( file.data(), std::min<size_t>( file.size(), 22 ) );
+      out += ':';
+      char line_number[24];
+      const auto r = std::to_chars( line_number, line_number + sizeof(line_number), context.get_line_number() );
+      append_fixed_size( out, std::string_view( line_number, r.ptr - line_number ), 6 );
+      out.append( 29 - ( out.size() - file_line_start ), ' ' );
+      out += ' ';
+
+      const string& me = context.get_method();
       // strip all leading scopes...
       if( me.size() ) {
-         uint32_t p = 0;
-         for( uint32_t i = 0;i < me.size(); ++i ) {
-             if( me[i] == ':' ) p = i;
-         }
+         const size_t p = me.rfind( ':' );
+         const size_t start = p == string::npos ? 0 : p + 1;
+         append_fixed_size( out, std::string_view( me ).substr( start, 20 ), 20 ); out += ' ';
+      }
+      out += "] ";
+      out += fc::format_string( m.get_format(), m.get_data() );
+   }
 
-         if( me[p] == ':' ) ++p;
-         line += fixed_size( 20, context.get_method().substr( p, 20 ) ); line += ' ';
+   string console_appender::format_log_line( const log_message& m, const time_point& timestamp ) {
+      string line;
+      line.reserve( 256 );
+      format_log_line( line, m, timestamp );
+      return line;
+   }
+
+   static const char* syslog_header( log_level l ) {
+      switch( l.value ) {
+         case log_level::error: return "<3>";
+         case log_level::warn:  return "<4>";
+         case log_level::info:  return "<6>";
+         case log_level::debug: return "<7>";
+         default:               return "";
       }
-      line += "] ";
-      line += fc::format_string( m.get_format(), m.get_data() );
+   }
+
+   void console_appender::log( const log_message& m ) {
+      //fc::string message = fc::format_string( m.get_format(), m.get_data() );
+      //fc::variant lmsg(m);
 
-      print( line, my->lc[context.get_log_level()] );
+      FILE* out = stream::std_error ? stderr : stdout;
+
+      //fc::string fmt_str = fc::format_string( cfg.format, mutable_variant_object(m.get_context())( "message", message)  );
 
+      const log_level level = m.get_context().get_log_level();
+
+      // whole line, including colors and newline, is built in a reused per thread buffer and written with one fwrite
+      thread_local string line;
+      line.clear();
+#ifndef WIN32
+      const bool is_tty = isatty( fileno( out ) );
+      if( is_tty ) line += get_console_color( my->lc[level] );
+#endif
+      if( my->use_syslog_header ) line += syslog_header( level );
+      // use now() instead of context.get_timestamp() because log_message construction can include user provided long running calls
+      format_log_line( line, m, time_point::now() );
+#ifdef WIN32
+      print( line, my->lc[level] );
       fprintf( out, "\n" );
+#else
+      if( is_tty ) line += CONSOLE_DEFAULT;
+      line += '\n';
+      fwrite( line.data(), 1, line.size(), out );
+#endif
 
       if( my->cfg.flush ) fflush( out );
    }
@@ -0,0 +1,248 @@
+#include <fc/log/file_appender.hpp>
+#include <fc/log/console_appender.hpp>
+#include <fc/log/log_message.hpp>
+#include <fc/compress/zlib.hpp>
+#include <fc/io/cfile.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/exception/exception.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace fc {
+
+   /**
+    *  Loggers append to buffer under mtx. The file, and the lines being written to it, are only touched under
+    *  io_mtx: a writer holding io_mtx swaps buffer out under mtx and writes it with mtx released, so loggers
+    *  do not wait on disk I/O. Buffers are only swapped out while holding io_mtx, which keeps lines in order.
+    *  io_mtx is taken before mtx, or with try_lock while holding mtx.
+    */
+   class file_appender::impl {
+   public:
+      explicit impl( const config& c )
+      : cfg( c )
+      {
+         FC_ASSERT( cfg.buffer_size_kb > 0, "file_appender buffer_size_kb must be greater than 0" );
+         buffer.reserve( cfg.buffer_size_kb * 1024 );
+         writing.reserve( cfg.buffer_size_kb * 1024 );
+         file_bytes = open();
+         opened = time_point::now();
+         worker = std::thread( [this]() { run(); } );
+      }
+
+      ~impl() {
+         {
+            std::lock_guard g( mtx );
+            stopping = true;
+         }
+         cv.notify_all();
+         worker.join();
+         try {
+            flush();
+         } catch( const std::exception& e ) {
+            std::cerr << "ERROR: file_appender unable to flush " << cfg.file.generic_string() << ": " << e.what() << std::endl;
+         }
+      }
+
+      /// opens the log file for append and returns its size, needs io_mtx
+      uint64_t open() {
+         if( !cfg.file.parent_path().generic_string().empty() && !fc::exists( cfg.file.parent_path() ) )
+            fc::create_directories( cfg.file.parent_path() );
+         out.set_file_path( cfg.file );
+         out.open( cfile::create_or_update_rw_mode );
+         return fc::file_size( cfg.file );
+      }
+
+      /// swaps the buffered lines out and releases lk, which holds mtx, before writing them; needs io_mtx
+      void write_buffer( std::unique_lock<std::mutex>& lk, bool flush ) {
+         writing.swap( buffer );
+         lk.unlock();
+         if( !writing.empty() ) {
+            out.write( writing.data(), writing.size() );
+            writing.clear();
+            dirty = true;
+         }
+         if( flush && dirty ) {
+            out.flush();
+            dirty = false;
+         }
+      }
+
+      /// writes out and flushes every line buffered so far
+      void flush() {
+         std::lock_guard io( io_mtx );
+         std::unique_lock lk( mtx );
+         write_buffer( lk, true );
+      }
+
+      /// needs mtx; an empty file is never due, so an idle period does not leave empty rotated files behind
+      bool rotation_due( size_t n )const {
+         if( file_bytes == 0 )
+            return false;
+         if( cfg.max_size_mb && file_bytes + n > cfg.max_size_mb * 1024 * 1024 )
+            return true;
+         return cfg.rotation_interval_s && time_point::now() - opened >= fc::seconds( cfg.rotation_interval_s );
+      }
+
+      fc::path rotated_path()const {
+         string stamp = time_point_sec( time_point::now() ).to_iso_string();
+         stamp.erase( std::remove_if( stamp.begin(), stamp.end(), []( char c ) { return c == '-' || c == ':'; } ), stamp.end() );
+         const string base = ( cfg.file.parent_path() / cfg.file.stem() ).generic_string() + "-" + stamp;
+         const string ext = cfg.file.extension().generic_string();
+         fc::path p = base + ext;
+         for( uint32_t i = 1; fc::exists( p ) || fc::exists( p.generic_string() + ".gz" ); ++i )
+            p = base + "-" + std::to_string( i ) + ext;
+         return p;
+      }
+
+      /// @param if_due only rotate when rotation_due( n ), checked again as another thread may have rotated first
+      void rotate( bool if_due, size_t n ) {
+         std::lock_guard io( io_mtx );
+         std::unique_lock lk( mtx );
+         if( if_due && !rotation_due( n ) )
+            return;
+         // lines logged from here on go to the new file
+         write_buffer( lk, true );
+         out.close();
+         const fc::path p = rotated_path();
+         fc::rename( cfg.file, p );
+         const uint64_t size = open();
+
+         lk.lock();
+         file_bytes = size + buffer.size();
+         opened = time_point::now();
+         if( cfg.compress ) {
+            pending.push_back( p );
+            cv.notify_all();
+         } else {
+            add_rotated( p );
+         }
+      }
+
+      /// needs mtx
+      void add_rotated( const fc::path& p ) {
+         rotated.push_back( p );
+         while( cfg.max_rotated_files && rotated.size() > cfg.max_rotated_files ) {
+            try {
+               fc::remove( rotated.front() );
+            } catch( const fc::exception& e ) {
+               report( e.to_detail_string().c_str() );
+            }
+            rotated.pop_front();
+         }
+      }
+
+      void report( const char* what )const {
+         std::cerr << "ERROR: file_appender " << cfg.file.generic_string() << ": " << what << std::endl;
+      }
+
+      /// flushes every flush_interval_ms, applies time based rotation and compresses rotated files
+      void run() {
+         const auto period = std::chrono::milliseconds( cfg.flush_interval_ms ? cfg.flush_interval_ms : 1000 );
+         std::unique_lock lk( mtx );
+         while( true ) {
+            cv.wait_for( lk, period, [this]() { return stopping || !pending.empty(); } );
+            const bool stop = stopping;
+            lk.unlock();
+            try {
+               flush();
+               if( !stop && cfg.rotation_interval_s )
+                  rotate( true, 0 );
+            } catch( const fc::exception& e ) {
+               report( e.to_detail_string().c_str() );
+            } catch( const std::exception& e ) {
+               report( e.what() );
+            }
+            lk.lock();
+
+            std::deque<fc::path> jobs;
+            jobs.swap( pending );
+            if( !jobs.empty() ) {
+               lk.unlock();
+               std::deque<fc::path> done;
+               for( const auto& p : jobs ) {
+                  const fc::path gz = p.generic_string() + ".gz";
+                  try {
+                     fc::gzip_compress_file( p, gz );
+                     fc::remove( p );
+                     done.push_back( gz );
+                  } catch( const fc::exception& e ) {
+                     report( e.to_detail_string().c_str() );
+                     done.push_back( p );
+                  } catch( const std::exception& e ) {
+                     report( e.what() );
+                     done.push_back( p );
+                  }
+               }
+               lk.lock();
+               for( const auto& p : done )
+                  add_rotated( p );
+            }
+            if( stopping && pending.empty() )
+               break;
+         }
+      }
+
+      config                   cfg;
+      std::mutex               mtx;
+      std::condition_variable  cv;
+      std::thread              worker;
+      bool                     stopping = false;
+      string                   buffer;
+      uint64_t                 file_bytes = 0;   ///< size of the file including buffered lines
+      time_point               opened;
+      std::deque<fc::path>     pending;          ///< rotated files waiting to be compressed
+      std::deque<fc::path>     rotated;          ///< rotated files kept, oldest first
+
+      std::mutex               io_mtx;
+      cfile                    out;
+      string                   writing;          ///< lines swapped out of buffer being written
+      bool                     dirty = false;
+   };
+
+   file_appender::file_appender( const variant& args )
+   : file_appender( args.as<config>() )
+   {}
+
+   file_appender::file_appender( const config& cfg )
+   : my( new impl( cfg ) )
+   {}
+
+   file_appender::~file_appender() {}
+
+   void file_appender::log( const log_message& m ) {
+      // use now() instead of context.get_timestamp() because log_message construction can include user provided long running calls
+      string line = console_appender::format_log_line( m, time_point::now() );
+      line += '\n';
+
+      std::unique_lock lk( my->mtx );
+      if( my->rotation_due( line.size() ) ) {
+         lk.unlock();
+         my->rotate( true, line.size() );
+         lk.lock();
+      }
+      my->buffer += line;
+      my->file_bytes += line.size();
+      if( my->cfg.flush_interval_ms == 0 ) {
+         lk.unlock();
+         my->flush();
+      } else if( my->buffer.size() >= my->cfg.buffer_size_kb * 1024 ) {
+         // when another thread is writing, the lines wait for the next write rather than this thread waiting
+         std::unique_lock io( my->io_mtx, std::try_to_lock );
+         if( io.owns_lock() )
+            my->write_buffer( lk, false );
+      }
+   }
+
+   void file_appender::flush() {
+      my->flush();
+   }
+
+   void file_appender::rotate() {
+      my->rotate( false, 0 );
+   }
+
+} // namespace fc
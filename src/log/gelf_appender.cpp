@@ -12,6 +12,8 @@
 #include <boost/lexical_cast.hpp>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <queue>
 #include <sstream>
 #include <iostream>
@@ -20,6 +22,9 @@ namespace fc
 {
   namespace detail
   {
+    /// GELF allows a message to be split into at most 128 chunks
+    constexpr size_t max_gelf_chunks = 128;
+
     boost::asio::ip::udp::endpoint to_asio_ep( const fc::ip::endpoint& e )
     {
       return boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4(e.get_address()), e.port() );
@@ -32,10 +37,22 @@ namespace fc
     config                                    cfg;
     optional<boost::asio::ip::udp::endpoint>  gelf_endpoint;
     udp_socket                                gelf_socket;
+    std::mutex                                mtx;
+    uint64_t                                  gelf_log_counter = 0;
+    // reused between messages
+    zlib_compressor                           compressor;
+    string                                    json_buffer;
+    string                                    compressed_buffer;
+    std::vector<char>                         chunk_buffer;
+    std::vector<boost::asio::const_buffer>    datagrams;
 
     impl(const config& c) :
       cfg(c)
     {
+      const size_t header_length = 2 /* magic */ + 8 /* msg id */ + 1 /* seq */ + 1 /* count */;
+      FC_ASSERT(cfg.max_datagram_size > header_length && cfg.max_datagram_size <= 65507,
+                "gelf_appender max_datagram_size must be between ${min} and 65507", ("min", header_length + 1));
+      json_buffer.reserve(1024);
     }
 
     ~impl()
@@ -98,110 +115,138 @@ namespace fc
   gelf_appender::~gelf_appender()
   {}
 
+  namespace detail
+  {
+    /// appends "key":"escaped value"
+    static void append_json_string_field(string& out, const char* key, const string& value)
+    {
+      out += '"';
+      out += key;
+      out += "\":\"";
+      out += escape_string(value, nullptr);
+      out += "\",";
+    }
+
+    template<typename T>
+    static void append_json_number_field(string& out, const char* key, T value)
+    {
+      out += '"';
+      out += key;
+      out += "\":";
+      out += std::to_string(value);
+      out += ',';
+    }
+  }
+
   void gelf_appender::log(const log_message& message)
   {
     if (!my->gelf_endpoint)
       return;
 
-    log_context context = message.get_context();
-
-    mutable_variant_object gelf_message;
-    gelf_message["version"] = "1.1";
-    gelf_message["host"] = my->cfg.host;
-    gelf_message["short_message"] = format_string(message.get_format(), message.get_data(), true);
-
+    const log_context context = message.get_context();
     // use now() instead of context.get_timestamp() because log_message construction can include user provided long running calls
     const auto time_ns = time_point::now().time_since_epoch().count();
-    gelf_message["timestamp"] = time_ns / 1000000.;
-    gelf_message["_timestamp_ns"] = time_ns;
-
-    static uint64_t gelf_log_counter;
-    gelf_message["_log_id"] = fc::to_string(++gelf_log_counter);
+    const string short_message = format_string(message.get_format(), message.get_data(), true);
 
+    int level = 6; // info
     switch (context.get_log_level())
     {
     case log_level::debug:
-      gelf_message["level"] = 7; // debug
+      level = 7; // debug
       break;
     case log_level::info:
-      gelf_message["level"] = 6; // info
+      level = 6; // info
       break;
     case log_level::warn:
-      gelf_message["level"] = 4; // warning
+      level = 4; // warning
       break;
     case log_level::error:
-      gelf_message["level"] = 3; // error
+      level = 3; // error
       break;
     case log_level::all:
     case log_level::off:
       // these shouldn't be used in log messages, but do something deterministic just in case
-      gelf_message["level"] = 6; // info
+      level = 6; // info
       break;
     }
 
+    std::lock_guard<std::mutex> g(my->mtx);
+
+    // GELF fields written directly, in the order and number formats the variant based JSON used
+    // (GELF 1.1 specifies unstringified numbers)
+    string& json = my->json_buffer;
+    json.clear();
+    json += '{';
+    detail::append_json_string_field(json, "version", "1.1");
+    detail::append_json_string_field(json, "host", my->cfg.host);
+    detail::append_json_string_field(json, "short_message", short_message);
+    char timestamp[64];
+    snprintf(timestamp, sizeof(timestamp), "%.*f", std::numeric_limits<double>::digits10 + 2, time_ns / 1000000.);
+    json += "\"timestamp\":";
+    json += timestamp;
+    json += ',';
+    detail::append_json_number_field(json, "_timestamp_ns", time_ns);
+    detail::append_json_string_field(json, "_log_id", fc::to_string(++my->gelf_log_counter));
+    detail::append_json_number_field(json, "level", level);
     if (!context.get_context().empty())
-      gelf_message["context"] = context.get_context();
-    gelf_message["_line"] = context.get_line_number();
-    gelf_message["_file"] = context.get_file();
-    gelf_message["_method_name"] = context.get_method();
-    gelf_message["_thread_name"] = context.get_thread_name();
+      detail::append_json_string_field(json, "context", context.get_context());
+    detail::append_json_number_field(json, "_line", context.get_line_number());
+    detail::append_json_string_field(json, "_file", context.get_file());
+    detail::append_json_string_field(json, "_method_name", context.get_method());
+    detail::append_json_string_field(json, "_thread_name", context.get_thread_name());
     if (!context.get_task_name().empty())
-      gelf_message["_task_name"] = context.get_task_name();
+      detail::append_json_string_field(json, "_task_name", context.get_task_name());
+    json.back() = '}';
 
-    string gelf_message_as_string = json::to_string(gelf_message,
-          fc::time_point::now() + fc::exception::format_time_limit,
-          json::output_formatting::legacy_generator); // GELF 1.1 specifies unstringified numbers
-    //unsigned uncompressed_size = gelf_message_as_string.size();
-    gelf_message_as_string = zlib_compress(gelf_message_as_string);
+    string& compressed = my->compressed_buffer;
+    my->compressor.compress(json.data(), json.size(), compressed);
 
     // graylog2 expects the zlib header to be 0x78 0x9c
     // but miniz.c generates 0x78 0x01 (indicating
     // low compression instead of default compression)
     // so change that here
-    FC_ASSERT(gelf_message_as_string[0] == (char)0x78);
-    if (gelf_message_as_string[1] == (char)0x01 ||
-        gelf_message_as_string[1] == (char)0xda)
-      gelf_message_as_string[1] = (char)0x9c;
-    FC_ASSERT(gelf_message_as_string[1] == (char)0x9c);
+    FC_ASSERT(compressed[0] == (char)0x78);
+    if (compressed[1] == (char)0x01 ||
+        compressed[1] == (char)0xda)
+      compressed[1] = (char)0x9c;
+    FC_ASSERT(compressed[1] == (char)0x9c);
 
     // packets are sent by UDP, and they tend to disappear if they
     // get too large.  It's hard to find any solid numbers on how
     // large they can be before they get dropped -- datagrams can
     // be up to 64k, but anything over 512 is not guaranteed.
-    // You can play with this number, intermediate values like
+    // max_datagram_size defaults to 512, intermediate values like
     // 1400 and 8100 are likely to work on most intranets.
-    const unsigned max_payload_size = 512;
+    const size_t max_payload_size = my->cfg.max_datagram_size;
 
-    if (gelf_message_as_string.size() <= max_payload_size)
+    std::vector<boost::asio::const_buffer>& datagrams = my->datagrams;
+    datagrams.clear();
+    if (compressed.size() <= max_payload_size)
     {
       // no need to split
-      std::shared_ptr<char> send_buffer(new char[gelf_message_as_string.size()],
-                                        [](char* p){ delete[] p; });
-      memcpy(send_buffer.get(), gelf_message_as_string.c_str(),
-             gelf_message_as_string.size());
-
-      my->gelf_socket.send_to(send_buffer, gelf_message_as_string.size(),
-                              *my->gelf_endpoint);
+      datagrams.emplace_back(compressed.data(), compressed.size());
     }
     else
     {
       // split the message
       // we need to generate an 8-byte ID for this message.
       // city hash should do
-      uint64_t message_id = city_hash64(gelf_message_as_string.c_str(), gelf_message_as_string.size());
-      const unsigned header_length = 2 /* magic */ + 8 /* msg id */ + 1 /* seq */ + 1 /* count */;
-      const unsigned body_length = max_payload_size - header_length;
-      unsigned total_number_of_packets = (gelf_message_as_string.size() + body_length - 1) / body_length;
-      unsigned bytes_sent = 0;
-      unsigned number_of_packets_sent = 0;
-      while (bytes_sent < gelf_message_as_string.size())
-      {
-        unsigned bytes_to_send = std::min((unsigned)gelf_message_as_string.size() - bytes_sent,
-                                          body_length);
+      uint64_t message_id = city_hash64(compressed.c_str(), compressed.size());
+      const size_t header_length = 2 /* magic */ + 8 /* msg id */ + 1 /* seq */ + 1 /* count */;
+      const size_t body_length = max_payload_size - header_length;
+      const size_t total_number_of_packets = (compressed.size() + body_length - 1) / body_length;
+      FC_ASSERT(total_number_of_packets <= detail::max_gelf_chunks,
+                "GELF message of ${s} compressed bytes needs more than ${m} chunks",
+                ("s", compressed.size())("m", detail::max_gelf_chunks));
 
-        std::shared_ptr<char> send_buffer(new char[max_payload_size],
-                                          [](char* p){ delete[] p; });
-        char* ptr = send_buffer.get();
+      // every chunk of the message is laid out in one pooled buffer and handed to the socket as a batch
+      my->chunk_buffer.resize(total_number_of_packets * max_payload_size);
+      size_t bytes_sent = 0;
+      for (size_t number_of_packets_sent = 0; number_of_packets_sent < total_number_of_packets; ++number_of_packets_sent)
+      {
+        const size_t bytes_to_send = std::min(compressed.size() - bytes_sent, body_length);
+        char* const chunk = my->chunk_buffer.data() + number_of_packets_sent * max_payload_size;
+        char* ptr = chunk;
         // magic number for chunked message
         *(unsigned char*)ptr++ = 0x1e;
         *(unsigned char*)ptr++ = 0x0f;
@@ -212,14 +257,12 @@ namespace fc
 
         *(unsigned char*)(ptr++) = number_of_packets_sent;
         *(unsigned char*)(ptr++) = total_number_of_packets;
-        memcpy(ptr, gelf_message_as_string.c_str() + bytes_sent,
-               bytes_to_send);
-        my->gelf_socket.send_to(send_buffer, header_length + bytes_to_send,
-                                *my->gelf_endpoint);
-        ++number_of_packets_sent;
+        memcpy(ptr, compressed.c_str() + bytes_sent, bytes_to_send);
+        datagrams.emplace_back(chunk, header_length + bytes_to_send);
         bytes_sent += bytes_to_send;
       }
-      FC_ASSERT(number_of_packets_sent == total_number_of_packets);
+      FC_ASSERT(bytes_sent == compressed.size());
     }
+    my->gelf_socket.send_to(datagrams, *my->gelf_endpoint);
   }
 } // fc
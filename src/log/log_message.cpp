@@ -165,15 +165,15 @@ namespace fc
       return "unknown";
    }
 
-   string     log_context::get_file()const       { return my->file; }
+   const string& log_context::get_file()const       { return my->file; }
    uint64_t   log_context::get_line_number()const { return my->line; }
-   string     log_context::get_method()const     { return my->method; }
-   string     log_context::get_thread_name()const { return my->thread_name; }
-   string     log_context::get_task_name()const { return my->task_name; }
-   string     log_context::get_host_name()const   { return my->hostname; }
+   const string& log_context::get_method()const     { return my->method; }
+   const string& log_context::get_thread_name()const { return my->thread_name; }
+   const string& log_context::get_task_name()const { return my->task_name; }
+   const string& log_context::get_host_name()const   { return my->hostname; }
    time_point  log_context::get_timestamp()const  { return my->timestamp; }
    log_level  log_context::get_log_level()const{ return my->level;   }
-   string     log_context::get_context()const   { return my->context; }
+   const string& log_context::get_context()const   { return my->context; }
 
 
    variant log_context::to_variant()const
@@ -219,7 +219,7 @@ namespace fc
    }
 
    log_context          log_message::get_context()const { return my->context; }
-   string              log_message::get_format()const  { return my->format;  }
+   const string&       log_message::get_format()const  { return my->format;  }
    variant_object log_message::get_data()const    { return my->args;    }
 
    string        log_message::get_message()const
@@ -7,6 +7,8 @@
 #include <fc/log/console_appender.hpp>
 #include <fc/log/gelf_appender.hpp>
 #include <fc/log/dmlog_appender.hpp>
+#include <fc/log/binary_appender.hpp>
+#include <fc/log/file_appender.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
 
@@ -61,6 +63,8 @@ namespace fc {
       static bool reg_console_appender = log_config::register_appender<console_appender>( "console" );
       static bool reg_gelf_appender = log_config::register_appender<gelf_appender>( "gelf" );
       static bool reg_dmlog_appender = log_config::register_appender<dmlog_appender>( "dmlog" );
+      static bool reg_binary_appender = log_config::register_appender<binary_appender>( "binary" );
+      static bool reg_file_appender = log_config::register_appender<file_appender>( "file" );
 
       std::lock_guard g( log_config::get().log_mutex );
       log_config::get().logger_map.clear();
@@ -95,7 +99,7 @@ namespace fc {
             }
          }
       }
-      return reg_console_appender || reg_gelf_appender || reg_dmlog_appender;
+      return reg_console_appender || reg_gelf_appender || reg_dmlog_appender || reg_binary_appender || reg_file_appender;
       } catch ( exception& e )
       {
          std::cerr<<e.to_detail_string()<<"\n";
@@ -1,6 +1,11 @@
 #include <fc/network/udp_socket.hpp>
 #include <fc/network/ip.hpp>
 
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+#endif
 
 namespace fc
 {
@@ -11,6 +16,10 @@ namespace fc
       ~impl(){}
 
       std::shared_ptr<boost::asio::ip::udp::socket> _sock;
+#if defined(__linux__)
+      std::vector<mmsghdr>                           _msgs;
+      std::vector<iovec>                             _iovs;
+#endif
   };
 
   udp_socket::udp_socket()
@@ -47,7 +56,7 @@ namespace fc
       if(e.code() == boost::asio::error::would_block)
       {
           auto send_buffer_ptr = std::make_shared<std::vector<char>>(buffer, buffer+length);
-          my->_sock->async_send_to(boost::asio::buffer(send_buffer_ptr.get(), length), to,
+          my->_sock->async_send_to(boost::asio::buffer(*send_buffer_ptr), to,
                                    [send_buffer_ptr](const boost::system::error_code& /*ec*/, std::size_t /*bytes_transferred*/)
           {
             // Swallow errors.  Currently only used for GELF logging, so depend on local
@@ -82,6 +91,41 @@ namespace fc
     }
   }
 
+  void udp_socket::send_to(const std::vector<boost::asio::const_buffer>& datagrams, boost::asio::ip::udp::endpoint& to)
+  {
+    size_t sent = 0;
+#if defined(__linux__)
+    const size_t count = datagrams.size();
+    my->_msgs.resize(count);
+    my->_iovs.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      my->_iovs[i].iov_base = const_cast<void*>(datagrams[i].data());
+      my->_iovs[i].iov_len = datagrams[i].size();
+      memset(&my->_msgs[i], 0, sizeof(mmsghdr));
+      my->_msgs[i].msg_hdr.msg_name = to.data();
+      my->_msgs[i].msg_hdr.msg_namelen = to.size();
+      my->_msgs[i].msg_hdr.msg_iov = &my->_iovs[i];
+      my->_msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int fd = my->_sock->native_handle();
+    while (sent < count)
+    {
+      int r = ::sendmmsg(fd, my->_msgs.data() + sent, count - sent, 0);
+      if (r < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        break;
+      }
+      sent += r;
+    }
+#endif
+    // whatever was not sent above (would block, or no sendmmsg) goes one at a time, queueing if the socket would block
+    for (; sent < datagrams.size(); ++sent)
+      send_to(static_cast<const char*>(datagrams[sent].data()), datagrams[sent].size(), to);
+  }
+
   void udp_socket::open()
   {
     my->_sock->open(boost::asio::ip::udp::v4());
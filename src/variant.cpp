@@ -9,6 +9,7 @@
 #include <fc/io/json.hpp>
 #include <fc/utf8.hpp>
 #include <algorithm>
+#include <unordered_map>
 
 namespace fc
 {
@@ -708,10 +709,8 @@ void from_variant( const variant& var,  std::vector<char>& vo )
    FC_ASSERT( str.size() <= 2*MAX_SIZE_OF_BYTE_ARRAYS ); // Doubled because hex strings needs two characters per byte
    FC_ASSERT( str.size() % 2 == 0, "the length of hex string should be even number" );
    vo.resize( str.size() / 2 );
-   if( vo.size() ) {
-      size_t r = from_hex( str, vo.data(), vo.size() );
-      FC_ASSERT( r == vo.size() );
-   }
+   if( vo.size() && !hex_decode( str.data(), str.size(), vo.data() ) )
+      from_hex( str, vo.data(), vo.size() ); // throws naming the invalid character
 }
 
 void to_variant( const UInt<8>& n, variant& v ) { v = uint64_t(n); }
@@ -739,6 +738,99 @@ void clean_append( string& app, const std::string_view& s, size_t pos = 0, size_
    app += escape_string( sub, nullptr, escape_control_chars );
 }
 
+namespace detail {
+
+   /**
+    *  A format string broken into the pieces format_string() produces while scanning it: each segment is an
+    *  already escaped literal followed, except for the last segment, by an optional ${key} placeholder.
+    */
+   struct compiled_format {
+      struct segment {
+         string           literal;      ///< escaped text appended before the placeholder
+         string           key;          ///< placeholder key, only valid when has_key
+         string           unreplaced;   ///< escaped "${key}" emitted when the key can not be substituted
+         bool             has_key = false;
+         mutable size_t   slot = 0;     ///< index of key in the last args searched, checked before a full find
+      };
+
+      std::vector<segment> segments;
+   };
+
+   static compiled_format compile_format( const string& format ) {
+      compiled_format cf;
+      compiled_format::segment seg;
+      size_t prev = 0;
+      size_t next = format.find( '$' );
+      while( prev != string::npos && prev < format.size() ) {
+         clean_append( seg.literal, format, prev, next != string::npos ? next - prev : string::npos );
+         if( next == string::npos )
+            break;
+
+         prev = next + 1;
+         const bool placeholder = format[prev] == '{';
+         if( placeholder ) {
+            next = format.find( '}', prev );
+            if( next != string::npos ) {
+               seg.key = format.substr( prev + 1, (next - prev - 1) );
+               seg.has_key = true;
+               seg.unreplaced = "${";
+               clean_append( seg.unreplaced, seg.key );
+               seg.unreplaced += "}";
+               prev = next + 1;
+               next = format.find( '$', prev );
+            }
+            // else unterminated, the remainder starting at '{' becomes the literal of the final segment
+         }
+         cf.segments.emplace_back( std::move( seg ) );
+         seg = compiled_format::segment();
+         if( !placeholder ) {
+            // a '$' not followed by '{' is dropped, the char after it is kept
+            clean_append( seg.literal, format, prev, 1 );
+            ++prev;
+            next = format.find( '$', prev );
+         }
+      }
+      cf.segments.emplace_back( std::move( seg ) );
+      return cf;
+   }
+
+   /**
+    *  Log format strings come from a small, fixed set of literals so compiled formats are cached per thread;
+    *  the cache is simply dropped when it grows past max_cached_formats (e.g. formats built at runtime).
+    */
+   static const compiled_format& get_compiled_format( const string& format ) {
+      constexpr size_t max_cached_formats = 1024;
+      constexpr size_t max_cached_format_size = 4 * minimize_max_size;
+      thread_local std::unordered_map<string, compiled_format> cache;
+      thread_local compiled_format uncached;
+
+      auto itr = cache.find( format );
+      if( itr != cache.end() )
+         return itr->second;
+
+      if( format.size() > max_cached_format_size ) {
+         uncached = compile_format( format );
+         return uncached;
+      }
+      if( cache.size() >= max_cached_formats )
+         cache.clear();
+      return cache.emplace( format, compile_format( format ) ).first->second;
+   }
+
+   static variant_object::iterator find_arg( const compiled_format::segment& seg, const variant_object& args ) {
+      if( seg.slot < args.size() ) {
+         auto itr = args.begin() + seg.slot;
+         if( itr->key() == seg.key )
+            return itr;
+      }
+      auto itr = args.find( seg.key );
+      if( itr != args.end() )
+         seg.slot = itr - args.begin();
+      return itr;
+   }
+
+} // namespace detail
+
 string format_string( const string& frmt, const variant_object& args, bool minimize )
 {
    std::string result;
@@ -751,88 +843,62 @@ string format_string( const string& frmt, const variant_object& args, bool minim
    const auto minimize_sub_max_size = minimize ? ( max_format_size - format.size() ) / arg_num :  minimize_max_size;
    // reserve space for each argument replaced by ...
    result.reserve( max_format_size + 3 * args.size());
-   size_t prev = 0;
-   size_t next = format.find( '$' );
-   while( prev != string::npos && prev < format.size() ) {
-      if( next != string::npos ) {
-         clean_append( result, format, prev, next - prev );
-      } else {
-         clean_append( result, format, prev );
-      }
+
+   const detail::compiled_format& cf = detail::get_compiled_format( format );
+   const auto last = cf.segments.end() - 1;
+   for( auto seg = cf.segments.begin(); ; ++seg ) {
+      result += seg->literal;
 
       // if we got to the end, return it.
-      if( next == string::npos ) {
+      if( seg == last ) {
          return result;
       } else if( minimize && result.size() > minimize_max_size ) {
          result += "...";
          return result;
       }
-
-      // if we are not at the end, then update the start
-      prev = next + 1;
-
-      if( format[prev] == '{' ) {
-         // if the next char is a open, then find close
-         next = format.find( '}', prev );
-         // if we found close...
-         if( next != string::npos ) {
-            // the key is between prev and next
-            string key = format.substr( prev + 1, (next - prev - 1) );
-
-            auto val = args.find( key );
-            bool replaced = true;
-            if( val != args.end() ) {
-               if( val->value().is_object() || val->value().is_array() ) {
-                  if( minimize && (result.size() >= minimize_max_size)) {
-                     replaced = false;
-                  } else {
-                     const auto max_length = minimize ? minimize_sub_max_size : std::numeric_limits<uint64_t>::max();
-                     try {
-                        // clean_append not needed as to_string is valid utf8
-                        result += json::to_string( val->value(), fc::time_point::maximum(),
-                                                   json::output_formatting::stringify_large_ints_and_doubles, max_length );
-                     } catch (...) {
-                        replaced = false;
-                     }
-                  }
-               } else if( val->value().is_blob() ) {
-                  if( minimize && val->value().get_blob().data.size() > minimize_sub_max_size ) {
-                     replaced = false;
-                  } else {
-                     clean_append( result, val->value().as_string() );
-                  }
-               } else if( val->value().is_string() ) {
-                  if( minimize && val->value().get_string().size() > minimize_sub_max_size ) {
-                     auto sz = std::min( minimize_sub_max_size, minimize_max_size - result.size() );
-                     clean_append( result, val->value().get_string(), 0, sz );
-                     result += "...";
-                  } else {
-                     clean_append( result, val->value().get_string() );
-                  }
-               } else {
-                  clean_append( result, val->value().as_string() );
-               }
+      if( !seg->has_key )
+         continue;
+
+      auto val = detail::find_arg( *seg, args );
+      bool replaced = true;
+      if( val != args.end() ) {
+         if( val->value().is_object() || val->value().is_array() ) {
+            if( minimize && (result.size() >= minimize_max_size)) {
+               replaced = false;
             } else {
+               const auto max_length = minimize ? minimize_sub_max_size : std::numeric_limits<uint64_t>::max();
+               try {
+                  // clean_append not needed as to_string is valid utf8
+                  result += json::to_string( val->value(), fc::time_point::maximum(),
+                                             json::output_formatting::stringify_large_ints_and_doubles, max_length );
+               } catch (...) {
+                  replaced = false;
+               }
+            }
+         } else if( val->value().is_blob() ) {
+            if( minimize && val->value().get_blob().data.size() > minimize_sub_max_size ) {
                replaced = false;
+            } else {
+               clean_append( result, val->value().as_string() );
             }
-            if( !replaced ) {
-               result += "${";
-               clean_append( result, key );
-               result += "}";
+         } else if( val->value().is_string() ) {
+            if( minimize && val->value().get_string().size() > minimize_sub_max_size ) {
+               auto sz = std::min( minimize_sub_max_size, minimize_max_size - result.size() );
+               clean_append( result, val->value().get_string(), 0, sz );
+               result += "...";
+            } else {
+               clean_append( result, val->value().get_string() );
             }
-            prev = next + 1;
-            // find the next $
-            next = format.find( '$', prev );
          } else {
-            // we didn't find it.. continue to while...
+            clean_append( result, val->value().as_string() );
          }
       } else {
-         clean_append( result, format, prev, 1 );
-         ++prev;
-         next = format.find( '$', prev );
+         replaced = false;
+      }
+      if( !replaced ) {
+         result += seg->unreplaced;
       }
    }
-   return result;
 }
 
    #ifdef __APPLE__
@@ -0,0 +1,186 @@
+#define BOOST_TEST_MODULE blocked_bloom_filter
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/blocked_bloom_filter.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/reflect/variant.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+#include <memory>
+
+using namespace fc;
+
+namespace {
+
+struct restore_backend {
+   blocked_bloom_backend b = get_blocked_bloom_backend();
+   ~restore_backend() { set_blocked_bloom_backend( b ); }
+};
+
+std::vector<sha256> random_ids( size_t n ) {
+   std::vector<sha256> ids( n );
+   rand_bytes( (char*)ids.data(), n * sizeof(sha256) );
+   return ids;
+}
+
+template<typename F>
+double seconds( F&& f ) {
+   return fc::benchmark::elapsed_us( f ) / 1e6;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(blocked_bloom_filter_suite)
+
+BOOST_AUTO_TEST_CASE(false_positive_rate) try {
+   for( auto [n, p] : { std::pair<size_t, double>{ 10000, 0.01 }, { 100000, 0.001 }, { 50000, 0.00001 } } ) {
+      blocked_bloom_filter f( n, p, 7 );
+      BOOST_REQUIRE( !!f );
+      const auto ids = random_ids( n );
+      for( const auto& id : ids )
+         f.insert( id );
+      for( const auto& id : ids )
+         BOOST_REQUIRE( f.contains( id ) );
+      BOOST_CHECK_EQUAL( f.element_count(), n );
+
+      const size_t trials = 1000000;
+      size_t positives = 0;
+      for( uint64_t i = 0; i < trials; ++i )
+         positives += f.contains( i );
+      const double measured = double( positives ) / trials;
+      std::cout << n << " keys at " << p << ": " << f.size() / double( n ) << " bits per key, k " << f.hash_count()
+                << ", measured rate " << measured << ", effective_fpp " << f.effective_fpp() << std::endl;
+      BOOST_CHECK_LE( f.effective_fpp(), p );
+      BOOST_CHECK_LE( measured, 1.5 * p + 10.0 / trials );
+   }
+
+   BOOST_CHECK_THROW( blocked_bloom_filter( 0, 0.01 ), fc::exception );
+   BOOST_CHECK_THROW( blocked_bloom_filter( 100, 0.0 ), fc::exception );
+   blocked_bloom_filter empty;
+   BOOST_CHECK( !empty );
+   BOOST_CHECK( !empty.contains( std::string( "a" ) ) );
+   BOOST_CHECK_THROW( empty.insert( std::string( "a" ) ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(backends_match) try {
+   restore_backend restore;
+   for( uint32_t k : { 1u, 3u, 8u, 9u, 16u } ) {
+      blocked_bloom_filter f( 2000, 0.01 );
+      f.hash_count_ = k;
+      for( uint64_t i = 0; i < 1000; ++i )
+         f.insert( i );
+      for( uint64_t i = 0; i < 20000; ++i ) {
+         BOOST_REQUIRE( set_blocked_bloom_backend( blocked_bloom_backend::scalar ) );
+         const bool expected = f.contains( i );
+         BOOST_REQUIRE( expected || i >= 1000 );
+         if( set_blocked_bloom_backend( blocked_bloom_backend::avx2 ) )
+            BOOST_REQUIRE_EQUAL( f.contains( i ), expected );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(batches) try {
+   const auto ids = random_ids( 1000 );
+   blocked_bloom_filter one( 1000, 0.001 ), many( 1000, 0.001 );
+   for( const auto& id : ids )
+      one.insert( id );
+   many.insert_many( ids.data(), ids.size() );
+   BOOST_CHECK( one == many );
+
+   const auto others = random_ids( 5000 );
+   std::unique_ptr<bool[]> found( new bool[others.size()] );
+   size_t expected = 0;
+   const size_t r = many.contains_many( others.data(), others.size(), found.get() );
+   for( size_t i = 0; i < others.size(); ++i ) {
+      BOOST_REQUIRE_EQUAL( found[i], many.contains( others[i] ) );
+      expected += found[i];
+   }
+   BOOST_CHECK_EQUAL( r, expected );
+   BOOST_CHECK_EQUAL( many.contains_many( ids.data(), ids.size(), found.get() ), ids.size() );
+
+   many.clear();
+   BOOST_CHECK_EQUAL( many.element_count(), 0u );
+   BOOST_CHECK_EQUAL( many.contains_many( ids.data(), ids.size(), found.get() ), 0u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(serialization) try {
+   bloom_parameters params;
+   params.projected_element_count = 500;
+   params.false_positive_probability = 0.001;
+   blocked_bloom_filter f( params );
+   BOOST_CHECK_EQUAL( f.seed_, params.random_seed );
+   for( uint64_t i = 0; i < 400; ++i )
+      f.insert( i );
+
+   const auto packed = fc::raw::pack( f );
+   BOOST_CHECK_EQUAL( packed.size(), fc::raw::pack_size( f ) );
+   const auto unpacked = fc::raw::unpack<blocked_bloom_filter>( packed );
+   BOOST_CHECK( unpacked == f );
+   for( uint64_t i = 0; i < 400; ++i )
+      BOOST_REQUIRE( unpacked.contains( i ) );
+
+   fc::variant v;
+   fc::to_variant( f, v );
+   blocked_bloom_filter from_v;
+   fc::from_variant( v, from_v );
+   BOOST_CHECK( from_v == f );
+   BOOST_CHECK( from_v != blocked_bloom_filter( params ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(throughput, * boost::unit_test::disabled()) try {
+   restore_backend restore;
+   const size_t n = 2000000;
+   const double p = 0.001;
+   const auto ids = random_ids( n );
+   const auto others = random_ids( n );
+   std::unique_ptr<bool[]> found( new bool[n] );
+
+   bloom_parameters params;
+   params.projected_element_count = n;
+   params.false_positive_probability = p;
+   params.compute_optimal_parameters();
+   bloom_filter classic( params );
+   const double classic_insert = seconds( [&]() {
+      for( const auto& id : ids )
+         classic.insert( id );
+   } );
+   size_t hits = 0;
+   const double classic_contains = seconds( [&]() {
+      for( const auto& id : others )
+         hits += classic.contains( id );
+   } );
+   std::cout << "bloom_filter " << n << " sha256 keys, " << classic.size() / 8 / 1024 << " KiB: insert "
+             << n / classic_insert / 1e6 << " M/s, contains " << n / classic_contains / 1e6 << " M/s, rate "
+             << double( hits ) / n << std::endl;
+
+   blocked_bloom_filter blocked( params );
+   const double blocked_insert = seconds( [&]() {
+      for( const auto& id : ids )
+         blocked.insert( id );
+   } );
+   blocked.clear();
+   const double batch_insert = seconds( [&]() { blocked.insert_many( ids.data(), ids.size() ); } );
+   std::cout << "blocked_bloom_filter " << blocked.size() / 8 / 1024 << " KiB: insert " << n / blocked_insert / 1e6
+             << " M/s, insert_many " << n / batch_insert / 1e6 << " M/s" << std::endl;
+
+   for( auto b : { blocked_bloom_backend::scalar, blocked_bloom_backend::avx2 } ) {
+      if( !set_blocked_bloom_backend( b ) )
+         continue;
+      hits = 0;
+      const double single = seconds( [&]() {
+         for( const auto& id : others )
+            hits += blocked.contains( id );
+      } );
+      size_t batch_hits = 0;
+      const double batch = seconds( [&]() { batch_hits = blocked.contains_many( others.data(), others.size(), found.get() ); } );
+      BOOST_CHECK_EQUAL( hits, batch_hits );
+      std::cout << "blocked_bloom_filter " << ( b == blocked_bloom_backend::avx2 ? "avx2" : "scalar" )
+                << ": contains " << n / single / 1e6 << " M/s, contains_many " << n / batch / 1e6
+                << " M/s, rate " << double( hits ) / n << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
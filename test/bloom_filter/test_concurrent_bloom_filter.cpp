@@ -0,0 +1,189 @@
+#define BOOST_TEST_MODULE concurrent_bloom_filter
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/concurrent_bloom_filter.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using namespace fc;
+
+namespace {
+
+/// runs @p f( thread index ) on @p n threads, released together
+template<typename F>
+void run_threads( size_t n, F&& f ) {
+   std::atomic<bool> go{ false };
+   std::vector<std::thread> threads;
+   for( size_t t = 0; t < n; ++t )
+      threads.emplace_back( [&, t]() {
+         while( !go.load() )
+            std::this_thread::yield();
+         f( t );
+      } );
+   go = true;
+   for( auto& t : threads )
+      t.join();
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(concurrent_bloom_filter_suite)
+
+BOOST_AUTO_TEST_CASE(same_bits_as_blocked) try {
+   const uint64_t n = 200000;
+   concurrent_bloom_filter f( n, 0.001, 11 );
+   blocked_bloom_filter expected( n, 0.001, 11 );
+   BOOST_CHECK_EQUAL( f.size(), expected.size() );
+   BOOST_CHECK_EQUAL( f.hash_count(), expected.hash_count() );
+   for( uint64_t i = 0; i < n; ++i )
+      expected.insert( i );
+
+   // threads insert interleaved ranges, every key twice
+   const size_t threads = 4;
+   std::atomic<uint64_t> fresh{ 0 };
+   run_threads( threads, [&]( size_t t ) {
+      uint64_t mine = 0;
+      for( int pass = 0; pass < 2; ++pass )
+         for( uint64_t i = t; i < n; i += threads )
+            mine += f.insert( i );
+      fresh += mine;
+   } );
+   for( uint64_t i = 0; i < n; ++i )
+      BOOST_REQUIRE( f.contains( i ) );
+   // the second insert of a key is never new, the first one nearly always
+   BOOST_CHECK_EQUAL( fresh.load(), f.element_count() );
+   BOOST_CHECK_LE( f.element_count(), n );
+   BOOST_CHECK_GE( f.element_count(), n * 99 / 100 );
+
+   auto snap = f.snapshot();
+   BOOST_CHECK( snap.blocks_ == expected.blocks_ );
+   BOOST_CHECK_EQUAL( snap.seed_, 11u );
+   for( uint64_t i = 0; i < n; ++i )
+      BOOST_REQUIRE( snap.contains( i ) );
+
+   f.clear();
+   BOOST_CHECK_EQUAL( f.element_count(), 0u );
+   BOOST_CHECK( !f.contains( uint64_t( 1 ) ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(readers_during_inserts) try {
+   // readers never miss a key whose insert has finished
+   const uint64_t n = 100000;
+   concurrent_bloom_filter f( n, 0.01 );
+   std::atomic<uint64_t> published{ 0 };
+   std::atomic<uint64_t> misses{ 0 };
+   run_threads( 4, [&]( size_t t ) {
+      if( t == 0 ) {
+         for( uint64_t i = 0; i < n; ++i ) {
+            f.insert( i );
+            published.store( i + 1, std::memory_order_release );
+         }
+         return;
+      }
+      uint64_t done;
+      do {
+         done = published.load( std::memory_order_acquire );
+         for( uint64_t i = done > 64 ? done - 64 : 0; i < done; ++i )
+            if( !f.contains( i ) )
+               ++misses;
+      } while( done < n );
+   } );
+   BOOST_CHECK_EQUAL( misses.load(), 0u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(rotating_by_count) try {
+   const uint64_t keys = 1000;
+   rotating_bloom_filter f( 3, keys, fc::microseconds(), 0.001 );
+   BOOST_CHECK_EQUAL( f.generations(), 3u );
+   BOOST_CHECK_THROW( rotating_bloom_filter( 1, keys, fc::microseconds(), 0.001 ), fc::exception );
+
+   // the first 500 keys are refreshed in every generation, the rest are inserted once
+   uint64_t next = 1000000;
+   size_t false_seen = 0;
+   for( int g = 0; g < 6; ++g ) {
+      for( uint64_t i = 0; i < 500; ++i )
+         BOOST_REQUIRE_EQUAL( f.insert( i ), g == 0 );
+      while( f.rotations() == uint64_t( g ) )
+         false_seen += !f.insert( next++ );
+   }
+   BOOST_CHECK_LE( false_seen, 20u );
+   BOOST_CHECK_EQUAL( f.rotations(), 6u );
+   // a generation ends within a check interval of its size
+   BOOST_CHECK_LE( next - 1000000, 6 * ( keys - 500 ) + 6 * 64 );
+   for( uint64_t i = 0; i < 500; ++i )
+      BOOST_REQUIRE( f.contains( i ) );
+   // the keys of the last two ended generations and the current one are in the window, older ones are not
+   size_t old_seen = 0;
+   for( uint64_t k = 1000000; k < 1000000 + 1000; ++k )
+      old_seen += f.contains( k );
+   BOOST_CHECK_LE( old_seen, 10u );
+   for( uint64_t k = next - 600; k < next; ++k )
+      BOOST_REQUIRE( f.contains( k ) );
+   BOOST_CHECK_LT( f.effective_fpp(), 0.001 * 1.5 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(rotating_by_age) try {
+   rotating_bloom_filter f( 2, 1000, fc::milliseconds( 100 ), 0.01 );
+   const auto start = fc::time_point::now();
+   BOOST_CHECK( f.insert( std::string( "tx" ) ) );
+   BOOST_CHECK( !f.insert( std::string( "tx" ) ) );
+   BOOST_CHECK( !f.maybe_rotate( start ) );
+   BOOST_CHECK( f.maybe_rotate( start + fc::milliseconds( 200 ) ) );
+   // still in the previous generation
+   BOOST_CHECK( f.contains( std::string( "tx" ) ) );
+   BOOST_CHECK( !f.maybe_rotate( start + fc::milliseconds( 250 ) ) );
+   BOOST_CHECK( f.maybe_rotate( start + fc::milliseconds( 400 ) ) );
+   BOOST_CHECK( !f.contains( std::string( "tx" ) ) );
+   BOOST_CHECK_EQUAL( f.rotations(), 2u );
+
+   f.rotate();
+   BOOST_CHECK_EQUAL( f.rotations(), 3u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(rotating_under_contention) try {
+   // threads insert disjoint keys, each twice, while generations end: the second insert never finds the key
+   // new, and recent keys are never missing
+   const uint64_t keys = 20000;
+   rotating_bloom_filter f( 4, keys, fc::microseconds(), 0.001 );
+   const size_t threads = 4;
+   const uint64_t per_thread = 100000;
+   std::atomic<uint64_t> duplicates{ 0 }, repeats{ 0 }, misses{ 0 };
+   run_threads( threads, [&]( size_t t ) {
+      for( uint64_t i = 0; i < per_thread; ++i ) {
+         const uint64_t k = t * per_thread + i;
+         if( !f.insert( k ) )
+            ++duplicates;
+         if( f.insert( k ) )
+            ++repeats;
+         if( i >= 100 && !f.contains( k - 100 ) )
+            ++misses;
+      }
+   } );
+   BOOST_CHECK_EQUAL( misses.load(), 0u );
+   BOOST_CHECK_EQUAL( repeats.load(), 0u );
+   // only false positives of the window make a new key look seen
+   BOOST_CHECK_LE( duplicates.load(), threads * per_thread * 0.001 * 3 );
+   BOOST_CHECK_GE( f.rotations(), threads * per_thread / keys - 1 );
+   std::cout << "rotating filter: " << f.rotations() << " rotations, " << duplicates.load() << " false duplicates of "
+             << threads * per_thread << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(insert_throughput, * boost::unit_test::disabled()) try {
+   const uint64_t n = 4000000;
+   for( size_t threads : { 1, 2, 4 } ) {
+      concurrent_bloom_filter f( n, 0.001 );
+      const double us = fc::benchmark::elapsed_us( [&]() {
+         run_threads( threads, [&]( size_t t ) {
+            for( uint64_t i = t; i < n; i += threads )
+               f.insert( i );
+         } );
+      } );
+      std::cout << "concurrent_bloom_filter " << threads << " threads (" << std::thread::hardware_concurrency()
+                << " cpus): " << n / us << " M inserts/s" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
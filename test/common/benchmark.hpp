@@ -0,0 +1,35 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+/**
+ *  Timing helpers for the benchmark cases of the unit tests. Benchmark cases are declared with
+ *  boost::unit_test::disabled() so the ctest run only checks behaviour; run one by naming it, as in
+ *  "test_merkle --run_test=merkle/million_leaves".
+ */
+namespace fc { namespace benchmark {
+
+   /// microseconds taken by f()
+   template<typename F>
+   double elapsed_us( F&& f ) {
+      const auto start = std::chrono::steady_clock::now();
+      f();
+      return std::chrono::duration<double, std::micro>( std::chrono::steady_clock::now() - start ).count();
+   }
+
+   /// mean nanoseconds per call of f( i ) for i in [0, n)
+   template<typename F>
+   double ns_per_call( size_t n, F&& f ) {
+      return elapsed_us( [&]() {
+         for( size_t i = 0; i < n; ++i )
+            f( i );
+      } ) * 1000 / n;
+   }
+
+   /// calls of f( i ) per second, for i in [0, n)
+   template<typename F>
+   double per_second( size_t n, F&& f ) {
+      return 1e9 / ns_per_call( n, f );
+   }
+
+} } // fc::benchmark
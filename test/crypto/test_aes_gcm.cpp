@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE aes_gcm
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/aes.hpp>
+#include <fc/crypto/aes_gcm.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+std::vector<char> unhex( const std::string& h ) {
+   std::vector<char> r( h.size() / 2 );
+   from_hex( h, r.data(), r.size() );
+   return r;
+}
+
+template<typename A>
+A unhex_array( const std::string& h ) {
+   A a;
+   BOOST_REQUIRE_EQUAL( from_hex( h, a.data, sizeof(a.data) ), sizeof(a.data) );
+   return a;
+}
+
+std::vector<char> random_bytes( size_t n ) {
+   std::vector<char> d( n );
+   rand_bytes( d.data(), d.size() );
+   return d;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(aes_gcm_suite)
+
+BOOST_AUTO_TEST_CASE(known_answers) try {
+   // test cases 13, 14 and 16 of the GCM specification, McGrew and Viega
+   sha256 zero_key;
+   aes_gcm zero( zero_key );
+   aes_gcm::nonce_type zero_nonce = unhex_array<aes_gcm::nonce_type>( std::string( 24, '0' ) );
+   aes_gcm::tag_type tag;
+   zero.encrypt( zero_nonce, nullptr, 0, tag );
+   BOOST_CHECK_EQUAL( to_hex( tag.data, sizeof(tag.data) ), "530f8afbc74536b9a963b4f1c4cb738b" );
+
+   std::vector<char> block( 16, 0 );
+   zero.encrypt( zero_nonce, block.data(), block.size(), tag );
+   BOOST_CHECK_EQUAL( to_hex( block ), "cea7403d4d606b6e074ec5d3baf39d18" );
+   BOOST_CHECK_EQUAL( to_hex( tag.data, sizeof(tag.data) ), "d0d1c8a799996bf0265b98b5d48ab919" );
+
+   aes_gcm gcm( sha256( "feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308" ) );
+   const auto nonce = unhex_array<aes_gcm::nonce_type>( "cafebabefacedbaddecaf888" );
+   const auto plain = unhex( "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+                             "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39" );
+   const auto aad = unhex( "feedfacedeadbeeffeedfacedeadbeefabaddad2" );
+   std::vector<char> cipher( plain.size() );
+   gcm.encrypt( nonce, plain.data(), plain.size(), cipher.data(), tag, aad.data(), aad.size() );
+   BOOST_CHECK_EQUAL( to_hex( cipher ), "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+                                        "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662" );
+   BOOST_CHECK_EQUAL( to_hex( tag.data, sizeof(tag.data) ), "76fc6ece0f4e1768cddf8853bb2d551b" );
+
+   // in place, and the context is reused with a key schedule from before
+   BOOST_REQUIRE( gcm.decrypt( nonce, cipher.data(), cipher.size(), tag, aad.data(), aad.size() ) );
+   BOOST_CHECK( cipher == plain );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(tampering) try {
+   aes_gcm gcm( sha256::hash( std::string( "key" ) ) );
+   const auto plain = random_bytes( 1000 );
+   const auto nonce = aes_gcm::random_nonce();
+   const std::string aad = "header";
+   auto data = plain;
+   aes_gcm::tag_type tag;
+   gcm.encrypt( nonce, data.data(), data.size(), tag, aad.data(), aad.size() );
+   BOOST_CHECK( data != plain );
+
+   auto flipped = data;
+   flipped[500] ^= 1;
+   BOOST_CHECK( !gcm.decrypt( nonce, flipped.data(), flipped.size(), tag, aad.data(), aad.size() ) );
+   BOOST_CHECK( flipped == std::vector<char>( flipped.size(), 0 ) );
+
+   auto copy = data;
+   BOOST_CHECK( !gcm.decrypt( nonce, copy.data(), copy.size(), tag, "HEADER", 6 ) );
+   copy = data;
+   auto bad_tag = tag;
+   bad_tag.data[0] ^= 1;
+   BOOST_CHECK( !gcm.decrypt( nonce, copy.data(), copy.size(), bad_tag, aad.data(), aad.size() ) );
+   copy = data;
+   BOOST_CHECK( !aes_gcm( sha256::hash( std::string( "other" ) ) ).decrypt( nonce, copy.data(), copy.size(), tag, aad.data(), aad.size() ) );
+
+   BOOST_REQUIRE( gcm.decrypt( nonce, data.data(), data.size(), tag, aad.data(), aad.size() ) );
+   BOOST_CHECK( data == plain );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(seal_and_open) try {
+   aes_gcm gcm( sha256::hash( std::string( "key" ) ) );
+   for( size_t len : { 0, 1, 15, 16, 17, 4096 } ) {
+      const auto plain = random_bytes( len );
+      std::vector<char> sealed( len + aes_gcm::overhead );
+      gcm.seal( plain.data(), len, sealed.data() );
+      std::vector<char> opened( len );
+      BOOST_REQUIRE( gcm.open( sealed.data(), sealed.size(), opened.data() ) );
+      BOOST_CHECK( opened == plain );
+      sealed[0] ^= 1;
+      BOOST_CHECK( !gcm.open( sealed.data(), sealed.size(), opened.data() ) );
+   }
+   char short_message[10] = {};
+   BOOST_CHECK_THROW( gcm.open( short_message, sizeof(short_message), short_message ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(batches) try {
+   aes_gcm gcm( sha256::hash( std::string( "key" ) ) );
+   std::vector<std::vector<char>> plain, data;
+   std::vector<aes_gcm_message> messages( 100 );
+   for( size_t i = 0; i < messages.size(); ++i ) {
+      plain.push_back( random_bytes( i * 7 ) );
+      data.push_back( plain.back() );
+   }
+   for( size_t i = 0; i < messages.size(); ++i ) {
+      messages[i].nonce = aes_gcm::random_nonce();
+      messages[i].data = data[i].data();
+      messages[i].size = data[i].size();
+   }
+   gcm.encrypt_many( messages.data(), messages.size() );
+   for( size_t i = 0; i < messages.size(); ++i ) {
+      auto copy = plain[i];
+      aes_gcm::tag_type tag;
+      gcm.encrypt( messages[i].nonce, copy.data(), copy.size(), tag );
+      BOOST_REQUIRE( copy == data[i] );
+      BOOST_REQUIRE( tag == messages[i].tag );
+   }
+   data[3][0] ^= 1;
+   BOOST_CHECK_EQUAL( gcm.decrypt_many( messages.data(), messages.size() ), messages.size() - 1 );
+   for( size_t i = 0; i < messages.size(); ++i ) {
+      BOOST_CHECK_EQUAL( messages[i].authentic, i != 3 );
+      if( i != 3 )
+         BOOST_CHECK( data[i] == plain[i] );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(streams) try {
+   const sha256 key = sha256::hash( std::string( "stream" ) );
+   const auto base = aes_gcm::random_nonce();
+   const size_t chunk = 1000;
+   const auto plain = random_bytes( 5 * chunk + 123 );
+
+   aes_gcm_stream_encryptor enc( key, base );
+   auto data = plain;
+   std::vector<aes_gcm::tag_type> tags;
+   for( size_t off = 0; off < data.size(); off += chunk ) {
+      const size_t n = std::min( chunk, data.size() - off );
+      tags.emplace_back();
+      enc.encrypt( data.data() + off, n, tags.back(), off + n == data.size() );
+   }
+   BOOST_CHECK( enc.finished() );
+   BOOST_CHECK_EQUAL( enc.chunks(), 6u );
+   aes_gcm::tag_type spare;
+   BOOST_CHECK_THROW( enc.encrypt( data.data(), 0, spare, true ), fc::exception );
+
+   // a chunk on its own
+   {
+      aes_gcm_stream_decryptor dec( key, base );
+      std::vector<char> c( data.begin() + 2 * chunk, data.begin() + 3 * chunk );
+      BOOST_REQUIRE( dec.decrypt_at( 2, c.data(), c.size(), tags[2], false ) );
+      BOOST_CHECK( std::equal( c.begin(), c.end(), plain.begin() + 2 * chunk ) );
+      // at another position, or claimed to be the last, it is not authentic
+      c.assign( data.begin() + 2 * chunk, data.begin() + 3 * chunk );
+      BOOST_CHECK( !dec.decrypt_at( 3, c.data(), c.size(), tags[2], false ) );
+      c.assign( data.begin() + 2 * chunk, data.begin() + 3 * chunk );
+      BOOST_CHECK( !dec.decrypt_at( 2, c.data(), c.size(), tags[2], true ) );
+   }
+
+   // in order, and cut off before the last chunk
+   {
+      aes_gcm_stream_decryptor dec( key, base );
+      auto copy = data;
+      for( size_t i = 0; i < 5; ++i )
+         BOOST_REQUIRE( dec.decrypt( copy.data() + i * chunk, chunk, tags[i], false ) );
+      BOOST_CHECK( !dec.finished() );
+      BOOST_REQUIRE( dec.decrypt( copy.data() + 5 * chunk, 123, tags[5], true ) );
+      BOOST_CHECK( dec.finished() );
+      BOOST_CHECK( copy == plain );
+   }
+
+   // a chunk skipped
+   {
+      aes_gcm_stream_decryptor dec( key, base );
+      auto copy = data;
+      BOOST_REQUIRE( dec.decrypt( copy.data(), chunk, tags[0], false ) );
+      BOOST_CHECK( !dec.decrypt( copy.data() + 2 * chunk, chunk, tags[2], false ) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(throughput, * boost::unit_test::disabled()) try {
+   const sha256 key = sha256::hash( std::string( "bench" ) );
+   aes_gcm gcm( key );
+   const sha512 cbc_key = sha512::hash( std::string( "bench" ) );
+   for( size_t size : { 64, 1024, 16384, 1 << 20 } ) {
+      auto data = random_bytes( size );
+      const size_t rounds = std::max<size_t>( 16, ( 64 << 20 ) / size );
+      aes_gcm::nonce_type nonce = aes_gcm::random_nonce();
+      aes_gcm::tag_type tag;
+      const double gcm_ns = fc::benchmark::ns_per_call( rounds, [&]( size_t r ) {
+         nonce = aes_gcm::chunk_nonce( nonce, r, false );
+         gcm.encrypt( nonce, data.data(), data.size(), tag );
+      } );
+
+      const size_t cbc_rounds = rounds / 4 + 1;
+      size_t sink = 0;
+      const double cbc_ns = fc::benchmark::ns_per_call( cbc_rounds, [&]( size_t ) {
+         sink += aes_encrypt( cbc_key, data ).size();
+      } );
+      BOOST_CHECK( sink > 0 );
+
+      std::cout << size << " byte messages: aes_gcm in place " << size / gcm_ns * 1e9 / ( 1 << 20 ) << " MiB/s, "
+                << gcm_ns << " ns each; aes_encrypt cbc " << size / cbc_ns * 1e9 / ( 1 << 20 ) << " MiB/s, "
+                << cbc_ns << " ns each" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
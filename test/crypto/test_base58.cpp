@@ -0,0 +1,140 @@
+#define BOOST_TEST_MODULE base58
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/base58.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <openssl/bn.h>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+const char* alphabet = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/// a BIGNUM division per digit, as to_base58 did before the limb based encoder
+std::string bn_to_base58( const std::vector<char>& d ) {
+   BIGNUM* bn = BN_bin2bn( (const unsigned char*) d.data(), d.size(), nullptr );
+   std::string str;
+   while( !BN_is_zero( bn ) )
+      str += alphabet[BN_div_word( bn, 58 )];
+   BN_free( bn );
+   for( size_t i = 0; i < d.size() && d[i] == 0; ++i )
+      str += alphabet[0];
+   std::reverse( str.begin(), str.end() );
+   return str;
+}
+
+/// the Bitcoin decoder on BIGNUM, false where from_base58 throws
+bool bn_from_base58( const char* psz, std::vector<char>& out ) {
+   while( isspace( (unsigned char) *psz ) )
+      psz++;
+   BIGNUM* bn = BN_new();
+   for( const char* p = psz; *p; p++ ) {
+      const char* p1 = strchr( alphabet, *p );
+      if( p1 == nullptr ) {
+         while( isspace( (unsigned char) *p ) )
+            p++;
+         if( *p != '\0' ) {
+            BN_free( bn );
+            return false;
+         }
+         break;
+      }
+      BN_mul_word( bn, 58 );
+      BN_add_word( bn, p1 - alphabet );
+   }
+   size_t zeros = 0;
+   for( const char* p = psz; *p == alphabet[0]; p++ )
+      zeros++;
+   out.assign( zeros + BN_num_bytes( bn ), 0 );
+   BN_bn2bin( bn, (unsigned char*) out.data() + zeros );
+   BN_free( bn );
+   return true;
+}
+
+std::vector<char> random_bytes( size_t n, size_t zeros ) {
+   std::vector<char> d( n );
+   rand_bytes( d.data(), d.size() );
+   for( size_t i = 0; i < zeros && i < n; ++i )
+      d[i] = 0;
+   if( zeros < n && d[zeros] == 0 )
+      d[zeros] = 1;
+   return d;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(base58)
+
+BOOST_AUTO_TEST_CASE(known_values) try {
+   BOOST_CHECK_EQUAL( to_base58( std::vector<char>(), {} ), "" );
+   BOOST_CHECK_EQUAL( to_base58( std::vector<char>( 3, 0 ), {} ), "111" );
+   const std::string hello = "hello world";
+   BOOST_CHECK_EQUAL( to_base58( hello.data(), hello.size(), {} ), "StV1DL6CwTryKyV" );
+   const auto decoded = from_base58( "StV1DL6CwTryKyV" );
+   BOOST_CHECK_EQUAL( std::string( decoded.begin(), decoded.end() ), hello );
+   BOOST_CHECK( from_base58( "" ).empty() );
+   BOOST_CHECK( from_base58( "11" ) == std::vector<char>( 2, 0 ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(matches_bignum) try {
+   for( size_t n = 0; n <= 140; ++n ) {
+      for( size_t zeros : { 0, 1, 3 } ) {
+         const auto d = random_bytes( n, zeros );
+         const std::string expected = bn_to_base58( d );
+         const std::string encoded = to_base58( d.data(), d.size(), {} );
+         BOOST_REQUIRE_EQUAL( encoded, expected );
+         BOOST_REQUIRE( from_base58( encoded ) == d );
+
+         std::vector<char> out( n );
+         BOOST_REQUIRE_EQUAL( from_base58( encoded, out.data(), out.size() ), n );
+         BOOST_REQUIRE( out == d );
+      }
+   }
+   // all ones and a long input past the stack buffers
+   for( size_t n : { 33, 37, 65, 69, 300 } ) {
+      std::vector<char> d( n, char( 0xff ) );
+      BOOST_REQUIRE_EQUAL( to_base58( d.data(), d.size(), {} ), bn_to_base58( d ) );
+      BOOST_REQUIRE( from_base58( to_base58( d.data(), d.size(), {} ) ) == d );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(decoder_rules) try {
+   for( const char* s : { "  StV1DL6CwTryKyV", "StV1DL6CwTryKyV \t\n", "\n1", "   ", "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz",
+                          "StV1 DL6", "StV0DL6", "StVIDL6", "Oo", "l", "1+", "\xff" } ) {
+      std::vector<char> expected;
+      const bool ok = bn_from_base58( s, expected );
+      if( ok ) {
+         BOOST_CHECK( from_base58( s ) == expected );
+      } else {
+         BOOST_CHECK_THROW( from_base58( s ), fc::parse_error_exception );
+      }
+   }
+   char small[4];
+   BOOST_CHECK_THROW( from_base58( "StV1DL6CwTryKyV", small, sizeof(small) ), fc::assert_exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(base58_per_second, * boost::unit_test::disabled()) try {
+   for( size_t n : { 33, 37, 65, 69 } ) {
+      std::vector<std::vector<char>> data;
+      for( int i = 0; i < 2000; ++i )
+         data.push_back( random_bytes( n, 0 ) );
+      std::vector<std::string> strs( data.size() );
+
+      auto per_second = [&]( auto&& f ) { return fc::benchmark::per_second( data.size(), f ); };
+      const double bn_encode = per_second( [&]( size_t i ) { strs[i] = bn_to_base58( data[i] ); } );
+      const double encode = per_second( [&]( size_t i ) { strs[i] = to_base58( data[i].data(), data[i].size(), {} ); } );
+      std::vector<char> out;
+      const double bn_decode = per_second( [&]( size_t i ) { bn_from_base58( strs[i].c_str(), out ); } );
+      std::vector<std::vector<char>> decoded( data.size() );
+      const double decode = per_second( [&]( size_t i ) { decoded[i] = from_base58( strs[i] ); } );
+      BOOST_REQUIRE( decoded == data );
+      std::cout << n << " bytes: encode " << encode << "/s (BIGNUM " << bn_encode << "/s), decode " << decode
+                << "/s (BIGNUM " << bn_decode << "/s)" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE crc32c
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/crc32c.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/array.hpp>
+#include <fc/uint128.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+const crc32c_backend all_backends[] = { crc32c_backend::table, crc32c_backend::sse42, crc32c_backend::pclmul };
+
+const char* backend_name( crc32c_backend b ) {
+   switch( b ) {
+      case crc32c_backend::table: return "table";
+      case crc32c_backend::sse42: return "sse42";
+      case crc32c_backend::pclmul: return "pclmul";
+   }
+   return "";
+}
+
+/// bit at a time, the definition
+uint32_t reference_crc32c( const char* d, size_t len, uint32_t seed ) {
+   uint32_t crc = ~seed;
+   for( size_t i = 0; i < len; ++i ) {
+      crc ^= uint8_t( d[i] );
+      for( int k = 0; k < 8; ++k )
+         crc = crc & 1 ? ( crc >> 1 ) ^ 0x82f63b78 : crc >> 1;
+   }
+   return ~crc;
+}
+
+struct restore_backend {
+   crc32c_backend b = get_crc32c_backend();
+   ~restore_backend() { set_crc32c_backend( b ); }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(crc32c_suite)
+
+BOOST_AUTO_TEST_CASE(known_values) try {
+   restore_backend restore;
+   for( auto b : all_backends ) {
+      if( !set_crc32c_backend( b ) )
+         continue;
+      BOOST_CHECK_EQUAL( crc32c( "", 0 ), 0u );
+      BOOST_CHECK_EQUAL( crc32c( "123456789", 9 ), 0xe3069283u );
+      // RFC 3720 B.4, 32 bytes of zeros and of ones
+      const std::string zeros( 32, '\0' ), ones( 32, '\xff' );
+      BOOST_CHECK_EQUAL( crc32c( zeros.data(), zeros.size() ), 0x8a9136aau );
+      BOOST_CHECK_EQUAL( crc32c( ones.data(), ones.size() ), 0x62a8ab43u );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(backends_match) try {
+   restore_backend restore;
+   std::vector<char> buf( 3 * 4096 * 2 + 3 * 256 * 3 + 100 );
+   rand_bytes( buf.data(), buf.size() );
+   std::vector<size_t> lengths = { 0, 1, 7, 8, 9, 63, 767, 768, 769, 3 * 4096 - 1, 3 * 4096, 3 * 4096 + 3 * 256 + 17 };
+   lengths.push_back( buf.size() - 8 );
+   for( auto b : all_backends ) {
+      if( !set_crc32c_backend( b ) ) {
+         BOOST_TEST_MESSAGE( "skipping " << backend_name( b ) );
+         continue;
+      }
+      for( size_t offset = 0; offset < 8; ++offset ) {
+         for( size_t len : lengths ) {
+            const uint32_t seed = uint32_t( len * 2654435761u + offset );
+            BOOST_REQUIRE_EQUAL( crc32c( buf.data() + offset, len, seed ), reference_crc32c( buf.data() + offset, len, seed ) );
+         }
+      }
+      // chained calls are the crc of the whole
+      const uint32_t whole = crc32c( buf.data(), buf.size() );
+      for( size_t split : { size_t( 1 ), size_t( 1000 ), buf.size() / 2 } )
+         BOOST_CHECK_EQUAL( crc32c( buf.data() + split, buf.size() - split, crc32c( buf.data(), split ) ), whole );
+   }
+   BOOST_CHECK( set_crc32c_backend( crc32c_backend::table ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(city_hash_crc_backends_match) try {
+   restore_backend restore;
+   std::vector<char> buf( 5000 );
+   rand_bytes( buf.data(), buf.size() );
+   for( size_t len : { 0, 10, 239, 240, 241, 901, 5000 } ) {
+      BOOST_REQUIRE( set_crc32c_backend( crc32c_backend::table ) );
+      const auto h256 = city_hash_crc_256( buf.data(), len );
+      const auto h128 = city_hash_crc_128( buf.data(), len );
+      for( auto b : { crc32c_backend::sse42, crc32c_backend::pclmul } ) {
+         if( !set_crc32c_backend( b ) )
+            continue;
+         BOOST_REQUIRE( city_hash_crc_256( buf.data(), len ) == h256 );
+         BOOST_REQUIRE( city_hash_crc_128( buf.data(), len ) == h128 );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(crc32c_throughput, * boost::unit_test::disabled()) try {
+   restore_backend restore;
+   std::vector<char> buf( 1 << 20 );
+   rand_bytes( buf.data(), buf.size() );
+   std::cout << "default crc32c backend: " << backend_name( restore.b ) << std::endl;
+   for( size_t size : { 64, 4096, 1 << 20 } ) {
+      const size_t rounds = ( 64 << 20 ) / size;
+      for( auto b : all_backends ) {
+         if( !set_crc32c_backend( b ) )
+            continue;
+         uint32_t crc = 0;
+         const double per_second = fc::benchmark::per_second( rounds, [&]( size_t ) {
+            crc = crc32c( buf.data(), size, crc );
+         } );
+         std::cout << "crc32c " << backend_name( b ) << " " << size << " bytes: "
+                   << per_second * size / ( 1 << 20 ) << " MiB/s (" << crc << ")" << std::endl;
+      }
+   }
+   for( auto b : { crc32c_backend::table, crc32c_backend::sse42 } ) {
+      if( !set_crc32c_backend( b ) )
+         continue;
+      uint64_t sum = 0;
+      const double per_second = fc::benchmark::per_second( 64, [&]( size_t ) {
+         sum += city_hash_crc_256( buf.data(), buf.size() )[0];
+      } );
+      std::cout << "city_hash_crc_256 " << backend_name( b ) << " 1 MiB: " << per_second << " MiB/s (" << sum << ")"
+                << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,206 @@
+#define BOOST_TEST_MODULE digest_encoders
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/hmac.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/io/varint.hpp>
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+using fc::benchmark::per_second;
+
+namespace {
+
+struct test_action {
+   uint64_t                                  account = 0;
+   uint64_t                                  name = 0;
+   std::vector<std::pair<uint64_t,uint64_t>> authorization;
+   std::vector<char>                         data;
+};
+
+struct test_transaction {
+   uint32_t                  expiration = 0;
+   uint16_t                  ref_block_num = 0;
+   uint32_t                  ref_block_prefix = 0;
+   fc::unsigned_int          max_net_usage_words;
+   uint8_t                   max_cpu_usage_ms = 0;
+   fc::unsigned_int          delay_sec;
+   std::vector<test_action>  context_free_actions;
+   std::vector<test_action>  actions;
+};
+
+} // anonymous namespace
+
+FC_REFLECT( test_action, (account)(name)(authorization)(data) )
+FC_REFLECT( test_transaction, (expiration)(ref_block_num)(ref_block_prefix)(max_net_usage_words)(max_cpu_usage_ms)
+                              (delay_sec)(context_free_actions)(actions) )
+
+namespace {
+
+test_transaction make_transaction( uint32_t i ) {
+   test_transaction t;
+   t.expiration = 1600000000 + i;
+   t.ref_block_num = i & 0xffff;
+   t.ref_block_prefix = i * 2654435761u;
+   for( int a = 0; a < 2; ++a ) {
+      test_action act;
+      act.account = 0x5530ea033482a600ull + a;
+      act.name = 0xcdcd3c2d57000000ull;
+      act.authorization = { { 0x3232eda800000000ull + i, 0x00000000a8ed3232ull } };
+      act.data.resize( 40 + i % 50 );
+      for( size_t j = 0; j < act.data.size(); ++j )
+         act.data[j] = char( i + j );
+      t.actions.push_back( act );
+   }
+   return t;
+}
+
+/// a SHA256_Update for every write, what sha256::encoder did before staging
+struct unstaged_sha256_encoder {
+   SHA256_CTX ctx;
+   unstaged_sha256_encoder() { SHA256_Init( &ctx ); }
+   void write( const char* d, uint32_t dlen ) { SHA256_Update( &ctx, d, dlen ); }
+   void put( char c ) { write( &c, 1 ); }
+   sha256 result() {
+      sha256 h;
+      SHA256_Final( (uint8_t*) h.data(), &ctx );
+      return h;
+   }
+};
+
+template<typename H>
+void check_split_writes() {
+   std::vector<char> buf( 1000 );
+   rand_bytes( buf.data(), buf.size() );
+   const H expected = H::hash( buf.data(), buf.size() );
+   for( int round = 0; round < 50; ++round ) {
+      typename H::encoder e;
+      e.write( "garbage", 7 );
+      e.reset();
+      size_t pos = 0;
+      while( pos < buf.size() ) {
+         uint32_t n = 0;
+         rand_bytes( (char*) &n, sizeof(n) );
+         n = std::min<size_t>( n % 200, buf.size() - pos );
+         if( n == 1 )
+            e.put( buf[pos] );
+         else
+            e.write( buf.data() + pos, n );
+         pos += n;
+      }
+      BOOST_REQUIRE( e.result() == expected );
+   }
+
+   // a copy carries on from the staged bytes
+   typename H::encoder e;
+   e.write( buf.data(), 10 );
+   typename H::encoder copy( e );
+   copy.write( buf.data() + 10, buf.size() - 10 );
+   BOOST_CHECK( copy.result() == expected );
+   copy = e;
+   copy.write( buf.data() + 10, buf.size() - 10 );
+   BOOST_CHECK( copy.result() == expected );
+}
+
+template<typename H>
+void check_hmac( const EVP_MD* md ) {
+   std::vector<char> key( 300 ), msg( 500 );
+   rand_bytes( key.data(), key.size() );
+   rand_bytes( msg.data(), msg.size() );
+   for( uint32_t key_len : { 0, 1, 20, 63, 64, 65, 127, 128, 129, 300 } ) {
+      hmac<H> keyed( key.data(), key_len );
+      for( uint32_t msg_len : { 0, 1, 55, 64, 200, 500 } ) {
+         unsigned char expected[EVP_MAX_MD_SIZE];
+         unsigned int expected_len = 0;
+         HMAC( md, key.data(), key_len, (const unsigned char*) msg.data(), msg_len, expected, &expected_len );
+         const H h = hmac<H>().digest( key.data(), key_len, msg.data(), msg_len );
+         BOOST_REQUIRE_EQUAL( h.data_size(), expected_len );
+         BOOST_REQUIRE( memcmp( h.data(), expected, expected_len ) == 0 );
+         BOOST_REQUIRE( keyed.digest( msg.data(), msg_len ) == h );
+      }
+   }
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(digest_encoders)
+
+BOOST_AUTO_TEST_CASE(split_writes) try {
+   check_split_writes<sha256>();
+   check_split_writes<sha512>();
+   check_split_writes<ripemd160>();
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(packed_structs) try {
+   for( uint32_t i = 0; i < 100; ++i ) {
+      const auto t = make_transaction( i );
+      const auto packed = fc::raw::pack( t );
+      BOOST_REQUIRE( sha256::hash( t ) == sha256::hash( packed.data(), packed.size() ) );
+      BOOST_REQUIRE( ripemd160::hash( t ) == ripemd160::hash( packed.data(), packed.size() ) );
+      sha512::encoder e;
+      fc::raw::pack( e, t );
+      BOOST_REQUIRE( e.result() == sha512::hash( packed.data(), packed.size() ) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(hmac_matches_openssl) try {
+   check_hmac<sha224>( EVP_sha224() );
+   check_hmac<sha256>( EVP_sha256() );
+   check_hmac<sha512>( EVP_sha512() );
+
+   // RFC 4231 test case 2
+   const std::string key = "Jefe", msg = "what do ya want for nothing?";
+   BOOST_CHECK_EQUAL( hmac_sha256( key.data(), key.size() ).digest( msg.data(), msg.size() ).str(),
+                      "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" );
+
+   // no key to precompute from
+   BOOST_CHECK_THROW( hmac_sha256().digest( msg.data(), msg.size() ), fc::assert_exception );
+   hmac_sha256 late;
+   late.set_key( key.data(), key.size() );
+   BOOST_CHECK_EQUAL( late.digest( msg.data(), msg.size() ).str(), "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(encoder_benchmarks, * boost::unit_test::disabled()) try {
+   const size_t n = 20000;
+   std::vector<test_transaction> trxs;
+   for( uint32_t i = 0; i < n; ++i )
+      trxs.push_back( make_transaction( i ) );
+   std::vector<sha256> expected( n ), ids( n );
+
+   const double packed = per_second( n, [&]( size_t i ) {
+      const auto p = fc::raw::pack( trxs[i] );
+      expected[i] = sha256::hash( p.data(), p.size() );
+   } );
+   const double unstaged = per_second( n, [&]( size_t i ) {
+      unstaged_sha256_encoder e;
+      fc::raw::pack( e, trxs[i] );
+      ids[i] = e.result();
+   } );
+   BOOST_REQUIRE( ids == expected );
+   const double staged = per_second( n, [&]( size_t i ) { ids[i] = sha256::hash( trxs[i] ); } );
+   BOOST_REQUIRE( ids == expected );
+   std::cout << "transaction ids: pack then hash " << packed << "/s, encoder with an update per field "
+             << unstaged << "/s, staged encoder " << staged << "/s" << std::endl;
+
+   const std::string key( 32, 'k' );
+   const auto& msg = expected;
+   hmac_sha256 keyed( key.data(), key.size() );
+   const double per_call = per_second( n, [&]( size_t i ) {
+      ids[i] = hmac_sha256().digest( key.data(), key.size(), msg[i].data(), msg[i].data_size() );
+   } );
+   std::vector<sha256> macs( n );
+   const double precomputed = per_second( n, [&]( size_t i ) {
+      macs[i] = keyed.digest( msg[i].data(), msg[i].data_size() );
+   } );
+   BOOST_REQUIRE( macs == ids );
+   std::cout << "hmac_sha256 of 32 bytes: key per call " << per_call << "/s, precomputed key " << precomputed
+             << "/s" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+#define BOOST_TEST_MODULE ecc_context
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/private_key.hpp>
+#include <fc/crypto/public_key.hpp>
+#include "benchmark.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using namespace fc::crypto;
+using namespace fc;
+using fc::benchmark::elapsed_us;
+
+BOOST_AUTO_TEST_SUITE(ecc_context)
+
+// run on its own, before anything in the process has created the context
+BOOST_AUTO_TEST_CASE(startup_latency, * boost::unit_test::disabled()) try {
+   const auto key = private_key::regenerate<ecc::private_key_shim>( sha256::hash( std::string( "startup" ) ) );
+   const auto digest = sha256::hash( std::string( "first" ) );
+
+   const double init = elapsed_us( []() { ecc::init_context(); } );
+   signature sig;
+   const double first = elapsed_us( [&]() { sig = key.sign( digest ); } );
+   BOOST_CHECK( public_key( sig, digest ) == key.get_public_key() );
+
+   const int iterations = 100;
+   const double steady = elapsed_us( [&]() {
+      for( int i = 0; i < iterations; ++i )
+         key.sign( digest );
+   } ) / iterations;
+
+   std::cout << "secp256k1 init_context " << init << " us, first signature after init " << first
+             << " us, steady state " << steady << " us; without init_context the first signature also pays the "
+             << init << " us context creation" << std::endl;
+
+   ecc::init_context( true );
+   bool recovered = false;
+   double clone = 0;
+   std::thread( [&]() {
+      clone = elapsed_us( [&]() { recovered = public_key( key.sign( digest ), digest ) == key.get_public_key(); } );
+   } ).join();
+   ecc::init_context( false );
+   BOOST_CHECK( recovered );
+   std::cout << "first sign and recover on a new thread, including its context clone: " << clone << " us" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(per_thread_contexts) try {
+   std::vector<private_key> keys;
+   for( int i = 0; i < 8; ++i )
+      keys.push_back( private_key::generate<ecc::private_key_shim>() );
+
+   ecc::init_context( true );
+   std::atomic<int> failures{0};
+   std::vector<std::thread> threads;
+   for( int t = 0; t < 4; ++t )
+      threads.emplace_back( [&, t]() {
+         for( int i = 0; i < 20; ++i ) {
+            const auto& k = keys[( t + i ) % keys.size()];
+            const auto d = sha256::hash( std::to_string( t * 100 + i ) );
+            if( public_key( k.sign( d ), d ) != k.get_public_key() )
+               ++failures;
+         }
+      } );
+   for( auto& t : threads )
+      t.join();
+   BOOST_CHECK_EQUAL( failures.load(), 0 );
+
+   ecc::init_context( false );
+   const auto d = sha256::hash( std::string( "shared" ) );
+   BOOST_CHECK( public_key( keys[0].sign( d ), d ) == keys[0].get_public_key() );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE ecc_recovery
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+#ifdef FC_TEST_BUNDLED_SECP256K1
+# ifdef FC_SECP256K1_ZKP_PREFIX
+#  include <secp256k1_zkp_prefix.h>
+# endif
+# include <secp256k1.h>
+#endif
+
+using namespace fc;
+
+namespace {
+
+struct recovery_set {
+   std::vector<ecc::compact_signature>  sigs;
+   std::vector<sha256>                  digests;
+   std::vector<ecc::public_key_data>    keys;
+};
+
+recovery_set make_set( size_t n ) {
+   recovery_set s;
+   for( size_t i = 0; i < n; ++i ) {
+      auto k = ecc::private_key::regenerate( sha256::hash( "key" + std::to_string( i % 16 ) ) );
+      s.digests.push_back( sha256::hash( std::to_string( i ) ) );
+      s.sigs.push_back( k.sign_compact( s.digests.back() ) );
+      s.keys.push_back( k.get_public_key().serialize() );
+   }
+   return s;
+}
+
+#ifdef FC_TEST_BUNDLED_SECP256K1
+/// recovers key i of @p s with the bundled secp256k1-zkp called directly
+bool bundled_recovers( const secp256k1_context_t* ctx, const recovery_set& s, size_t i ) {
+   ecc::public_key_data key;
+   int len = 0;
+   return secp256k1_ecdsa_recover_compact( ctx, (const unsigned char*) s.digests[i].data(), s.sigs[i].begin() + 1,
+                                           (unsigned char*) key.begin(), &len, 1, ( s.sigs[i].begin()[0] - 27 ) & 3 ) &&
+          key == s.keys[i];
+}
+#endif
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(ecc_recovery)
+
+BOOST_AUTO_TEST_CASE(recovers_signing_keys) try {
+   const auto s = make_set( 100 );
+   for( size_t i = 0; i < s.sigs.size(); ++i )
+      BOOST_REQUIRE( ecc::public_key( s.sigs[i], s.digests[i] ).serialize() == s.keys[i] );
+
+#ifdef FC_TEST_BUNDLED_SECP256K1
+   // signatures made by the configured backend recover to the same keys in the bundled secp256k1-zkp
+   const secp256k1_context_t* ctx = secp256k1_context_create( SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN );
+   for( size_t i = 0; i < s.sigs.size(); ++i )
+      BOOST_REQUIRE( bundled_recovers( ctx, s, i ) );
+#endif
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(recovery_per_second, * boost::unit_test::disabled()) try {
+   const auto s = make_set( 2000 );
+
+   const double backend = fc::benchmark::per_second( s.sigs.size(), [&]( size_t i ) {
+      BOOST_REQUIRE( ecc::public_key( s.sigs[i], s.digests[i] ).serialize() == s.keys[i] );
+   } );
+   std::cout << "ECC_IMPL=" << FC_ECC_IMPL << " recovery: " << backend << " keys/s" << std::endl;
+
+#ifdef FC_TEST_BUNDLED_SECP256K1
+   const secp256k1_context_t* ctx = secp256k1_context_create( SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN );
+   const double bundled = fc::benchmark::per_second( s.sigs.size(), [&]( size_t i ) { BOOST_REQUIRE( bundled_recovers( ctx, s, i ) ); } );
+   std::cout << "bundled secp256k1-zkp recover_compact: " << bundled << " keys/s" << std::endl;
+#endif
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+#define BOOST_TEST_MODULE encrypted_file
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/aes.hpp>
+#include <fc/crypto/encrypted_file.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+std::vector<char> random_bytes( size_t n ) {
+   std::vector<char> d( n );
+   rand_bytes( d.data(), d.size() );
+   return d;
+}
+
+const sha512 key = sha512::hash( std::string( "wallet password" ) );
+
+void write_file( const fc::path& p, const std::vector<char>& plain, uint32_t chunk_size, size_t piece ) {
+   encrypted_file_writer w( p, key, chunk_size );
+   for( size_t off = 0; off < plain.size(); off += piece )
+      w.write( plain.data() + off, std::min( piece, plain.size() - off ) );
+   BOOST_CHECK_EQUAL( w.size(), plain.size() );
+   w.close();
+}
+
+std::vector<char> read_all( const fc::path& p, size_t piece ) {
+   encrypted_file_reader r( p, key );
+   std::vector<char> out( r.size() );
+   size_t off = 0;
+   while( size_t n = r.read( out.data() + off, std::min( piece, out.size() - off ) ) )
+      off += n;
+   BOOST_CHECK_EQUAL( off, out.size() );
+   BOOST_CHECK_EQUAL( r.tell(), r.size() );
+   return out;
+}
+
+std::vector<char> file_bytes( const fc::path& p ) {
+   std::vector<char> d( fc::file_size( p ) );
+   boost::filesystem::ifstream in( p, std::ios::binary );
+   in.read( d.data(), d.size() );
+   return d;
+}
+
+void set_file_bytes( const fc::path& p, const std::vector<char>& d ) {
+   boost::filesystem::ofstream out( p, std::ios::binary | std::ios::trunc );
+   out.write( d.data(), d.size() );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(encrypted_file_suite)
+
+BOOST_AUTO_TEST_CASE(round_trips) try {
+   fc::temp_directory dir;
+   const fc::path p = dir.path() / "data";
+   const uint32_t cs = 1000;
+   for( size_t size : { 0, 1, 999, 1000, 1001, 3005 } ) {
+      const auto plain = random_bytes( size );
+      for( size_t piece : { 1, 7, 1000, 4096 } ) {
+         write_file( p, plain, cs, piece );
+         BOOST_CHECK( encrypted_file_reader::is_encrypted_file( p ) );
+         encrypted_file_reader r( p, key );
+         BOOST_REQUIRE_EQUAL( r.size(), size );
+         BOOST_CHECK_EQUAL( r.chunk_count(), std::max<size_t>( 1, ( size + cs - 1 ) / cs ) );
+         BOOST_CHECK_EQUAL( fc::file_size( p ), encrypted_file_header::header_size + size + 16 * r.chunk_count() );
+         BOOST_REQUIRE( read_all( p, piece ) == plain );
+      }
+      BOOST_CHECK( aes_load( p, key ) == plain );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(random_access) try {
+   fc::temp_directory dir;
+   const fc::path p = dir.path() / "data";
+   const uint32_t cs = 4096;
+   const auto plain = random_bytes( 50 * cs + 17 );
+   write_file( p, plain, cs, 100000 );
+
+   encrypted_file_reader r( p, key );
+   std::vector<char> chunk( cs );
+   BOOST_CHECK_EQUAL( r.read_chunk( 50, chunk.data() ), 17u );
+   BOOST_CHECK( std::equal( chunk.begin(), chunk.begin() + 17, plain.begin() + 50 * cs ) );
+   BOOST_CHECK_EQUAL( r.read_chunk( 7, chunk.data() ), cs );
+   BOOST_CHECK( std::equal( chunk.begin(), chunk.end(), plain.begin() + 7 * cs ) );
+   BOOST_CHECK_THROW( r.read_chunk( 51, chunk.data() ), fc::exception );
+
+   std::vector<char> buf( 10000 );
+   for( int i = 0; i < 200; ++i ) {
+      uint64_t pos;
+      rand_bytes( (char*)&pos, sizeof(pos) );
+      pos %= plain.size() + 1;
+      const size_t len = std::min<size_t>( pos % 9000 + 1, buf.size() );
+      r.seek( pos );
+      const size_t n = r.read( buf.data(), len );
+      BOOST_REQUIRE_EQUAL( n, std::min<size_t>( len, plain.size() - pos ) );
+      BOOST_REQUIRE( std::equal( buf.begin(), buf.begin() + n, plain.begin() + pos ) );
+   }
+   BOOST_CHECK_THROW( r.seek( plain.size() + 1 ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(damage) try {
+   fc::temp_directory dir;
+   const fc::path p = dir.path() / "data";
+   const uint32_t cs = 256;
+   const auto plain = random_bytes( 4 * cs );
+   write_file( p, plain, cs, plain.size() );
+   const auto good = file_bytes( p );
+
+   BOOST_CHECK_THROW( encrypted_file_reader( p, sha512::hash( std::string( "wrong" ) ) ), fc::exception );
+
+   // a flipped bit in the header, in a chunk and in a tag
+   for( size_t at : { size_t( 10 ), encrypted_file_header::header_size + cs + 16 + 5, good.size() - 1 } ) {
+      auto bad = good;
+      bad[at] ^= 1;
+      set_file_bytes( p, bad );
+      BOOST_CHECK_THROW( read_all( p, plain.size() ), fc::exception );
+   }
+
+   // the last chunk dropped, and a chunk dropped from the middle
+   auto cut = good;
+   cut.resize( good.size() - ( cs + 16 ) );
+   set_file_bytes( p, cut );
+   BOOST_CHECK_THROW( read_all( p, plain.size() ), fc::exception );
+   cut = good;
+   cut.erase( cut.begin() + encrypted_file_header::header_size + cs + 16, cut.begin() + encrypted_file_header::header_size + 2 * ( cs + 16 ) );
+   set_file_bytes( p, cut );
+   BOOST_CHECK_THROW( read_all( p, plain.size() ), fc::exception );
+
+   // chunks before the damage are still readable on their own
+   set_file_bytes( p, good );
+   {
+      auto bad = good;
+      bad[good.size() - 1] ^= 1;
+      set_file_bytes( p, bad );
+      encrypted_file_reader r( p, key );
+      std::vector<char> chunk( cs );
+      BOOST_CHECK_EQUAL( r.read_chunk( 0, chunk.data() ), cs );
+      BOOST_CHECK_THROW( r.read_chunk( 3, chunk.data() ), fc::exception );
+   }
+
+   // a writer that is not closed leaves no last chunk
+   {
+      encrypted_file_writer w( p, key, cs );
+      w.write( plain.data(), plain.size() );
+   }
+   BOOST_CHECK_THROW( read_all( p, plain.size() ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(aes_load_reads_both_formats) try {
+   fc::temp_directory dir;
+   const fc::path p = dir.path() / "data";
+   const auto plain = random_bytes( 3000 );
+   aes_save( p, key, plain );
+   BOOST_CHECK( !encrypted_file_reader::is_encrypted_file( p ) );
+   BOOST_CHECK( aes_load( p, key ) == plain );
+   write_file( p, plain, 1024, plain.size() );
+   BOOST_CHECK( aes_load( p, key ) == plain );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(throughput, * boost::unit_test::disabled()) try {
+   fc::temp_directory dir;
+   const fc::path p = dir.path() / "data";
+   const auto plain = random_bytes( 16 << 20 );
+   const double mib = plain.size() / double( 1 << 20 );
+
+   auto seconds = []( auto&& f ) { return fc::benchmark::elapsed_us( f ) / 1e6; };
+   const double write_s = seconds( [&]() { write_file( p, plain, encrypted_file_writer::default_chunk_size, 1 << 20 ); } );
+   std::vector<char> back;
+   const double read_s = seconds( [&]() { back = read_all( p, 1 << 20 ); } );
+   BOOST_CHECK( back == plain );
+
+   const double save_s = seconds( [&]() { aes_save( p, key, plain ); } );
+   std::vector<char> loaded;
+   const double load_s = seconds( [&]() { loaded = aes_load( p, key ); } );
+   BOOST_CHECK( loaded == plain );
+
+   std::cout << "16 MiB: encrypted_file_writer " << mib / write_s << " MiB/s, reader " << mib / read_s
+             << " MiB/s; aes_save " << mib / save_s << " MiB/s, aes_load " << mib / load_s << " MiB/s" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+#define BOOST_TEST_MODULE fast_hash
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/fast_hash.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/crypto/sha1.hpp>
+#include <fc/crypto/sha224.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/sha512.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
+
+using namespace fc;
+
+namespace {
+
+struct restore_backend {
+   fast_hash_backend b = get_fast_hash_backend();
+   ~restore_backend() { set_fast_hash_backend( b ); }
+};
+
+std::vector<char> random_bytes( size_t n ) {
+   std::vector<char> d( n );
+   rand_bytes( d.data(), d.size() );
+   return d;
+}
+
+/// nanoseconds per call of @p f over @p keys
+template<typename F>
+double ns_per_key( const std::vector<std::vector<char>>& keys, size_t rounds, F&& f ) {
+   uint64_t sink = 0;
+   const double ns = fc::benchmark::ns_per_call( rounds * keys.size(), [&]( size_t i ) {
+      const auto& k = keys[i % keys.size()];
+      sink += f( k.data(), k.size() );
+   } );
+   BOOST_CHECK( sink != 1 ); // keeps the calls
+   return ns;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(fast_hash)
+
+BOOST_AUTO_TEST_CASE(lengths_and_seeds) try {
+   const auto buf = random_bytes( 5000 );
+   std::unordered_set<uint64_t> seen;
+   for( size_t len = 0; len <= 300; ++len ) {
+      const uint64_t h = fast_hash64( buf.data(), len );
+      BOOST_REQUIRE( seen.insert( h ).second );
+      BOOST_REQUIRE( seen.insert( fast_hash64( buf.data(), len, 1 ) ).second );
+      BOOST_REQUIRE_EQUAL( fast_hash64( buf.data(), len ), h );
+      BOOST_REQUIRE_EQUAL( fast_hash128( buf.data(), len, 7 ).low_bits(), fast_hash64( buf.data(), len, 7 ) );
+      BOOST_REQUIRE( fast_hash128( buf.data(), len, 7 ).high_bits() != fast_hash128( buf.data(), len, 7 ).low_bits() );
+   }
+   // only the given bytes are read
+   auto copy = buf;
+   copy[100] ^= 1;
+   BOOST_CHECK_EQUAL( fast_hash64( buf.data(), 100 ), fast_hash64( copy.data(), 100 ) );
+   BOOST_CHECK( fast_hash64( buf.data(), 101 ) != fast_hash64( copy.data(), 101 ) );
+   BOOST_CHECK( fast_hash64( buf.data(), 4000 ) != fast_hash64( copy.data(), 4000 ) );
+
+   fast_hasher h;
+   BOOST_CHECK_EQUAL( h( std::string( "abc" ) ), fast_hash64( "abc", 3 ) );
+   BOOST_CHECK_EQUAL( h( std::vector<char>{ 'a', 'b', 'c' } ), fast_hash64( "abc", 3 ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(backends_match) try {
+   restore_backend restore;
+   const auto buf = random_bytes( 10000 );
+   for( size_t len : { 1023, 1024, 1025, 2048, 3000, 9999 } ) {
+      BOOST_REQUIRE( set_fast_hash_backend( fast_hash_backend::scalar ) );
+      const uint64_t h = fast_hash64( buf.data() + 1, len, len );
+      if( set_fast_hash_backend( fast_hash_backend::avx2 ) )
+         BOOST_REQUIRE_EQUAL( fast_hash64( buf.data() + 1, len, len ), h );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(avalanche) try {
+   // flipping one input bit flips about half the output bits
+   for( size_t len : { 8, 16, 32, 64, 200, 2000 } ) {
+      auto key = random_bytes( len );
+      double flipped = 0;
+      size_t trials = 0;
+      for( size_t bit = 0; bit < 8 * len; bit += std::max<size_t>( 1, len / 32 ) ) {
+         const uint64_t h = fast_hash64( key.data(), len, 42 );
+         key[bit / 8] ^= char( 1 << ( bit % 8 ) );
+         flipped += __builtin_popcountll( h ^ fast_hash64( key.data(), len, 42 ) );
+         key[bit / 8] ^= char( 1 << ( bit % 8 ) );
+         ++trials;
+      }
+      const double mean = flipped / trials;
+      BOOST_CHECK_MESSAGE( mean > 28 && mean < 36, len << " bytes: " << mean << " bits flipped" );
+   }
+
+   // no collisions among a million sequential 8 byte keys
+   std::unordered_set<uint64_t> seen;
+   for( uint64_t i = 0; i < 1000000; ++i )
+      BOOST_REQUIRE( seen.insert( fast_hash64( (const char*)&i, sizeof(i) ) ).second );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(digest_std_hash) try {
+   const auto s256 = sha256::hash( std::string( "a" ) );
+   BOOST_CHECK_EQUAL( std::hash<sha256>()( s256 ), s256._hash[0] );
+   const auto s512 = sha512::hash( std::string( "a" ) );
+   BOOST_CHECK_EQUAL( std::hash<sha512>()( s512 ), s512._hash[0] );
+   std::unordered_set<sha512> set512 = { s512, sha512::hash( std::string( "b" ) ) };
+   BOOST_CHECK_EQUAL( set512.size(), 2u );
+   std::unordered_set<sha224> set224 = { sha224::hash( std::string( "a" ) ) };
+   std::unordered_set<sha1> set1 = { sha1::hash( std::string( "a" ) ) };
+   std::unordered_set<ripemd160> set160 = { ripemd160::hash( std::string( "a" ) ) };
+   BOOST_CHECK_EQUAL( set224.size() + set1.size() + set160.size(), 3u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(hash_benchmarks, * boost::unit_test::disabled()) try {
+   restore_backend restore;
+   for( size_t len : { 8, 16, 24, 32, 48, 64, 256 } ) {
+      std::vector<std::vector<char>> keys;
+      for( int i = 0; i < 1024; ++i )
+         keys.push_back( random_bytes( len ) );
+      const size_t rounds = 2000;
+      const double fast = ns_per_key( keys, rounds, []( const char* d, size_t n ) { return fast_hash64( d, n ); } );
+      const double fast128 = ns_per_key( keys, rounds, []( const char* d, size_t n ) { return fast_hash128( d, n ).low_bits(); } );
+      const double city = ns_per_key( keys, rounds, []( const char* d, size_t n ) { return city_hash64( d, n ); } );
+      const double city128 = ns_per_key( keys, rounds, []( const char* d, size_t n ) { return city_hash128( d, n ).low_bits(); } );
+      const double stdh = ns_per_key( keys, rounds, []( const char* d, size_t n ) {
+         return std::hash<std::string_view>()( std::string_view( d, n ) );
+      } );
+      std::cout << len << " byte keys: fast_hash64 " << fast << " ns, city_hash64 " << city << " ns, std::hash "
+                << stdh << " ns, fast_hash128 " << fast128 << " ns, city_hash128 " << city128 << " ns" << std::endl;
+   }
+
+   std::vector<std::vector<char>> big = { random_bytes( 1 << 20 ) };
+   for( auto b : { fast_hash_backend::scalar, fast_hash_backend::avx2 } ) {
+      if( !set_fast_hash_backend( b ) )
+         continue;
+      const double ns = ns_per_key( big, 50, []( const char* d, size_t n ) { return fast_hash64( d, n ); } );
+      std::cout << "fast_hash64 " << ( b == fast_hash_backend::avx2 ? "avx2" : "scalar" ) << " 1 MiB: "
+                << ( 1 << 20 ) / ns * 1e9 / ( 1 << 20 ) << " MiB/s" << std::endl;
+   }
+   const double city_ns = ns_per_key( big, 50, []( const char* d, size_t n ) { return city_hash64( d, n ); } );
+   std::cout << "city_hash64 1 MiB: " << ( 1 << 20 ) / city_ns * 1e9 / ( 1 << 20 ) << " MiB/s" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,182 @@
+#define BOOST_TEST_MODULE hex
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/hex.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/variant.hpp>
+#include "benchmark.hpp"
+#include <algorithm>
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+struct restore_backend {
+   hex_backend b = get_hex_backend();
+   ~restore_backend() { set_hex_backend( b ); }
+};
+
+const char* backend_name( hex_backend b ) {
+   return b == hex_backend::avx2 ? "avx2" : b == hex_backend::ssse3 ? "ssse3" : "scalar";
+}
+
+/// the backends this CPU runs, the current one left as the last of them
+std::vector<hex_backend> supported_backends() {
+   std::vector<hex_backend> r;
+   for( auto b : { hex_backend::scalar, hex_backend::ssse3, hex_backend::avx2 } )
+      if( set_hex_backend( b ) )
+         r.push_back( b );
+   return r;
+}
+
+std::vector<char> random_bytes( size_t n ) {
+   std::vector<char> d( n );
+   if( n )
+      rand_bytes( d.data(), d.size() );
+   return d;
+}
+
+/// the nibble at a time encoder to_hex used to be
+std::string reference_to_hex( const char* d, size_t s ) {
+   std::string r;
+   const char* digits = "0123456789abcdef";
+   for( size_t i = 0; i < s; ++i )
+      ( r += digits[uint8_t( d[i] ) >> 4] ) += digits[uint8_t( d[i] ) & 0x0f];
+   return r;
+}
+
+/// the decoder from_hex used to be, throwing on each invalid character
+size_t reference_from_hex( const std::string& hex, char* out, size_t out_len ) {
+   auto i = hex.begin();
+   uint8_t* pos = (uint8_t*)out;
+   uint8_t* end = pos + out_len;
+   while( i != hex.end() && end != pos ) {
+      *pos = from_hex( *i ) << 4;
+      ++i;
+      if( i != hex.end() ) {
+         *pos |= from_hex( *i );
+         ++i;
+      }
+      ++pos;
+   }
+   return pos - (uint8_t*)out;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(hex)
+
+BOOST_AUTO_TEST_CASE(backends_match_reference) try {
+   restore_backend restore;
+   std::vector<size_t> sizes;
+   for( size_t n = 0; n <= 130; ++n )
+      sizes.push_back( n );
+   for( size_t n : { 255, 256, 257, 1000, 4099 } )
+      sizes.push_back( n );
+
+   for( auto b : supported_backends() ) {
+      BOOST_REQUIRE( set_hex_backend( b ) );
+      BOOST_TEST_CONTEXT( backend_name( b ) )
+      for( size_t n : sizes ) {
+         const auto data = random_bytes( n );
+         const auto expected = reference_to_hex( data.data(), n );
+         std::string hex( 2 * n, '\0' );
+         hex_encode( data.data(), n, &hex[0] );
+         BOOST_REQUIRE_EQUAL( hex, expected );
+         BOOST_REQUIRE_EQUAL( to_hex( data ), expected );
+
+         std::vector<char> back( n );
+         BOOST_REQUIRE( hex_decode( hex.data(), hex.size(), back.data() ) );
+         BOOST_REQUIRE( back == data );
+         std::string upper = hex;
+         std::transform( upper.begin(), upper.end(), upper.begin(), ::toupper );
+         std::fill( back.begin(), back.end(), 0 );
+         BOOST_REQUIRE( hex_decode( upper.data(), upper.size(), back.data() ) );
+         BOOST_REQUIRE( back == data );
+         std::fill( back.begin(), back.end(), 0 );
+         BOOST_REQUIRE_EQUAL( from_hex( upper, back.data(), back.size() ), n );
+         BOOST_REQUIRE( back == data );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(invalid_characters) try {
+   restore_backend restore;
+   const auto data = random_bytes( 100 );
+   const auto hex = to_hex( data );
+   std::vector<char> out( data.size() );
+
+   for( auto b : supported_backends() ) {
+      BOOST_REQUIRE( set_hex_backend( b ) );
+      BOOST_TEST_CONTEXT( backend_name( b ) )
+      for( size_t at = 0; at < hex.size(); at += 7 ) {
+         for( char c : { 'g', 'G', 'z', '/', ':', '@', '`', ' ', '\0', char( 0x80 ), char( 0xb0 ), char( 0xff ) } ) {
+            std::string bad = hex;
+            bad[at] = c;
+            BOOST_REQUIRE( !hex_decode( bad.data(), bad.size(), out.data() ) );
+            BOOST_REQUIRE_THROW( from_hex( bad, out.data(), out.size() ), fc::exception );
+            BOOST_REQUIRE_THROW( fc::variant( bad ).as<std::vector<char>>(), fc::exception );
+         }
+      }
+      BOOST_CHECK( !hex_decode( hex.data(), hex.size() - 1, out.data() ) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(from_hex_partial) try {
+   // an odd trailing digit and an output shorter than the input decode as they always did
+   for( const std::string hex : { "a", "abc", "0123456789abcdef0", "0123456789ABCDEF" } ) {
+      for( size_t len = 0; len <= hex.size() / 2 + 1; ++len ) {
+         std::vector<char> expected( len, 0 ), out( len, 0 );
+         BOOST_REQUIRE_EQUAL( from_hex( hex, out.data(), len ), reference_from_hex( hex, expected.data(), len ) );
+         BOOST_REQUIRE( out == expected );
+      }
+   }
+   // digits past the end of the output are not looked at
+   char one;
+   BOOST_CHECK_EQUAL( from_hex( std::string( "12zz" ), &one, 1 ), 1u );
+   BOOST_CHECK_EQUAL( one, 0x12 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(variant_round_trip) try {
+   for( size_t n : { 0, 1, 31, 32, 33, 1000 } ) {
+      const auto data = random_bytes( n );
+      fc::variant v;
+      to_variant( data, v );
+      BOOST_CHECK_EQUAL( v.get_string(), reference_to_hex( data.data(), n ) );
+      BOOST_CHECK( v.as<std::vector<char>>() == data );
+   }
+   BOOST_CHECK_THROW( fc::variant( std::string( "abc" ) ).as<std::vector<char>>(), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(hex_benchmarks, * boost::unit_test::disabled()) try {
+   restore_backend restore;
+   auto mib_per_s = []( size_t bytes, size_t rounds, auto&& f ) {
+      return bytes * fc::benchmark::per_second( rounds, [&]( size_t ) { f(); } ) / ( 1 << 20 );
+   };
+
+   for( size_t n : { 1 << 10, 64 << 10, 1 << 20 } ) {
+      const auto data = random_bytes( n );
+      const auto hex = reference_to_hex( data.data(), n );
+      std::vector<char> out( n );
+      const size_t rounds = std::max<size_t>( 4, ( 64 << 20 ) / n );
+
+      std::cout << n / 1024 << " KiB, MiB/s of bytes: reference encode "
+                << mib_per_s( n, rounds / 8, [&]() { BOOST_REQUIRE_EQUAL( reference_to_hex( data.data(), n ).size(), 2 * n ); } )
+                << ", decode " << mib_per_s( n, rounds / 8, [&]() { reference_from_hex( hex, out.data(), n ); } );
+      for( auto b : supported_backends() ) {
+         BOOST_REQUIRE( set_hex_backend( b ) );
+         std::string enc( 2 * n, '\0' );
+         std::cout << "; " << backend_name( b ) << " encode "
+                   << mib_per_s( n, rounds, [&]() { hex_encode( data.data(), n, &enc[0] ); } )
+                   << ", decode " << mib_per_s( n, rounds, [&]() { BOOST_REQUIRE( hex_decode( hex.data(), hex.size(), out.data() ) ); } );
+         BOOST_REQUIRE( enc == hex && out == data );
+      }
+      const fc::variant v( hex );
+      std::cout << "; from_variant " << mib_per_s( n, rounds / 4, [&]() { from_variant( v, out ); } )
+                << ", to_variant " << mib_per_s( n, rounds / 4, [&]() { fc::variant w; to_variant( data, w ); } ) << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
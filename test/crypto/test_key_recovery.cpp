@@ -0,0 +1,293 @@
+#define BOOST_TEST_MODULE key_recovery
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/key_recovery.hpp>
+#include <fc/crypto/private_key.hpp>
+#include <fc/io/raw.hpp>
+#include "benchmark.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using namespace fc::crypto;
+using namespace fc;
+
+namespace {
+
+struct signed_batch {
+   std::vector<signature>   sigs;
+   std::vector<sha256>      digests;
+   std::vector<public_key>  keys;
+};
+
+signed_batch make_batch( size_t n, size_t distinct_keys ) {
+   std::vector<private_key> priv;
+   for( size_t i = 0; i < distinct_keys; ++i )
+      priv.push_back( i % 2 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>() );
+   signed_batch b;
+   for( size_t i = 0; i < n; ++i ) {
+      const auto& k = priv[i % priv.size()];
+      b.digests.push_back( sha256::hash( std::to_string( i ) ) );
+      b.sigs.push_back( k.sign( b.digests.back() ) );
+      b.keys.push_back( k.get_public_key() );
+   }
+   return b;
+}
+
+signature corrupt_recovery_param( const signature& s ) {
+   auto packed = fc::raw::pack( s );
+   packed[1] = 0; // first byte of the compact signature, after the variant tag
+   return fc::raw::unpack<signature>( packed );
+}
+
+signature flip_byte( const signature& s, size_t i ) {
+   auto packed = fc::raw::pack( s );
+   packed[1 + i] ^= 1;
+   return fc::raw::unpack<signature>( packed );
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(key_recovery)
+
+BOOST_AUTO_TEST_CASE(batch_matches_single) try {
+   auto b = make_batch( 100, 10 );
+   for( size_t threads : { 0, 1, 4 } ) {
+      key_recovery_pool pool( threads );
+      BOOST_CHECK_EQUAL( pool.get_num_threads(), threads );
+      std::vector<fc::exception_ptr> errors;
+      auto keys = pool.recover_keys( b.sigs, b.digests, &errors );
+      BOOST_REQUIRE_EQUAL( keys.size(), b.sigs.size() );
+      BOOST_REQUIRE_EQUAL( errors.size(), b.sigs.size() );
+      for( size_t i = 0; i < keys.size(); ++i ) {
+         BOOST_CHECK( keys[i] == b.keys[i] );
+         BOOST_CHECK( keys[i] == public_key( b.sigs[i], b.digests[i] ) );
+         BOOST_CHECK( !errors[i] );
+      }
+   }
+   BOOST_CHECK( recover_keys( b.sigs, b.digests ) == b.keys );
+   BOOST_CHECK( recover_keys( {}, {} ).empty() );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(single_digest) try {
+   const auto digest = sha256::hash( std::string( "transaction" ) );
+   std::vector<signature> sigs;
+   std::vector<public_key> expected;
+   for( int i = 0; i < 20; ++i ) {
+      auto k = private_key::generate<ecc::private_key_shim>();
+      sigs.push_back( k.sign( digest ) );
+      expected.push_back( k.get_public_key() );
+   }
+   key_recovery_pool pool( 2 );
+   BOOST_CHECK( pool.recover_keys( sigs, { digest } ) == expected );
+   BOOST_CHECK_THROW( pool.recover_keys( sigs, { digest, digest } ), fc::assert_exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(failures_do_not_abort_batch) try {
+   auto b = make_batch( 40, 4 );
+   const std::vector<size_t> bad = { 0, 17, 39 };
+   for( auto i : bad )
+      b.sigs[i] = corrupt_recovery_param( b.sigs[i] );
+   BOOST_CHECK_THROW( public_key( b.sigs[17], b.digests[17] ), fc::exception );
+
+   key_recovery_pool pool( 3 );
+   std::vector<fc::exception_ptr> errors;
+   auto keys = pool.recover_keys( b.sigs, b.digests, &errors );
+   for( size_t i = 0; i < keys.size(); ++i ) {
+      if( std::find( bad.begin(), bad.end(), i ) != bad.end() ) {
+         BOOST_CHECK( !keys[i].valid() );
+         BOOST_CHECK( errors[i] );
+      } else {
+         BOOST_CHECK( keys[i] == b.keys[i] );
+         BOOST_CHECK( !errors[i] );
+      }
+   }
+   // errors are optional
+   BOOST_CHECK( pool.recover_keys( b.sigs, b.digests )[1] == b.keys[1] );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(concurrent_callers) try {
+   auto b = make_batch( 64, 8 );
+   key_recovery_pool pool( 2 );
+   std::vector<std::thread> callers;
+   std::atomic<int> mismatches{0};
+   for( int t = 0; t < 4; ++t )
+      callers.emplace_back( [&]() {
+         for( int r = 0; r < 5; ++r )
+            if( pool.recover_keys( b.sigs, b.digests ) != b.keys )
+               ++mismatches;
+      } );
+   for( auto& t : callers )
+      t.join();
+   BOOST_CHECK_EQUAL( mismatches.load(), 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(recovery_throughput, * boost::unit_test::disabled()) try {
+   auto b = make_batch( 2000, 50 );
+   auto time_batch = [&]( key_recovery_pool& pool ) {
+      std::vector<public_key> keys;
+      const double us = fc::benchmark::elapsed_us( [&]() { keys = pool.recover_keys( b.sigs, b.digests ); } );
+      BOOST_REQUIRE( keys == b.keys );
+      return b.sigs.size() * 1e6 / us;
+   };
+
+   const size_t hw = std::max( std::thread::hardware_concurrency(), 1u );
+   std::vector<size_t> thread_counts = { 0 };
+   for( size_t n = 1; n < hw; n *= 2 )
+      thread_counts.push_back( n );
+   if( hw > 1 && thread_counts.back() != hw - 1 )
+      thread_counts.push_back( hw - 1 );
+
+   for( auto n : thread_counts ) {
+      key_recovery_pool pool( n );
+      std::cout << "recover_keys with " << n << " worker threads: " << time_batch( pool ) << " keys/s" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(recovery_cache) try {
+   auto b = make_batch( 64, 8 );
+   BOOST_CHECK_EQUAL( get_recovery_cache_stats().capacity, 0u );
+   BOOST_CHECK( public_key( b.sigs[0], b.digests[0] ) == b.keys[0] );
+   BOOST_CHECK_EQUAL( get_recovery_cache_stats().misses, 0u ); // disabled
+
+   set_recovery_cache_size( 1024 );
+   for( int pass = 0; pass < 2; ++pass )
+      for( size_t i = 0; i < 16; ++i )
+         BOOST_CHECK( public_key( b.sigs[i], b.digests[i] ) == b.keys[i] );
+   auto stats = get_recovery_cache_stats();
+   BOOST_CHECK_EQUAL( stats.misses, 16u );
+   BOOST_CHECK_EQUAL( stats.hits, 16u );
+   BOOST_CHECK_EQUAL( stats.size, 16u );
+   BOOST_CHECK_EQUAL( stats.capacity, 1024u );
+
+   // check_canonical is part of the key, a different digest is a miss
+   BOOST_CHECK( public_key( b.sigs[0], b.digests[0], false ) == b.keys[0] );
+   BOOST_CHECK( public_key( b.sigs[0], b.digests[1] ) != b.keys[0] );
+   BOOST_CHECK_EQUAL( get_recovery_cache_stats().misses, 18u );
+
+   // failed recoveries are not cached
+   const auto bad = corrupt_recovery_param( b.sigs[2] );
+   BOOST_CHECK_THROW( public_key( bad, b.digests[2] ), fc::exception );
+   BOOST_CHECK_THROW( public_key( bad, b.digests[2] ), fc::exception );
+
+   // bounded, every shard evicts its least recently used entries
+   for( size_t max_entries : { 1, 20, 32 } ) {
+      set_recovery_cache_size( max_entries );
+      for( size_t i = 0; i < b.sigs.size(); ++i )
+         BOOST_CHECK( public_key( b.sigs[i], b.digests[i] ) == b.keys[i] );
+      BOOST_CHECK_LE( get_recovery_cache_stats().size, max_entries );
+   }
+
+   BOOST_CHECK( recover_keys( b.sigs, b.digests ) == b.keys );
+
+   clear_recovery_cache();
+   stats = get_recovery_cache_stats();
+   BOOST_CHECK_EQUAL( stats.size, 0u );
+   BOOST_CHECK_EQUAL( stats.hits, 0u );
+   BOOST_CHECK_EQUAL( stats.capacity, 32u );
+   set_recovery_cache_size( 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(recovery_cache_benchmark, * boost::unit_test::disabled()) try {
+   auto b = make_batch( 1000, 20 );
+   auto time_pass = [&]() {
+      return fc::benchmark::ns_per_call( b.sigs.size(), [&]( size_t i ) {
+         BOOST_REQUIRE( public_key( b.sigs[i], b.digests[i] ) == b.keys[i] );
+      } ) / 1000;
+   };
+   const double uncached = time_pass();
+   set_recovery_cache_size( b.sigs.size() * 2 );
+   const double miss = time_pass();
+   const double hit = time_pass();
+   BOOST_CHECK_EQUAL( get_recovery_cache_stats().hits, b.sigs.size() );
+   std::cout << "public_key recovery: uncached " << uncached << " us, cache miss " << miss << " us, cache hit "
+             << hit << " us" << std::endl;
+   set_recovery_cache_size( 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(verify_matches_recovery) try {
+   auto b = make_batch( 40, 4 );
+   for( size_t i = 0; i < b.sigs.size(); ++i ) {
+      BOOST_CHECK( verify( b.keys[i], b.digests[i], b.sigs[i] ) );
+      // another key of the same and of the other type, another digest
+      BOOST_CHECK( !verify( b.keys[( i + 2 ) % b.keys.size()], b.digests[i], b.sigs[i] ) );
+      BOOST_CHECK( !verify( b.keys[( i + 1 ) % b.keys.size()], b.digests[i], b.sigs[i] ) );
+      BOOST_CHECK( !verify( b.keys[i], b.digests[( i + 1 ) % b.digests.size()], b.sigs[i] ) );
+      // r and s
+      BOOST_CHECK( !verify( b.keys[i], b.digests[i], flip_byte( b.sigs[i], 10 ) ) );
+      BOOST_CHECK( !verify( b.keys[i], b.digests[i], flip_byte( b.sigs[i], 60 ) ) );
+      // what recovery rejects
+      BOOST_CHECK( !verify( b.keys[i], b.digests[i], corrupt_recovery_param( b.sigs[i] ) ) );
+   }
+   BOOST_CHECK( !verify( public_key(), b.digests[0], b.sigs[0] ) );
+
+   // the recovery id is bound: the other y, or an x past the order, recovers another key or none
+   for( size_t i = 0; i < b.sigs.size(); ++i ) {
+      for( int flip : { 1, 2 } ) {
+         auto packed = fc::raw::pack( b.sigs[i] );
+         packed[1] = 27 + ( ( packed[1] - 27 ) ^ flip );
+         const auto other_recid = fc::raw::unpack<signature>( packed );
+         BOOST_CHECK( !verify( b.keys[i], b.digests[i], other_recid ) );
+         if( flip == 1 )
+            BOOST_CHECK( public_key( other_recid, b.digests[i] ) != b.keys[i] );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(verify_many_batches) try {
+   auto b = make_batch( 100, 10 );
+   std::vector<size_t> bad = { 3, 50, 99 };
+   for( auto i : bad )
+      b.sigs[i] = flip_byte( b.sigs[i], 40 );
+   for( size_t threads : { 0, 3 } ) {
+      key_recovery_pool pool( threads );
+      auto result = pool.verify_many( b.keys, b.digests, b.sigs );
+      BOOST_REQUIRE_EQUAL( result.size(), b.sigs.size() );
+      for( size_t i = 0; i < result.size(); ++i )
+         BOOST_CHECK_EQUAL( result[i], std::find( bad.begin(), bad.end(), i ) == bad.end() );
+   }
+   BOOST_CHECK( verify_many( {}, {}, {} ).empty() );
+   BOOST_CHECK_THROW( verify_many( { b.keys[0], b.keys[1] }, b.digests, b.sigs ), fc::assert_exception );
+
+   // one key, one digest
+   const auto digest = sha256::hash( std::string( "block" ) );
+   const auto k = private_key::generate<r1::private_key_shim>();
+   std::vector<signature> sigs;
+   for( int i = 0; i < 20; ++i )
+      sigs.push_back( k.sign( digest ) );
+   BOOST_CHECK( verify_many( { k.get_public_key() }, { digest }, sigs ) == std::vector<bool>( sigs.size(), true ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(verify_throughput, * boost::unit_test::disabled()) try {
+   for( const char* type : { "K1", "R1" } ) {
+      const bool r1 = type[0] == 'R';
+      std::vector<private_key> priv;
+      for( int i = 0; i < 20; ++i )
+         priv.push_back( r1 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>() );
+      signed_batch b;
+      for( size_t i = 0; i < 1000; ++i ) {
+         // grouped by key, as transactions of one account or blocks of one producer are
+         const auto& k = priv[i * priv.size() / 1000];
+         b.digests.push_back( sha256::hash( std::to_string( i ) ) );
+         b.sigs.push_back( k.sign( b.digests.back() ) );
+         b.keys.push_back( k.get_public_key() );
+      }
+      auto per_sig = [&]( auto&& f ) {
+         return fc::benchmark::ns_per_call( b.sigs.size(), [&]( size_t i ) { BOOST_REQUIRE( f( i ) ); } ) / 1000;
+      };
+      // K1 verify recovers and compares on the secp256k1 backends, so only R1 is expected to differ there
+      const double by_recovery = per_sig( [&]( size_t i ) { return public_key( b.sigs[i], b.digests[i] ) == b.keys[i]; } );
+      const double direct = per_sig( [&]( size_t i ) { return verify( b.keys[i], b.digests[i], b.sigs[i] ); } );
+
+      const size_t hw = std::max( std::thread::hardware_concurrency(), 1u );
+      key_recovery_pool pool( hw - 1 );
+      std::vector<bool> result;
+      const double batch = fc::benchmark::elapsed_us( [&]() { result = pool.verify_many( b.keys, b.digests, b.sigs ); } ) / b.sigs.size();
+      BOOST_REQUIRE( result == std::vector<bool>( b.sigs.size(), true ) );
+
+      std::cout << type << ": recover and compare " << by_recovery << " us, verify " << direct << " us, verify_many with "
+                << hw - 1 << " worker threads " << batch << " us per signature" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,143 @@
+#define BOOST_TEST_MODULE merkle_tree
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/merkle.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+std::vector<sha256> make_leaves( size_t n ) {
+   std::vector<sha256> r( n );
+   for( size_t i = 0; i < n; ++i )
+      r[i] = sha256::hash( std::to_string( i ) );
+   return r;
+}
+
+/// level by level with an encoder per node
+sha256 reference_root( std::vector<sha256> level ) {
+   if( level.empty() )
+      return sha256();
+   while( level.size() > 1 ) {
+      if( level.size() % 2 )
+         level.push_back( level.back() );
+      std::vector<sha256> next;
+      for( size_t i = 0; i < level.size(); i += 2 ) {
+         sha256::encoder e;
+         e.write( level[i].data(), level[i].data_size() );
+         e.write( level[i+1].data(), level[i+1].data_size() );
+         next.push_back( e.result() );
+      }
+      level = std::move( next );
+   }
+   return level.front();
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(merkle_tree)
+
+BOOST_AUTO_TEST_CASE(small_trees) try {
+   const auto l = make_leaves( 3 );
+   BOOST_CHECK( merkle::root( {} ) == sha256() );
+   BOOST_CHECK( merkle::root( { l[0] } ) == l[0] );
+   BOOST_CHECK( merkle::root( { l[0], l[1] } ) == sha256::hash_pair( l[0], l[1] ) );
+   BOOST_CHECK( merkle::root( l ) == sha256::hash_pair( sha256::hash_pair( l[0], l[1] ), sha256::hash_pair( l[2], l[2] ) ) );
+   BOOST_CHECK( merkle::tree( {} ).root() == sha256() );
+   BOOST_CHECK_THROW( merkle::tree( {} ).get_proof( 0 ), fc::assert_exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(matches_reference) try {
+   merkle::thread_pool serial( 0 ), parallel( 3 );
+   for( size_t n = 0; n < 70; ++n ) {
+      const auto leaves = make_leaves( n );
+      const auto expected = reference_root( leaves );
+      BOOST_REQUIRE( merkle::root( leaves, serial ) == expected );
+      BOOST_REQUIRE( merkle::tree( leaves, serial ).root() == expected );
+   }
+   // levels large enough to be split across the workers
+   for( size_t n : { 8191, 8192, 10001 } ) {
+      const auto leaves = make_leaves( n );
+      const auto expected = reference_root( leaves );
+      BOOST_CHECK( merkle::root( leaves, parallel ) == expected );
+      BOOST_CHECK( merkle::root( leaves ) == expected );
+      BOOST_CHECK( merkle::tree( leaves, parallel ).root() == expected );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(proofs) try {
+   for( size_t n : { 1, 2, 3, 5, 8, 13, 100 } ) {
+      const auto leaves = make_leaves( n );
+      const merkle::tree t( leaves );
+      for( size_t i = 0; i < n; ++i ) {
+         const auto p = t.get_proof( i );
+         BOOST_REQUIRE( p.verify( leaves[i], t.root() ) );
+         BOOST_CHECK( !p.verify( sha256::hash( std::string( "other" ) ), t.root() ) );
+
+         auto unpacked = fc::raw::unpack<merkle::proof>( fc::raw::pack( p ) );
+         BOOST_CHECK( unpacked.verify( leaves[i], t.root() ) );
+         if( !p.path.empty() ) {
+            unpacked.path[0] = sha256::hash( unpacked.path[0] );
+            BOOST_CHECK( !unpacked.verify( leaves[i], t.root() ) );
+         }
+      }
+      BOOST_CHECK_THROW( t.get_proof( n ), fc::assert_exception );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(incremental_matches_root) try {
+   const auto leaves = make_leaves( 300 );
+   merkle::incremental inc;
+   BOOST_CHECK( inc.root() == sha256() );
+   for( size_t i = 0; i < leaves.size(); ++i ) {
+      inc.append( leaves[i] );
+      BOOST_REQUIRE_EQUAL( inc.size(), i + 1 );
+      BOOST_REQUIRE( inc.root() == reference_root( { leaves.begin(), leaves.begin() + i + 1 } ) );
+   }
+
+   // the state serializes and carries on where it stopped
+   auto restored = fc::raw::unpack<merkle::incremental>( fc::raw::pack( inc ) );
+   inc.append( leaves[0] );
+   restored.append( leaves[0] );
+   BOOST_CHECK( restored.root() == inc.root() );
+   BOOST_CHECK_EQUAL( restored.size(), 301u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(million_leaves, * boost::unit_test::disabled()) try {
+   const size_t n = 1000000;
+   std::vector<sha256> leaves( n );
+   for( auto& l : leaves )
+      rand_bytes( l.data(), l.data_size() );
+
+   auto time = [&]( auto&& f ) { return fc::benchmark::elapsed_us( f ) / 1000; };
+
+   sha256 expected, serial_root, pooled_root;
+   const double reference = time( [&]() { expected = reference_root( leaves ); } );
+   merkle::thread_pool serial( 0 );
+   const double serial_ms = time( [&]() { serial_root = merkle::root( leaves, serial ); } );
+   const double pooled_ms = time( [&]() { pooled_root = merkle::root( leaves ); } );
+   BOOST_CHECK( serial_root == expected );
+   BOOST_CHECK( pooled_root == expected );
+
+   std::unique_ptr<merkle::tree> t;
+   const double tree_ms = time( [&]() { t.reset( new merkle::tree( leaves ) ); } );
+   BOOST_CHECK( t->root() == expected );
+
+   merkle::incremental inc;
+   const double append_ms = time( [&]() {
+      for( const auto& l : leaves )
+         inc.append( l );
+   } );
+   BOOST_CHECK( inc.root() == expected );
+
+   std::cout << "merkle root of " << n << " leaves: encoder per node " << reference << " ms, root "
+             << serial_ms << " ms, root on " << merkle::default_thread_pool().get_num_threads() << " workers "
+             << pooled_ms << " ms, tree " << tree_ms << " ms, incremental appends " << append_ms << " ms" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
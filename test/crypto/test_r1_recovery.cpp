@@ -0,0 +1,149 @@
+#define BOOST_TEST_MODULE r1_recovery
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/elliptic_r1.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+using namespace fc::crypto;
+
+namespace {
+
+/// recovery through an EC_KEY built per call, as elliptic_r1 did before recover_public_key_data
+bool openssl_recover( const unsigned char* rs, const sha256& digest, int recid, r1::public_key_data& out ) {
+   ecdsa_sig sig = ECDSA_SIG_new();
+   BIGNUM *r = BN_new(), *s = BN_new();
+   BN_bin2bn( rs, 32, r );
+   BN_bin2bn( rs + 32, 32, s );
+   ECDSA_SIG_set0( sig, r, s );
+
+   ec_key key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+   if( r1::ECDSA_SIG_recover_key_GFp( key, sig, (const unsigned char*) digest.data(), digest.data_size(), recid, 0 ) != 1 )
+      return false;
+   out = r1::public_key_data();
+   const EC_POINT* point = EC_KEY_get0_public_key( key );
+   if( !EC_POINT_is_at_infinity( EC_KEY_get0_group( key ), point ) )
+      EC_POINT_point2oct( EC_KEY_get0_group( key ), point, POINT_CONVERSION_COMPRESSED, (uint8_t*) out.data, out.size(), nullptr );
+   return true;
+}
+
+void check_matches_openssl( const unsigned char* rs, const sha256& digest ) {
+   for( int recid = 0; recid < 4; ++recid ) {
+      r1::public_key_data key, reference;
+      const bool recovered = r1::recover_public_key_data( rs, digest, recid, key );
+      const bool reference_ok = openssl_recover( rs, digest, recid, reference );
+      BOOST_REQUIRE_EQUAL( recovered, reference_ok );
+      if( recovered )
+         BOOST_REQUIRE( key == reference );
+   }
+}
+
+struct recovery_set {
+   std::vector<r1::compact_signature>  sigs;
+   std::vector<sha256>                 digests;
+   std::vector<r1::public_key_data>    keys;
+};
+
+recovery_set make_set( size_t n ) {
+   recovery_set s;
+   std::vector<r1::private_key> priv;
+   for( int i = 0; i < 16; ++i )
+      priv.push_back( r1::private_key::generate() );
+   for( size_t i = 0; i < n; ++i ) {
+      const auto& k = priv[i % priv.size()];
+      s.digests.push_back( sha256::hash( std::to_string( i ) ) );
+      s.sigs.push_back( k.sign_compact( s.digests.back() ) );
+      s.keys.push_back( k.get_public_key().serialize() );
+   }
+   return s;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(r1_recovery)
+
+BOOST_AUTO_TEST_CASE(signatures_match_openssl) try {
+   const auto s = make_set( 200 );
+   for( size_t i = 0; i < s.sigs.size(); ++i ) {
+      check_matches_openssl( &s.sigs[i].data[1], s.digests[i] );
+      BOOST_CHECK( r1::public_key( s.sigs[i], s.digests[i] ).serialize() == s.keys[i] );
+      BOOST_CHECK( r1::public_key::recover( s.sigs[i], s.digests[i] ) == s.keys[i] );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(random_input_matches_openssl) try {
+   // mostly x values off the curve, the rest recover arbitrary keys
+   for( int i = 0; i < 200; ++i ) {
+      unsigned char rs[64];
+      rand_bytes( (char*) rs, sizeof(rs) );
+      sha256 digest;
+      rand_bytes( digest.data(), digest.data_size() );
+      check_matches_openssl( rs, digest );
+   }
+
+   unsigned char rs[64] = {};
+   check_matches_openssl( rs, sha256() );                  // r = s = 0
+   memset( rs, 0xff, sizeof(rs) );
+   check_matches_openssl( rs, sha256::hash( std::string( "max" ) ) );     // r, s and the candidate x past n and p
+   memset( rs, 0xff, sizeof(rs) );
+   sha256 max_digest;
+   memset( max_digest.data(), 0xff, max_digest.data_size() );
+   check_matches_openssl( rs, max_digest );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(key_at_infinity) try {
+   // s R = e G when s = e / k for R = k G, the recovered point is at infinity
+   ec_key key = EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 );
+   const EC_GROUP* group = EC_KEY_get0_group( key );
+   ssl_bignum k, order, x, y, e, s;
+   EC_GROUP_get_order( group, order, nullptr );
+   BN_rand_range( k, order );
+   ec_point R = EC_POINT_new( group );
+   EC_POINT_mul( group, R, k, nullptr, nullptr, nullptr );
+   EC_POINT_get_affine_coordinates_GFp( group, R, x, y, nullptr );
+   BOOST_REQUIRE( BN_cmp( x, order ) < 0 ); // overwhelmingly likely
+
+   const sha256 digest = sha256::hash( std::string( "infinity" ) );
+   BN_bin2bn( (const unsigned char*) digest.data(), digest.data_size(), e );
+   bn_ctx ctx( BN_CTX_new() );
+   BN_mod_inverse( s, k, order, ctx );
+   BN_mod_mul( s, s, e, order, ctx );
+
+   unsigned char rs[64] = {};
+   BN_bn2bin( x, rs + 32 - BN_num_bytes( x ) );
+   BN_bn2bin( s, rs + 64 - BN_num_bytes( s ) );
+   r1::public_key_data recovered;
+   BOOST_REQUIRE( r1::recover_public_key_data( rs, digest, BN_is_odd( y ), recovered ) );
+   BOOST_CHECK( recovered == r1::public_key_data() );
+   check_matches_openssl( rs, digest );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(rejects_high_s) try {
+   const auto s = make_set( 1 );
+   auto sig = s.sigs[0];
+   memset( &sig.data[33], 0xff, 32 );
+   BOOST_CHECK_THROW( r1::public_key( sig, s.digests[0] ), fc::exception );
+   sig = s.sigs[0];
+   sig.data[0] = 26;
+   BOOST_CHECK_THROW( r1::public_key::recover( sig, s.digests[0] ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(recovery_per_second, * boost::unit_test::disabled()) try {
+   const auto s = make_set( 2000 );
+   auto per_second = [&]( auto&& recover ) {
+      return fc::benchmark::per_second( s.sigs.size(), [&]( size_t i ) {
+         r1::public_key_data key;
+         BOOST_REQUIRE( recover( &s.sigs[i].data[1], s.digests[i], ( s.sigs[i].data[0] - 27 ) & 3, key ) );
+         BOOST_REQUIRE( key == s.keys[i] );
+      } );
+   };
+   const double reference = per_second( openssl_recover );
+   const double reused = per_second( r1::recover_public_key_data );
+   std::cout << "r1 recovery: EC_KEY per call " << reference << " keys/s, per thread context " << reused
+             << " keys/s" << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,154 @@
+#define BOOST_TEST_MODULE sha256_many
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/sha256.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+
+using namespace fc;
+
+namespace {
+
+const std::vector<std::pair<sha256::batch_backend, const char*>> backends = {
+   { sha256::batch_backend::openssl, "openssl" },
+   { sha256::batch_backend::avx2,    "avx2" },
+   { sha256::batch_backend::sha_ni,  "sha_ni" },
+};
+
+/// runs @p f on every backend this CPU has, restoring the detected one afterwards
+template<typename F>
+void for_each_backend( F&& f ) {
+   const auto detected = sha256::get_batch_backend();
+   for( const auto& b : backends ) {
+      if( !sha256::set_batch_backend( b.first ) ) {
+         BOOST_TEST_MESSAGE( "skipping unsupported backend " << b.second );
+         continue;
+      }
+      f( b.second );
+   }
+   sha256::set_batch_backend( detected );
+}
+
+std::vector<sha256> random_digests( size_t n ) {
+   std::vector<sha256> r( n );
+   for( auto& d : r )
+      rand_bytes( d.data(), d.data_size() );
+   return r;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(sha256_many)
+
+BOOST_AUTO_TEST_CASE(known_answers) try {
+   for_each_backend( []( const char* name ) {
+      BOOST_TEST_CONTEXT( name ) {
+         const std::string abc = "abc";
+         const std::string two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+         std::vector<std::pair<const char*, size_t>> msgs = { { abc.data(), abc.size() }, { "", 0 },
+                                                              { two_blocks.data(), two_blocks.size() } };
+         std::vector<sha256> out( msgs.size() );
+         sha256::hash_many( msgs, out.data() );
+         BOOST_CHECK_EQUAL( out[0].str(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" );
+         BOOST_CHECK_EQUAL( out[1].str(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" );
+         BOOST_CHECK_EQUAL( out[2].str(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" );
+      }
+   } );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(matches_hash) try {
+   // every length around the one and two block padding boundaries, then a few longer messages
+   std::vector<char> buf( 1024 );
+   rand_bytes( buf.data(), buf.size() );
+   std::vector<std::pair<const char*, size_t>> msgs;
+   for( size_t len = 0; len <= 200; ++len )
+      msgs.emplace_back( buf.data() + len % 7, len );
+   for( size_t len : { 255, 256, 511, 1000 } )
+      msgs.emplace_back( buf.data() + 3, len );
+   // runs of equal sizes for the eight lane kernel
+   for( size_t len : { 32, 55, 56, 64, 119, 120 } )
+      for( size_t i = 0; i < 16; ++i )
+         msgs.emplace_back( buf.data() + i * 13, len );
+
+   for_each_backend( [&]( const char* name ) {
+      BOOST_TEST_CONTEXT( name ) {
+         std::vector<sha256> out( msgs.size() );
+         sha256::hash_many( msgs, out.data() );
+         for( size_t i = 0; i < msgs.size(); ++i )
+            BOOST_REQUIRE_MESSAGE( out[i] == sha256::hash( msgs[i].first, msgs[i].second ), "length " << msgs[i].second );
+         sha256::hash_many( msgs.data(), 0, out.data() );
+      }
+   } );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(pairs) try {
+   const auto digests = random_digests( 2 * 37 );
+   std::vector<sha256> expected( digests.size() / 2 );
+   for( size_t i = 0; i < expected.size(); ++i ) {
+      sha256::encoder e;
+      e.write( digests[2*i].data(), digests[2*i].data_size() );
+      e.write( digests[2*i+1].data(), digests[2*i+1].data_size() );
+      expected[i] = e.result();
+   }
+
+   for_each_backend( [&]( const char* name ) {
+      BOOST_TEST_CONTEXT( name ) {
+         for( size_t i = 0; i < expected.size(); ++i )
+            BOOST_REQUIRE( sha256::hash_pair( digests[2*i], digests[2*i+1] ) == expected[i] );
+
+         std::vector<sha256> out( expected.size() );
+         sha256::hash_pairs( digests.data(), expected.size(), out.data() );
+         BOOST_CHECK( out == expected );
+
+         // in place, one Merkle level over the previous one
+         auto level = digests;
+         sha256::hash_pairs( level.data(), expected.size(), level.data() );
+         level.resize( expected.size() );
+         BOOST_CHECK( level == expected );
+      }
+   } );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(hashes_per_second, * boost::unit_test::disabled()) try {
+   const size_t n = 100000;
+   const auto digests = random_digests( 2 * n );
+   std::vector<std::pair<const char*, size_t>> msgs;
+   for( const auto& d : digests )
+      msgs.emplace_back( d.data(), d.data_size() );
+   msgs.resize( n );
+   std::vector<sha256> out( n ), expected( n ), pair_expected( n );
+
+   auto per_second = [&]( auto&& f ) { return n * 1e6 / fc::benchmark::elapsed_us( f ); };
+
+   const double single = per_second( [&]() {
+      for( size_t i = 0; i < n; ++i )
+         expected[i] = sha256::hash( digests[i] );
+   } );
+   const double encoder = per_second( [&]() {
+      for( size_t i = 0; i < n; ++i ) {
+         sha256::encoder e;
+         e.write( digests[2*i].data(), digests[2*i].data_size() );
+         e.write( digests[2*i+1].data(), digests[2*i+1].data_size() );
+         pair_expected[i] = e.result();
+      }
+   } );
+   std::cout << "sha256 of 32 bytes: hash " << single << "/s, 64 byte pairs with an encoder " << encoder << "/s" << std::endl;
+
+   for_each_backend( [&]( const char* name ) {
+      const double many = per_second( [&]() { sha256::hash_many( msgs, out.data() ); } );
+      BOOST_REQUIRE( out == expected );
+      const double pair = per_second( [&]() {
+         for( size_t i = 0; i < n; ++i )
+            out[i] = sha256::hash_pair( digests[2*i], digests[2*i+1] );
+      } );
+      BOOST_REQUIRE( out == pair_expected );
+      const double pairs = per_second( [&]() { sha256::hash_pairs( digests.data(), n, out.data() ); } );
+      BOOST_REQUIRE( out == pair_expected );
+      std::cout << "  " << name << ": hash_many " << many << "/s, hash_pair " << pair << "/s, hash_pairs "
+                << pairs << "/s" << std::endl;
+   } );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
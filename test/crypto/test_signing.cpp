@@ -0,0 +1,158 @@
+#define BOOST_TEST_MODULE signing
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/private_key.hpp>
+#include <fc/crypto/openssl.hpp>
+#include <fc/io/raw.hpp>
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace fc::crypto;
+using namespace fc;
+
+namespace {
+
+/// the 65 compact bytes behind a K1 or R1 signature
+std::vector<char> compact_bytes( const signature& s ) {
+   auto packed = fc::raw::pack( s );
+   return std::vector<char>( packed.begin() + 1, packed.end() );
+}
+
+/// P-256 order / 2
+const unsigned char r1_half_order[32] = {
+   0x7f, 0xff, 0xff, 0xff, 0x80, 0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+   0xde, 0x73, 0x7d, 0x56, 0xd3, 0x8b, 0xcf, 0x42, 0x79, 0xdc, 0xe5, 0x61, 0x7e, 0x31, 0x92, 0xa8
+};
+
+sha256 r1_secret_of( const private_key& k ) {
+   auto packed = fc::raw::pack( k );
+   return fc::raw::unpack<sha256>( std::vector<char>( packed.begin() + 1, packed.end() ) );
+}
+
+signature r1_signature( const r1::compact_signature& c ) {
+   std::vector<char> packed( 1, 1 );
+   packed.insert( packed.end(), c.begin(), c.end() );
+   return fc::raw::unpack<signature>( packed );
+}
+
+/// ecc::public_key::is_canonical: r and s below 2^255 and without a redundant leading zero byte
+bool k1_canonical( const std::vector<char>& c ) {
+   const auto* d = (const unsigned char*) c.data();
+   return !(d[1] & 0x80) && !(d[1] == 0 && !(d[2] & 0x80)) && !(d[33] & 0x80) && !(d[33] == 0 && !(d[34] & 0x80));
+}
+
+bool r1_low_s( const signature& s ) {
+   return memcmp( compact_bytes( s ).data() + 33, r1_half_order, 32 ) <= 0;
+}
+
+void check_signature( const private_key& k, const sha256& d, const signature& s ) {
+   const auto c = compact_bytes( s );
+   BOOST_REQUIRE_EQUAL( c.size(), 65u );
+   BOOST_CHECK( uint8_t( c[0] ) >= 31 && uint8_t( c[0] ) < 35 );
+   BOOST_CHECK( public_key( s, d ) == k.get_public_key() );
+   BOOST_CHECK( verify( k.get_public_key(), d, s ) );
+   if( s.which() == 0 )
+      BOOST_CHECK( k1_canonical( c ) );
+   else
+      BOOST_CHECK( r1_low_s( s ) );
+}
+
+/// what r1::private_key::sign_compact did before: an EC_KEY per key, ECDSA_do_sign, then the recovery id
+/// found by recovering candidate keys in signature_from_ecdsa
+r1::compact_signature old_r1_sign( const sha256& secret, const sha256& digest ) {
+   const auto pub = r1::private_key::regenerate( secret ).get_public_key().serialize();
+   ec_key key( EC_KEY_new_by_curve_name( NID_X9_62_prime256v1 ) );
+   ssl_bignum d;
+   BN_bin2bn( (const unsigned char*) secret.data(), secret.data_size(), d );
+   ec_point q( EC_POINT_new( EC_KEY_get0_group( key ) ) );
+   FC_ASSERT( EC_POINT_mul( EC_KEY_get0_group( key ), q, d, nullptr, nullptr, nullptr ) );
+   FC_ASSERT( EC_KEY_set_private_key( key, d ) && EC_KEY_set_public_key( key, q ) );
+   ecdsa_sig sig = ECDSA_do_sign( (const unsigned char*) digest.data(), digest.data_size(), key );
+   FC_ASSERT( sig.obj != nullptr );
+   return r1::signature_from_ecdsa( key, pub, sig, digest );
+}
+
+template<typename F>
+void print_latency( const char* name, size_t n, F&& f ) {
+   std::vector<double> us( n );
+   for( size_t i = 0; i < n; ++i )
+      us[i] = fc::benchmark::elapsed_us( [&]() { f( i ); } );
+   std::sort( us.begin(), us.end() );
+   auto pct = [&]( double p ) { return us[std::min( n - 1, size_t( p * n ) )]; };
+   std::cout << name << " us: p50 " << pct( 0.5 ) << ", p90 " << pct( 0.9 ) << ", p99 " << pct( 0.99 )
+             << ", p99.9 " << pct( 0.999 ) << ", max " << us.back() << std::endl;
+}
+
+std::vector<sha256> make_digests( size_t n ) {
+   std::vector<sha256> d;
+   for( size_t i = 0; i < n; ++i )
+      d.push_back( sha256::hash( std::to_string( i ) ) );
+   return d;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(signing)
+
+BOOST_AUTO_TEST_CASE(signatures_recover_and_verify) try {
+   const auto digests = make_digests( 300 );
+   for( const auto& k : { private_key::generate<ecc::private_key_shim>(), private_key::generate<r1::private_key_shim>() } )
+      for( const auto& d : digests )
+         check_signature( k, d, k.sign( d ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(r1_matches_old_signer) try {
+   const auto k = private_key::generate<r1::private_key_shim>();
+   const auto secret = r1_secret_of( k );
+   for( const auto& d : make_digests( 100 ) ) {
+      // both recover the same key, and each verifies on the other's path
+      const auto old_sig = r1_signature( old_r1_sign( secret, d ) );
+      check_signature( k, d, old_sig );
+      r1::compact_signature c;
+      BOOST_REQUIRE( r1::sign_compact_data( secret, d, c ) );
+      BOOST_CHECK( r1::public_key( c, d ).serialize() == r1::private_key::regenerate( secret ).get_public_key().serialize() );
+   }
+   // zero and the order are not keys
+   r1::compact_signature c;
+   BOOST_CHECK( !r1::sign_compact_data( sha256(), sha256::hash( std::string( "x" ) ), c ) );
+   BOOST_CHECK( !r1::sign_compact_data( sha256( "ffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551" ),
+                                       sha256::hash( std::string( "x" ) ), c ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(sign_many_matches_sign) try {
+   const auto digests = make_digests( 64 );
+   for( const auto& k : { private_key::generate<ecc::private_key_shim>(), private_key::generate<r1::private_key_shim>() } ) {
+      BOOST_CHECK( k.sign_many( {} ).empty() );
+      const auto sigs = k.sign_many( digests );
+      BOOST_REQUIRE_EQUAL( sigs.size(), digests.size() );
+      for( size_t i = 0; i < digests.size(); ++i ) {
+         check_signature( k, digests[i], sigs[i] );
+         // K1 nonces are deterministic, R1 ones are not
+         if( k.get_public_key().which() == 0 )
+            BOOST_CHECK( sigs[i] == k.sign( digests[i] ) );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(signing_latency, * boost::unit_test::disabled()) try {
+   const size_t n = 2000;
+   const auto digests = make_digests( n );
+   const auto k1 = private_key::generate<ecc::private_key_shim>();
+   const auto r1 = private_key::generate<r1::private_key_shim>();
+   const auto r1_secret = r1_secret_of( r1 );
+
+   print_latency( "K1 sign", n, [&]( size_t i ) { k1.sign( digests[i] ); } );
+   print_latency( "R1 sign, ECDSA_do_sign", n, [&]( size_t i ) { old_r1_sign( r1_secret, digests[i] ); } );
+   print_latency( "R1 sign", n, [&]( size_t i ) { r1.sign( digests[i] ); } );
+
+   for( const auto* k : { &k1, &r1 } ) {
+      std::vector<signature> sigs;
+      const double us = fc::benchmark::elapsed_us( [&]() { sigs = k->sign_many( digests ); } );
+      BOOST_CHECK_EQUAL( sigs.size(), n );
+      std::cout << ( k->get_public_key().which() == 0 ? "K1" : "R1" ) << " sign_many: " << n / us * 1e6 << " signatures/s" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,162 @@
+#define BOOST_TEST_MODULE string_cache
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/crypto/string_cache.hpp>
+#include <fc/crypto/private_key.hpp>
+#include <fc/variant.hpp>
+#include "benchmark.hpp"
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using namespace fc::crypto;
+using namespace fc;
+
+namespace {
+
+struct keys_and_signatures {
+   std::vector<public_key>  keys;
+   std::vector<signature>   sigs;
+};
+
+keys_and_signatures make_keys( size_t n ) {
+   keys_and_signatures r;
+   for( size_t i = 0; i < n; ++i ) {
+      auto k = i % 2 ? private_key::generate<r1::private_key_shim>() : private_key::generate<ecc::private_key_shim>();
+      r.keys.push_back( k.get_public_key() );
+      r.sigs.push_back( k.sign( sha256::hash( std::to_string( i ) ) ) );
+   }
+   return r;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(string_cache)
+
+BOOST_AUTO_TEST_CASE(round_trips) try {
+   const auto ks = make_keys( 16 );
+   std::vector<std::string> key_strs, sig_strs;
+   for( size_t i = 0; i < ks.keys.size(); ++i ) {
+      key_strs.push_back( ks.keys[i].to_string() );
+      sig_strs.push_back( ks.sigs[i].to_string() );
+   }
+   BOOST_CHECK_EQUAL( get_string_cache_stats().capacity, 0u );
+   BOOST_CHECK_EQUAL( get_string_cache_stats().misses, 0u ); // disabled
+
+   set_string_cache_size( 1024 );
+   for( int pass = 0; pass < 2; ++pass ) {
+      for( size_t i = 0; i < ks.keys.size(); ++i ) {
+         BOOST_REQUIRE_EQUAL( ks.keys[i].to_string(), key_strs[i] );
+         BOOST_REQUIRE_EQUAL( ks.sigs[i].to_string(), sig_strs[i] );
+         BOOST_REQUIRE( public_key( key_strs[i] ) == ks.keys[i] );
+         BOOST_REQUIRE( signature( sig_strs[i] ) == ks.sigs[i] );
+      }
+   }
+   auto stats = get_string_cache_stats();
+   BOOST_CHECK_EQUAL( stats.misses, 64u );
+   BOOST_CHECK_EQUAL( stats.hits, 64u );
+   BOOST_CHECK_EQUAL( stats.size, 64u );
+   BOOST_CHECK_EQUAL( stats.capacity, 1024u );
+
+   // variants go through the cache
+   variant v;
+   to_variant( ks.keys[0], v );
+   BOOST_CHECK_EQUAL( v.as_string(), key_strs[0] );
+   public_key k;
+   from_variant( v, k );
+   BOOST_CHECK( k == ks.keys[0] );
+   BOOST_CHECK_EQUAL( get_string_cache_stats().hits, 66u );
+
+   // a string parses to its own entry, the key still prints in its canonical form
+   BOOST_CHECK( public_key( key_strs[0] + " " ) == ks.keys[0] );
+   BOOST_CHECK_EQUAL( ks.keys[0].to_string(), key_strs[0] );
+   BOOST_CHECK( public_key( key_strs[0] + " " ) == ks.keys[0] );
+
+   // failed parses are not cached
+   auto bad = sig_strs[0];
+   bad[bad.size() - 1] = bad[bad.size() - 1] == 'a' ? 'b' : 'a';
+   BOOST_CHECK_THROW( signature{ bad }, fc::exception );
+   BOOST_CHECK_THROW( signature{ bad }, fc::exception );
+
+   // bounded, every shard evicts its least recently used entries
+   const auto more = make_keys( 100 );
+   for( size_t max_entries : { 1, 20, 32 } ) {
+      set_string_cache_size( max_entries );
+      for( size_t i = 0; i < more.keys.size(); ++i ) {
+         const auto s = more.keys[i].to_string();
+         BOOST_REQUIRE( public_key( s ) == more.keys[i] );
+      }
+      BOOST_CHECK_LE( get_string_cache_stats().size, 2u * max_entries );
+   }
+
+   clear_string_cache();
+   stats = get_string_cache_stats();
+   BOOST_CHECK_EQUAL( stats.size, 0u );
+   BOOST_CHECK_EQUAL( stats.hits, 0u );
+   BOOST_CHECK_EQUAL( stats.capacity, 32u );
+   set_string_cache_size( 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(concurrent_callers) try {
+   const auto ks = make_keys( 64 );
+   std::vector<std::string> key_strs;
+   for( const auto& k : ks.keys )
+      key_strs.push_back( k.to_string() );
+
+   set_string_cache_size( 48 );
+   std::vector<std::thread> callers;
+   std::atomic<int> mismatches{0};
+   for( int t = 0; t < 4; ++t )
+      callers.emplace_back( [&, t]() {
+         for( int r = 0; r < 50; ++r )
+            for( size_t i = t; i < ks.keys.size(); i += 3 )
+               if( ks.keys[i].to_string() != key_strs[i] || !( public_key( key_strs[i] ) == ks.keys[i] ) )
+                  ++mismatches;
+      } );
+   for( auto& t : callers )
+      t.join();
+   BOOST_CHECK_EQUAL( mismatches.load(), 0 );
+   set_string_cache_size( 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(string_cache_benchmark, * boost::unit_test::disabled()) try {
+   const auto ks = make_keys( 1000 );
+   std::vector<std::string> key_strs, sig_strs;
+   for( size_t i = 0; i < ks.keys.size(); ++i ) {
+      key_strs.push_back( ks.keys[i].to_string() );
+      sig_strs.push_back( ks.sigs[i].to_string() );
+   }
+
+   auto time_pass = [&]() {
+      std::vector<variant> vs( ks.keys.size() * 2 );
+      const double to_us = fc::benchmark::elapsed_us( [&]() {
+         for( size_t i = 0; i < ks.keys.size(); ++i ) {
+            to_variant( ks.keys[i], vs[2 * i] );
+            to_variant( ks.sigs[i], vs[2 * i + 1] );
+         }
+      } );
+      std::vector<public_key> keys( ks.keys.size() );
+      std::vector<signature> sigs( ks.sigs.size() );
+      const double from_us = fc::benchmark::elapsed_us( [&]() {
+         for( size_t i = 0; i < ks.keys.size(); ++i ) {
+            from_variant( vs[2 * i], keys[i] );
+            from_variant( vs[2 * i + 1], sigs[i] );
+         }
+      } );
+      BOOST_REQUIRE( keys == ks.keys );
+      BOOST_REQUIRE( sigs == ks.sigs );
+      const double n = 2 * ks.keys.size();
+      return std::make_pair( to_us / n, from_us / n );
+   };
+   const auto uncached = time_pass();
+   set_string_cache_size( ks.keys.size() * 2 );
+   const auto miss = time_pass();
+   const auto hit = time_pass();
+   BOOST_CHECK_EQUAL( get_string_cache_stats().hits, 4 * ks.keys.size() );
+   std::cout << "to_variant: uncached " << uncached.first << " us, cache miss " << miss.first << " us, cache hit "
+             << hit.first << " us; from_variant: uncached " << uncached.second << " us, cache miss " << miss.second
+             << " us, cache hit " << hit.second << " us" << std::endl;
+   set_string_cache_size( 0 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -417,4 +417,25 @@ BOOST_AUTO_TEST_CASE(base64_wonky) try {
    });
 } FC_LOG_AND_RETHROW();
 
+//Verifying against the expected key agrees with comparing the recovered key
+BOOST_AUTO_TEST_CASE(verify_matches_recovery) try {
+   webauthn::public_key wa_pub(pub.serialize(), webauthn::public_key::user_presence_t::USER_PRESENCE_NONE, "fctesting.invalid");
+   webauthn::public_key wa_present(pub.serialize(), webauthn::public_key::user_presence_t::USER_PRESENCE_PRESENT, "fctesting.invalid");
+   webauthn::public_key wa_other_rpid(pub.serialize(), webauthn::public_key::user_presence_t::USER_PRESENCE_NONE, "mallory.invalid");
+   std::string json = "{\"origin\":\"https://fctesting.invalid\",\"type\":\"webauthn.get\",\"challenge\":\"" + fc::base64url_encode(d.data(), d.data_size()) + "\"}";
+
+   std::vector<uint8_t> auth_data(37);
+   memcpy(auth_data.data(), origin_hash.data(), sizeof(origin_hash));
+   webauthn::signature sig = make_webauthn_sig(priv, auth_data, json);
+
+   BOOST_CHECK(wa_pub.verify(sig, d));
+   BOOST_CHECK(!wa_present.verify(sig, d));
+   BOOST_CHECK(!wa_other_rpid.verify(sig, d));
+   BOOST_CHECK(!wa_pub.verify(sig, fc::sha256::hash("other"s)));
+   BOOST_CHECK(!wa_pub.verify(make_webauthn_sig(fc::crypto::r1::private_key::generate(), auth_data, json), d));
+
+   std::string bad_json = "{\"origin\":\"https://fctesting.invalid\",\"type\":\"webauthn.create\",\"challenge\":\"" + fc::base64url_encode(d.data(), d.data_size()) + "\"}";
+   BOOST_CHECK(!wa_pub.verify(make_webauthn_sig(priv, auth_data, bad_json), d));
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,407 @@
+#define BOOST_TEST_MODULE appenders
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/log/binary_appender.hpp>
+#include <fc/log/console_appender.hpp>
+#include <fc/log/file_appender.hpp>
+#include <fc/log/gelf_appender.hpp>
+#include <fc/io/json.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+#include "benchmark.hpp"
+
+#include <boost/asio.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+
+namespace {
+/// while set, every datagram send fails as a full non-blocking socket would
+std::atomic<bool> sends_would_block{ false };
+}
+
+// loopback UDP never reports EAGAIN, even with a tiny SO_SNDBUF, so the sends asio and udp_socket make are
+// interposed to reach the queueing path
+extern "C" ssize_t sendmsg( int fd, const struct msghdr* msg, int flags ) {
+   if( sends_would_block ) {
+      errno = EAGAIN;
+      return -1;
+   }
+   return syscall( SYS_sendmsg, fd, msg, flags );
+}
+
+extern "C" ssize_t sendto( int fd, const void* buf, size_t len, int flags, const struct sockaddr* to, socklen_t to_len ) {
+   if( sends_would_block ) {
+      errno = EAGAIN;
+      return -1;
+   }
+   return syscall( SYS_sendto, fd, buf, len, flags, to, to_len );
+}
+
+extern "C" int sendmmsg( int fd, struct mmsghdr* msgs, unsigned int n, int flags ) {
+   if( sends_would_block ) {
+      errno = EAGAIN;
+      return -1;
+   }
+   return syscall( SYS_sendmmsg, fd, msgs, n, flags );
+}
+#endif
+
+using namespace fc;
+
+namespace {
+
+string zlib_decompress( const string& in ) {
+   std::stringstream src( in );
+   boost::iostreams::filtering_istream z;
+   z.push( boost::iostreams::zlib_decompressor() );
+   z.push( src );
+   std::stringstream ss;
+   boost::iostreams::copy( z, ss );
+   return ss.str();
+}
+
+/// reassembles GELF datagrams received on sock into JSON messages, gives up after timeout_ms without data
+std::vector<variant_object> receive_gelf( boost::asio::ip::udp::socket& sock, size_t count, int timeout_ms ) {
+   std::vector<variant_object> result;
+   std::map<uint64_t, std::map<uint8_t, string>> partial;
+   std::vector<char> buf( 65536 );
+   auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_ms );
+   while( result.size() < count && std::chrono::steady_clock::now() < deadline ) {
+      boost::system::error_code ec;
+      const size_t n = sock.receive( boost::asio::buffer( buf ), 0, ec );
+      if( ec == boost::asio::error::would_block ) {
+         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+         continue;
+      }
+      BOOST_REQUIRE( !ec );
+      string msg;
+      if( n >= 12 && (unsigned char)buf[0] == 0x1e && (unsigned char)buf[1] == 0x0f ) {
+         uint64_t id;
+         memcpy( &id, buf.data() + 2, sizeof(id) );
+         auto& chunks = partial[id];
+         chunks[(uint8_t)buf[10]] = string( buf.data() + 12, n - 12 );
+         if( chunks.size() < (uint8_t)buf[11] )
+            continue;
+         for( const auto& c : chunks )
+            msg += c.second;
+         partial.erase( id );
+      } else {
+         msg.assign( buf.data(), n );
+      }
+      result.push_back( json::from_string( zlib_decompress( msg ) ).get_object() );
+   }
+   return result;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(appenders)
+
+BOOST_AUTO_TEST_CASE(console_format_log_line) try {
+   const log_message m = FC_LOG_MESSAGE( warn, "value ${v}", ("v", 42) );
+   for( const time_point ts : { time_point(), time_point::from_iso_string( "2020-08-20T12:34:56.007" ),
+                                time_point::now(), time_point::now() + fc::milliseconds( 1500 ) } ) {
+      const string line = console_appender::format_log_line( m, ts );
+      const string thread = ( m.get_context().get_thread_name() + string( 9, ' ' ) ).substr( 0, 9 );
+      const string file_line = "test_appenders.cpp:" + std::to_string( m.get_context().get_line_number() );
+      BOOST_CHECK_EQUAL( line.substr( 0, 6 + 23 + 1 + 10 ), "warn  " + string( ts ) + " " + thread + " " );
+      BOOST_CHECK_EQUAL( line.substr( 40, 30 ), file_line + string( 30 - file_line.size(), ' ' ) );
+      BOOST_CHECK_EQUAL( line.substr( 70 ), "test_method          ] value 42" );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(binary_appender_round_trip) try {
+   temp_directory tmp;
+   binary_appender::config cfg;
+   cfg.file = tmp.path() / "log.bin";
+   cfg.size_mb = 1;
+   {
+      binary_appender app( cfg );
+      for( int i = 0; i < 3; ++i )
+         app.log( FC_LOG_MESSAGE( info, "hello ${who} #${i}", ("who", "world")("i", i) ) );
+      app.log( FC_LOG_MESSAGE( warn, "no args" ) );
+   }
+
+   binary_log_reader reader( cfg.file );
+   BOOST_CHECK_EQUAL( reader.get_sites().size(), 2u );
+   std::vector<string> messages;
+   reader.for_each( [&]( const binary_log_record& r ) {
+      const log_message m = reader.to_log_message( r );
+      messages.push_back( m.get_message() );
+      BOOST_CHECK_EQUAL( m.get_context().get_file(), "test_appenders.cpp" );
+      BOOST_CHECK( console_appender::format_log_line( m, m.get_context().get_timestamp() ).find( m.get_message() ) != string::npos );
+   } );
+   BOOST_REQUIRE_EQUAL( messages.size(), 4u );
+   BOOST_CHECK_EQUAL( messages[0], "hello world #0" );
+   BOOST_CHECK_EQUAL( messages[2], "hello world #2" );
+   BOOST_CHECK_EQUAL( messages[3], "no args" );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(binary_appender_ring_wrap) try {
+   temp_directory tmp;
+   binary_appender::config cfg;
+   cfg.file = tmp.path() / "log.bin";
+   cfg.size_mb = 1;
+   const uint64_t count = 100000;
+   {
+      binary_appender app( cfg );
+      for( uint64_t i = 0; i < count; ++i )
+         app.log( FC_LOG_MESSAGE( debug, "record ${i} ${pad}", ("i", i)("pad", string( i % 64, 'x' )) ) );
+      BOOST_CHECK_EQUAL( app.get_dropped_count(), 0u );
+   }
+
+   binary_log_reader reader( cfg.file );
+   uint64_t expected = 0;
+   uint64_t seen = 0;
+   reader.for_each( [&]( const binary_log_record& r ) {
+      const uint64_t i = r.args.at( 0 ).as_uint64();
+      if( seen == 0 )
+         expected = i;
+      BOOST_REQUIRE_EQUAL( i, expected );
+      BOOST_REQUIRE_EQUAL( r.args.at( 1 ).get_string().size(), i % 64 );
+      ++expected;
+      ++seen;
+   } );
+   // oldest records were overwritten, the newest ones are all present and in order
+   BOOST_CHECK_GT( seen, 0u );
+   BOOST_CHECK_LT( seen, count );
+   BOOST_CHECK_EQUAL( expected, count );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(binary_appender_reopen) try {
+   temp_directory tmp;
+   binary_appender::config cfg;
+   cfg.file = tmp.path() / "log.bin";
+   cfg.size_mb = 1;
+   auto messages = [&]() {
+      binary_log_reader reader( cfg.file );
+      std::vector<string> result;
+      reader.for_each( [&]( const binary_log_record& r ) { result.push_back( reader.to_log_message( r ).get_message() ); } );
+      return result;
+   };
+   auto log_run = [&]( int run ) {
+      binary_appender app( cfg );
+      app.log( FC_LOG_MESSAGE( info, "run ${r}", ("r", run) ) );
+      if( run > 0 )
+         app.log( FC_LOG_MESSAGE( info, "only in later runs ${r}", ("r", run) ) );
+   };
+
+   log_run( 0 );
+   log_run( 1 );
+   // a site entry cut short by a crash is dropped on reopen
+   {
+      const fc::path sites = cfg.file.generic_string() + ".sites";
+      std::ofstream( sites.generic_string(), std::ios::binary | std::ios::app ).write( "\x02\x05", 2 );
+   }
+   log_run( 2 );
+   BOOST_CHECK( messages() == std::vector<string>( { "run 0", "run 1", "only in later runs 1", "run 2", "only in later runs 2" } ) );
+   BOOST_CHECK_EQUAL( binary_log_reader( cfg.file ).get_sites().size(), 2u );
+
+   // a ring of another size is started over
+   cfg.size_mb = 2;
+   log_run( 3 );
+   BOOST_CHECK( messages() == std::vector<string>( { "run 3", "only in later runs 3" } ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(file_appender_rotation) try {
+   temp_directory tmp;
+   file_appender::config cfg;
+   cfg.file = tmp.path() / "logs" / "node.log";
+   cfg.max_size_mb = 1;
+   cfg.max_rotated_files = 2;
+   cfg.compress = true;
+   const string pad( 200, 'p' );
+   const uint64_t count = 20000; // ~4.5MB of lines, rotates several times
+   {
+      file_appender app( cfg );
+      for( uint64_t i = 0; i < count; ++i )
+         app.log( FC_LOG_MESSAGE( info, "line ${i} ${pad}", ("i", i)("pad", pad) ) );
+   }
+
+   std::vector<fc::path> gz_files;
+   for( directory_iterator itr( cfg.file.parent_path() ); itr != directory_iterator(); ++itr ) {
+      if( itr->extension().generic_string() == ".gz" )
+         gz_files.push_back( *itr );
+   }
+   BOOST_CHECK_EQUAL( gz_files.size(), 2u );
+   BOOST_REQUIRE( fc::exists( cfg.file ) );
+   BOOST_CHECK_LE( fc::file_size( cfg.file ), 1024 * 1024 );
+
+   for( const auto& p : gz_files ) {
+      std::ifstream in( p.generic_string(), std::ios::binary );
+      boost::iostreams::filtering_istream gz;
+      gz.push( boost::iostreams::gzip_decompressor() );
+      gz.push( in );
+      std::stringstream ss;
+      boost::iostreams::copy( gz, ss );
+      const string contents = ss.str();
+      BOOST_CHECK_GT( contents.size(), 1000u * 1000u );
+      BOOST_CHECK_LE( contents.size(), 1024u * 1024u );
+      BOOST_CHECK( contents.find( pad ) != string::npos );
+   }
+
+   std::ifstream current( cfg.file.generic_string() );
+   string last, line;
+   while( std::getline( current, line ) )
+      last = line;
+   BOOST_CHECK( last.find( "line " + std::to_string( count - 1 ) + " " ) != string::npos );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(file_appender_idle_file_not_rotated) try {
+   temp_directory tmp;
+   file_appender::config cfg;
+   cfg.file = tmp.path() / "node.log";
+   cfg.flush_interval_ms = 50;
+   cfg.rotation_interval_s = 1;
+   {
+      file_appender app( cfg );
+      std::this_thread::sleep_for( std::chrono::milliseconds( 1300 ) );
+      app.log( FC_LOG_MESSAGE( info, "after idle" ) );
+   }
+   size_t files = 0;
+   for( directory_iterator itr( tmp.path() ); itr != directory_iterator(); ++itr )
+      ++files;
+   BOOST_CHECK_EQUAL( files, 1u );
+   BOOST_CHECK_GT( fc::file_size( cfg.file ), 0u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(file_appender_concurrent_order) try {
+   temp_directory tmp;
+   file_appender::config cfg;
+   cfg.file = tmp.path() / "node.log";
+   cfg.buffer_size_kb = 1; // written out every few lines, by whichever thread fills the buffer
+   const int threads = 4;
+   const int lines = 2000;
+   {
+      file_appender app( cfg );
+      std::vector<std::thread> loggers;
+      for( int t = 0; t < threads; ++t )
+         loggers.emplace_back( [&app, t]() {
+            for( int i = 0; i < lines; ++i )
+               app.log( FC_LOG_MESSAGE( info, "thread ${t} line ${i} end", ("t", t)("i", i) ) );
+         } );
+      for( auto& l : loggers )
+         l.join();
+   }
+
+   std::ifstream in( cfg.file.generic_string() );
+   std::vector<int> next( threads, 0 );
+   string line;
+   while( std::getline( in, line ) ) {
+      const auto pos = line.find( "thread " );
+      BOOST_REQUIRE( pos != string::npos );
+      int t = -1, i = -1;
+      BOOST_REQUIRE_EQUAL( sscanf( line.c_str() + pos, "thread %d line %d end", &t, &i ), 2 );
+      BOOST_REQUIRE( t >= 0 && t < threads );
+      BOOST_REQUIRE_EQUAL( i, next[t] );
+      ++next[t];
+   }
+   BOOST_CHECK( next == std::vector<int>( threads, lines ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(gelf_appender_local_sink) try {
+   boost::asio::io_context ios;
+   boost::asio::ip::udp::socket sink( ios, boost::asio::ip::udp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) );
+   sink.non_blocking( true );
+   sink.set_option( boost::asio::socket_base::receive_buffer_size( 8 * 1024 * 1024 ) );
+
+   gelf_appender app( mutable_variant_object()
+                      ( "endpoint", "127.0.0.1:" + std::to_string( sink.local_endpoint().port() ) )
+                      ( "host", "test\"host" )
+                      ( "max_datagram_size", 512 ) );
+   app.initialize( ios );
+
+   // incompressible payload so the message is split into several chunks
+   string big;
+   for( uint32_t i = 0; big.size() < 4000; ++i )
+      big += std::to_string( i * 2654435761u );
+   app.log( FC_LOG_MESSAGE( warn, "small ${v}", ("v", "tab\tquote\"") ) );
+   app.log( FC_LOG_MESSAGE( error, "big ${v}", ("v", big) ) );
+
+   auto received = receive_gelf( sink, 2, 5000 );
+   BOOST_REQUIRE_EQUAL( received.size(), 2u );
+   BOOST_CHECK_EQUAL( received[0]["version"].as_string(), "1.1" );
+   BOOST_CHECK_EQUAL( received[0]["host"].as_string(), "test\"host" );
+   BOOST_CHECK_EQUAL( received[0]["short_message"].as_string(), "small tab\tquote\"" );
+   BOOST_CHECK_EQUAL( received[0]["level"].as_int64(), 4 );
+   BOOST_CHECK_EQUAL( received[0]["_file"].as_string(), "test_appenders.cpp" );
+   BOOST_CHECK_EQUAL( received[0]["_method_name"].as_string(), "test_method" );
+   BOOST_CHECK( received[0]["_line"].is_uint64() || received[0]["_line"].is_int64() );
+   BOOST_CHECK_GT( received[0]["timestamp"].as_double(), 1.5e9 );
+   BOOST_CHECK_EQUAL( received[1]["level"].as_int64(), 3 );
+   BOOST_CHECK_EQUAL( received[1]["short_message"].as_string().substr( 0, 4 ), "big " );
+   BOOST_CHECK_GT( received[1]["short_message"].as_string().size(), 512u );
+   BOOST_CHECK_EQUAL( std::stoull( received[1]["_log_id"].as_string() ), std::stoull( received[0]["_log_id"].as_string() ) + 1 );
+} FC_LOG_AND_RETHROW();
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(gelf_appender_would_block) try {
+   boost::asio::io_context ios;
+   boost::asio::ip::udp::socket sink( ios, boost::asio::ip::udp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) );
+   sink.non_blocking( true );
+   sink.set_option( boost::asio::socket_base::receive_buffer_size( 8 * 1024 * 1024 ) );
+   gelf_appender app( mutable_variant_object()
+                      ( "endpoint", "127.0.0.1:" + std::to_string( sink.local_endpoint().port() ) )
+                      ( "max_datagram_size", 512 ) );
+   app.initialize( ios );
+
+   string big;
+   for( uint32_t i = 0; big.size() < 4000; ++i )
+      big += std::to_string( i * 2654435761u );
+   // every datagram is queued on the io_context and sent once it runs
+   sends_would_block = true;
+   for( int i = 0; i < 3; ++i )
+      app.log( FC_LOG_MESSAGE( error, "big ${i} ${v}", ("i", i)("v", big) ) );
+   app.log( FC_LOG_MESSAGE( warn, "small" ) );
+   sends_would_block = false;
+   ios.run_for( std::chrono::seconds( 5 ) );
+
+   auto received = receive_gelf( sink, 4, 5000 );
+   BOOST_REQUIRE_EQUAL( received.size(), 4u );
+   std::vector<string> messages;
+   for( const auto& r : received )
+      messages.push_back( r["short_message"].as_string() );
+   std::sort( messages.begin(), messages.end() );
+   for( int i = 0; i < 3; ++i ) {
+      const string prefix = "big " + std::to_string( i ) + " " + big.substr( 0, 100 );
+      BOOST_CHECK_EQUAL( messages[i].substr( 0, prefix.size() ), prefix );
+      BOOST_CHECK_GT( messages[i].size(), 512u );
+   }
+   BOOST_CHECK_EQUAL( messages[3], "small" );
+} FC_LOG_AND_RETHROW();
+#endif
+
+BOOST_AUTO_TEST_CASE(gelf_appender_throughput, * boost::unit_test::disabled()) try {
+   boost::asio::io_context ios;
+   boost::asio::ip::udp::socket sink( ios, boost::asio::ip::udp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) );
+   sink.non_blocking( true );
+   sink.set_option( boost::asio::socket_base::receive_buffer_size( 8 * 1024 * 1024 ) );
+   gelf_appender app( mutable_variant_object()( "endpoint", "127.0.0.1:" + std::to_string( sink.local_endpoint().port() ) ) );
+   app.initialize( ios );
+
+   const size_t iterations = 20000;
+   const double us = fc::benchmark::elapsed_us( [&]() {
+      for( size_t i = 0; i < iterations; ++i )
+         app.log( FC_LOG_MESSAGE( info, "Received block ${id}... #${n} signed by ${p} [trxs: ${count}]",
+                                  ("id", "00000a3f2c1b")("n", i)("p", "eosio")("count", 12) ) );
+   } );
+   std::cout << "gelf_appender: " << us / iterations << " us per message" << std::endl;
+   BOOST_CHECK_GT( receive_gelf( sink, iterations, 500 ).size(), 0u );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,11 +2,94 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <fc/crypto/base64.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/crypto/sha256.hpp>
 #include <fc/exception/exception.hpp>
+#include "benchmark.hpp"
+#include <cstring>
+#include <iostream>
 
 using namespace fc;
 using namespace std::literals;
 
+namespace {
+
+struct restore_backend {
+   base64_backend b = get_base64_backend();
+   ~restore_backend() { set_base64_backend( b ); }
+};
+
+const char* backend_name( base64_backend b ) {
+   return b == base64_backend::avx2 ? "avx2" : "scalar";
+}
+
+/// the backends this CPU runs
+std::vector<base64_backend> supported_backends() {
+   std::vector<base64_backend> r;
+   for( auto b : { base64_backend::scalar, base64_backend::avx2 } )
+      if( set_base64_backend( b ) )
+         r.push_back( b );
+   return r;
+}
+
+const char* standard_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char* url_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+std::string random_bytes( size_t n ) {
+   std::string d( n, '\0' );
+   if( n )
+      rand_bytes( &d[0], d.size() );
+   return d;
+}
+
+/// six bits at a time, as the byte at a time encoder did
+std::string reference_encode( const std::string& in, const char* chars ) {
+   std::string r;
+   uint32_t acc = 0;
+   int bits = 0;
+   for( unsigned char c : in ) {
+      acc = acc << 8 | c;
+      for( bits += 8; bits >= 6; bits -= 6 )
+         r += chars[( acc >> ( bits - 6 ) ) & 63];
+   }
+   if( bits )
+      r += chars[( acc << ( 6 - bits ) ) & 63];
+   while( r.size() % 4 )
+      r += '=';
+   return r;
+}
+
+/// what base64_decode accepted before: it stops at the first '=' and throws on a character outside the alphabet
+std::string reference_decode( const std::string& in, const char* chars ) {
+   std::string r;
+   uint32_t acc = 0;
+   int bits = 0;
+   for( char c : in ) {
+      if( c == '=' )
+         break;
+      const char* p = c ? strchr( chars, c ) : nullptr;
+      FC_ASSERT( p, "encountered non-base64 character" );
+      acc = acc << 6 | uint32_t( p - chars );
+      bits += 6;
+      if( bits >= 8 ) {
+         bits -= 8;
+         r += char( acc >> bits );
+         acc &= ( 1u << bits ) - 1;
+      }
+   }
+   return r;
+}
+
+bool decode( const std::string& in, std::string& out, base64_alphabet a, base64_mode m ) {
+   out.assign( base64_decoded_max_size( in.size() ), '\0' );
+   size_t n = 0;
+   const bool ok = base64_decode_to( in.data(), in.size(), &out[0], out.size(), n, a, m );
+   out.resize( n );
+   return ok;
+}
+
+} // anonymous namespace
+
 BOOST_AUTO_TEST_SUITE(base64)
 
 BOOST_AUTO_TEST_CASE(base64enc) try {
@@ -52,4 +135,159 @@ BOOST_AUTO_TEST_CASE(base64dec_bad_stuff) try {
    });
 } FC_LOG_AND_RETHROW();
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE(backends_match_reference) try {
+   restore_backend restore;
+   std::vector<size_t> sizes;
+   for( size_t n = 0; n <= 130; ++n )
+      sizes.push_back( n );
+   for( size_t n : { 255, 256, 257, 1000, 4099 } )
+      sizes.push_back( n );
+
+   for( auto b : supported_backends() ) {
+      BOOST_REQUIRE( set_base64_backend( b ) );
+      BOOST_TEST_CONTEXT( backend_name( b ) )
+      for( size_t n : sizes ) {
+         const auto data = random_bytes( n );
+         for( auto a : { base64_alphabet::standard, base64_alphabet::url } ) {
+            const auto expected = reference_encode( data, a == base64_alphabet::url ? url_chars : standard_chars );
+            std::string enc( base64_encoded_size( n ), '\0' );
+            base64_encode_to( data.data(), n, &enc[0], a );
+            BOOST_REQUIRE_EQUAL( enc, expected );
+            BOOST_REQUIRE_EQUAL( a == base64_alphabet::url ? base64url_encode( data ) : base64_encode( data ), expected );
+
+            std::string back;
+            for( auto m : { base64_mode::strict, base64_mode::lenient } ) {
+               BOOST_REQUIRE( decode( enc, back, a, m ) && back == data );
+               // padding is optional in both modes
+               BOOST_REQUIRE( decode( enc.substr( 0, enc.find( '=' ) ), back, a, m ) && back == data );
+            }
+            BOOST_REQUIRE( ( a == base64_alphabet::url ? base64url_decode( enc ) : base64_decode( enc ) ) == data );
+         }
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(strict_rejects) try {
+   restore_backend restore;
+   const auto data = random_bytes( 100 );
+   const auto enc = base64_encode( data );
+   std::string out;
+
+   for( auto b : supported_backends() ) {
+      BOOST_REQUIRE( set_base64_backend( b ) );
+      BOOST_TEST_CONTEXT( backend_name( b ) ) {
+         for( size_t at = 0; at < enc.size() - 1; at += 5 ) {
+            for( char c : { '-', '_', '=', ' ', '\n', '.', '\0', char( 0x80 ), char( 0xff ) } ) {
+               std::string bad = enc;
+               bad[at] = c;
+               BOOST_REQUIRE( !decode( bad, out, base64_alphabet::standard, base64_mode::strict ) );
+            }
+         }
+         // the other alphabet
+         BOOST_CHECK( !decode( "ab+/", out, base64_alphabet::url, base64_mode::strict ) );
+         BOOST_CHECK( !decode( "ab-_", out, base64_alphabet::standard, base64_mode::strict ) );
+         BOOST_CHECK( decode( "ab-_", out, base64_alphabet::url, base64_mode::strict ) );
+         // padding that does not complete a group, a single character group, bits past the last byte
+         for( const char* s : { "QQ=", "QUE==", "Q===", "QUFB=", "QUFBQ", "QUFBQ===", "QR==", "QUF=", "QUH=" } )
+            BOOST_CHECK_MESSAGE( !decode( s, out, base64_alphabet::standard, base64_mode::strict ), s );
+         for( const char* s : { "QQ==", "QQ", "QUE=", "QUE", "QUFB", "" } )
+            BOOST_CHECK_MESSAGE( decode( s, out, base64_alphabet::standard, base64_mode::strict ), s );
+         // too little room
+         char small[2];
+         size_t n = 7;
+         BOOST_CHECK( !base64_decode_to( "QUFB", 4, small, sizeof(small), n ) );
+         BOOST_CHECK_EQUAL( n, 0u );
+         BOOST_CHECK( base64_decode_to( "QUE=", 4, small, sizeof(small), n ) && n == 2 && small[0] == 'A' && small[1] == 'A' );
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(lenient_matches_old_decoder) try {
+   restore_backend restore;
+   const std::string symbols = std::string( standard_chars ) + "-_=.";
+   for( auto b : supported_backends() ) {
+      BOOST_REQUIRE( set_base64_backend( b ) );
+      for( int i = 0; i < 3000; ++i ) {
+         // mostly valid strings, some with '=' or a foreign character anywhere
+         auto r = random_bytes( 1 + i % 97 );
+         std::string s;
+         for( unsigned char c : r )
+            s += symbols[c % ( i % 3 ? 64 : symbols.size() )];
+         for( auto a : { base64_alphabet::standard, base64_alphabet::url } ) {
+            const char* chars = a == base64_alphabet::url ? url_chars : standard_chars;
+            std::string expected, got;
+            bool threw = false;
+            try {
+               expected = reference_decode( s, chars );
+            } catch( const fc::exception& ) {
+               threw = true;
+            }
+            BOOST_REQUIRE_EQUAL( decode( s, got, a, base64_mode::lenient ), !threw );
+            if( !threw )
+               BOOST_REQUIRE( got == expected );
+            BOOST_REQUIRE_EQUAL( threw, [&]() {
+               try { a == base64_alphabet::url ? base64url_decode( s ) : base64_decode( s ); }
+               catch( const fc::exception& e ) {
+                  return e.to_detail_string().find( "encountered non-base64 character" ) != std::string::npos;
+               }
+               return false;
+            }() );
+         }
+      }
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(base64_benchmarks, * boost::unit_test::disabled()) try {
+   restore_backend restore;
+   auto mib_per_s = []( size_t bytes, size_t rounds, auto&& f ) {
+      return bytes * fc::benchmark::per_second( rounds, [&]( size_t ) { f(); } ) / ( 1 << 20 );
+   };
+
+   for( size_t n : { 1 << 10, 64 << 10, 1 << 20 } ) {
+      const auto data = random_bytes( n );
+      const auto enc = reference_encode( data, standard_chars );
+      std::string out( base64_decoded_max_size( enc.size() ), '\0' );
+      const size_t rounds = std::max<size_t>( 4, ( 64 << 20 ) / n );
+
+      std::cout << n / 1024 << " KiB, MiB/s of bytes: reference encode "
+                << mib_per_s( n, rounds / 16, [&]() { BOOST_REQUIRE_EQUAL( reference_encode( data, standard_chars ).size(), enc.size() ); } )
+                << ", decode " << mib_per_s( n, rounds / 16, [&]() { BOOST_REQUIRE_EQUAL( reference_decode( enc, standard_chars ).size(), n ); } );
+      for( auto b : supported_backends() ) {
+         BOOST_REQUIRE( set_base64_backend( b ) );
+         std::string e( enc.size(), '\0' );
+         size_t len = 0;
+         std::cout << "; " << backend_name( b ) << " encode "
+                   << mib_per_s( n, rounds, [&]() { base64_encode_to( data.data(), n, &e[0] ); } )
+                   << ", strict decode "
+                   << mib_per_s( n, rounds, [&]() { BOOST_REQUIRE( base64_decode_to( enc.data(), enc.size(), &out[0], out.size(), len ) ); } )
+                   << ", base64_decode "
+                   << mib_per_s( n, rounds / 4, [&]() { BOOST_REQUIRE_EQUAL( base64_decode( enc ).size(), n ); } );
+         BOOST_REQUIRE( e == enc && out.substr( 0, len ) == data );
+      }
+      std::cout << std::endl;
+   }
+
+   // a WebAuthn challenge: the unpadded base64url of a digest
+   const auto d = sha256::hash( std::string( "challenge" ) );
+   std::string challenge = base64url_encode( d.data(), d.data_size() );
+   challenge.resize( challenge.find( '=' ) );
+   const size_t rounds = 1000000;
+   // each call returns the bytes it decoded, checked once the clock has stopped
+   auto ns_per = [&]( auto&& f ) {
+      size_t total = 0;
+      const double ns = fc::benchmark::ns_per_call( rounds, [&]( size_t ) { total += f(); } );
+      BOOST_CHECK_EQUAL( total, rounds * d.data_size() );
+      return ns;
+   };
+   std::cout << "43 character challenge, ns: reference " << ns_per( [&]() { return reference_decode( challenge, url_chars ).size(); } )
+             << ", base64url_decode " << ns_per( [&]() { return base64url_decode( challenge ).size(); } )
+             << ", base64_decode_to " << ns_per( [&]() {
+                   sha256 out;
+                   size_t len = 0;
+                   base64_decode_to( challenge.data(), challenge.size(), out.data(), out.data_size(), len,
+                                     base64_alphabet::url, base64_mode::lenient );
+                   return out == d ? len : 0;
+                } ) << std::endl;
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
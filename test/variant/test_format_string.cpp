@@ -0,0 +1,141 @@
+#define BOOST_TEST_MODULE format_string
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/variant_object.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/json.hpp>
+#include <fc/time.hpp>
+#include "benchmark.hpp"
+#include <iostream>
+#include <string>
+
+using namespace fc;
+
+namespace {
+
+// format_string as it was before formats were compiled and cached, kept as reference for output and timing
+void reference_clean_append( string& app, const std::string_view& s, size_t pos = 0, size_t len = string::npos ) {
+   app += escape_string( s.substr( pos, len ), nullptr, false );
+}
+
+string reference_format_string( const string& frmt, const variant_object& args, bool minimize = false ) {
+   constexpr size_t minimize_max_size = 1024;
+   std::string result;
+   const string& format = ( minimize && frmt.size() > minimize_max_size ) ?
+         frmt.substr( 0, minimize_max_size ) + "..." : frmt;
+   const auto arg_num = (args.size() == 0) ? 1 : args.size();
+   const auto max_format_size = std::max(minimize_max_size, format.size());
+   const auto minimize_sub_max_size = minimize ? ( max_format_size - format.size() ) / arg_num :  minimize_max_size;
+   result.reserve( max_format_size + 3 * args.size());
+   size_t prev = 0;
+   size_t next = format.find( '$' );
+   while( prev != string::npos && prev < format.size() ) {
+      if( next != string::npos ) {
+         reference_clean_append( result, format, prev, next - prev );
+      } else {
+         reference_clean_append( result, format, prev );
+      }
+      if( next == string::npos ) {
+         return result;
+      } else if( minimize && result.size() > minimize_max_size ) {
+         result += "...";
+         return result;
+      }
+      prev = next + 1;
+      if( format[prev] == '{' ) {
+         next = format.find( '}', prev );
+         if( next != string::npos ) {
+            string key = format.substr( prev + 1, (next - prev - 1) );
+            auto val = args.find( key );
+            bool replaced = true;
+            if( val != args.end() ) {
+               if( val->value().is_object() || val->value().is_array() ) {
+                  if( minimize && (result.size() >= minimize_max_size)) {
+                     replaced = false;
+                  } else {
+                     const auto max_length = minimize ? minimize_sub_max_size : std::numeric_limits<uint64_t>::max();
+                     result += json::to_string( val->value(), fc::time_point::maximum(),
+                                                json::output_formatting::stringify_large_ints_and_doubles, max_length );
+                  }
+               } else if( val->value().is_string() ) {
+                  if( minimize && val->value().get_string().size() > minimize_sub_max_size ) {
+                     auto sz = std::min( minimize_sub_max_size, minimize_max_size - result.size() );
+                     reference_clean_append( result, val->value().get_string(), 0, sz );
+                     result += "...";
+                  } else {
+                     reference_clean_append( result, val->value().get_string() );
+                  }
+               } else {
+                  reference_clean_append( result, val->value().as_string() );
+               }
+            } else {
+               replaced = false;
+            }
+            if( !replaced ) {
+               result += "${";
+               reference_clean_append( result, key );
+               result += "}";
+            }
+            prev = next + 1;
+            next = format.find( '$', prev );
+         }
+      } else {
+         reference_clean_append( result, format, prev, 1 );
+         ++prev;
+         next = format.find( '$', prev );
+      }
+   }
+   return result;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(format_string_test_suite)
+
+BOOST_AUTO_TEST_CASE(compiled_matches_reference) try {
+   const variant_object args = mutable_variant_object()
+         ( "a", "alpha" )( "b", 42 )( "c", "tab\there" )( "obj", mutable_variant_object( "x", 1 )( "y", "z" ) )
+         ( "arr", variants{ variant( 1 ), variant( "two" ) } )( "neg", -7 )( "", "empty key" );
+   const std::vector<string> formats = {
+         "", "no placeholders", "${a}", "${a}${b}", "x ${a} y ${b} z", "${missing} ${a}", "${}",
+         "$", "abc$", "$$", "$a ${b}", "price: $5 for ${a}", "${a", "open ${a and ${b}", "}${a}{",
+         "${obj} ${arr} ${neg}", "line\nbreak ${c}\x01", "${a}${a}${a}", "\xc3\xa9t\xc3\xa9 ${a} $\xc3\xa9"
+   };
+   for( const auto& f : formats ) {
+      for( int i = 0; i < 2; ++i ) { // second pass exercises the cached compiled format
+         BOOST_CHECK_EQUAL( reference_format_string( f, args ), format_string( f, args ) );
+         BOOST_CHECK_EQUAL( reference_format_string( f, args, true ), format_string( f, args, true ) );
+      }
+   }
+
+   // same format with arguments in a different order must not reuse a stale slot
+   const variant_object reordered = mutable_variant_object()( "b", 1 )( "a", "first" );
+   BOOST_CHECK_EQUAL( format_string( "x ${a} y ${b} z", reordered ), "x first y 1 z" );
+   BOOST_CHECK_EQUAL( format_string( "x ${a} y ${b} z", args ), "x alpha y 42 z" );
+
+   const string long_format = string( 1500, 'f' ) + " ${a}";
+   BOOST_CHECK_EQUAL( reference_format_string( long_format, args, true ), format_string( long_format, args, true ) );
+   BOOST_CHECK_EQUAL( reference_format_string( long_format, args ), format_string( long_format, args ) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(format_string_benchmark, * boost::unit_test::disabled()) try {
+   const size_t iterations = 100000;
+   const std::vector<std::pair<string, variant_object>> lines = {
+         { "Received block ${id}... #${n} @ ${t} signed by ${p} [trxs: ${count}, lib: ${lib}, conf: ${confs}, latency: ${latency} ms]",
+           mutable_variant_object( "id", "00000a3f2c1b" )( "n", 2623 )( "t", "2020-08-20T12:00:00.000" )( "p", "eosio" )
+                 ( "count", 12 )( "lib", 2610 )( "confs", 0 )( "latency", 131 ) },
+         { "connection ${c} closed: ${reason}",
+           mutable_variant_object( "c", "peer1:9876" )( "reason", "no reason" ) },
+         { "on_incoming_block", variant_object() }
+   };
+
+   for( const auto& l : lines ) {
+      BOOST_REQUIRE_EQUAL( reference_format_string( l.first, l.second ), format_string( l.first, l.second ) );
+      const double old_ns = fc::benchmark::ns_per_call( iterations, [&]( size_t ) { reference_format_string( l.first, l.second ); } );
+      const double new_ns = fc::benchmark::ns_per_call( iterations, [&]( size_t ) { format_string( l.first, l.second ); } );
+      std::cout << "format_string \"" << l.first.substr( 0, 40 ) << "\": reference " << old_ns << " ns, compiled "
+                << new_ns << " ns" << std::endl;
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()